@@ -11,6 +11,7 @@
 #include "thread_pool.h"
 
 #include <algorithm>
+#include <chrono>
 #include <condition_variable>
 #include <exception>
 #include <mutex>
@@ -22,6 +23,7 @@
 
 #include "../cxxutil.hpp"
 #include "../m_argv.h"
+#include "trace.h"
 
 using namespace srb2;
 
@@ -30,6 +32,7 @@ static void do_work(ThreadPool::Task& work)
 	try
 	{
 		ZoneScoped;
+		TraceScoped("Task");
 		(work.thunk)(work.raw.data());
 	}
 	catch (...)
@@ -40,47 +43,90 @@ static void do_work(ThreadPool::Task& work)
 	(work.deleter)(work.raw.data());
 	if (work.pseudosema)
 	{
-		work.pseudosema->fetch_sub(1, std::memory_order_relaxed);
+		// Release, so that tasks scheduled after this one see its writes
+		work.pseudosema->fetch_sub(1, std::memory_order_release);
 	}
 }
 
+static bool dependency_done(const ThreadPool::Task& work)
+{
+	return !work.after || work.after->load(std::memory_order_acquire) == 0;
+}
+
+// Runs the task, or holds it back if what it was scheduled after hasn't finished yet.
+// The queues only take pushes from the scheduling thread, so it can't go back in one.
+static void run_or_defer(ThreadPool::Task& work, std::vector<ThreadPool::Task>& deferred, ThreadPool::WorkerStats& stats)
+{
+	if (!dependency_done(work))
+	{
+		stats.deferred.fetch_add(1, std::memory_order_relaxed);
+		deferred.push_back(std::move(work));
+		return;
+	}
+
+	do_work(work);
+	stats.tasks.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Runs the first held back task that is now ready, if any
+static bool run_deferred(std::vector<ThreadPool::Task>& deferred, ThreadPool::WorkerStats& stats)
+{
+	for (auto it = deferred.begin(); it != deferred.end(); ++it)
+	{
+		if (dependency_done(*it))
+		{
+			ThreadPool::Task work = std::move(*it);
+			deferred.erase(it);
+			do_work(work);
+			stats.tasks.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static void pool_executor(
 	int thread_index,
 	std::shared_ptr<std::atomic<bool>> pool_alive,
 	std::shared_ptr<std::mutex> worker_ready_mutex,
 	std::shared_ptr<std::condition_variable> worker_ready_condvar,
 	std::shared_ptr<ThreadPool::Queue> my_wq,
-	std::vector<std::shared_ptr<ThreadPool::Queue>> other_wqs
+	std::vector<std::shared_ptr<ThreadPool::Queue>> other_wqs,
+	std::shared_ptr<ThreadPool::WorkerStats> stats
 )
 {
 	{
 		std::string thread_name = fmt::format("Thread Pool Thread {}", thread_index);
 		tracy::SetThreadName(thread_name.c_str());
+		Trace_SetThreadName(thread_name.c_str());
 	}
 
+	std::vector<ThreadPool::Task> deferred;
+
 	int spins = 0;
 	while (true)
 	{
-		std::optional<ThreadPool::Task> work = my_wq->steal();
-		bool did_work = false;
-		if (work)
+		bool did_work = run_deferred(deferred, *stats);
+
+		std::optional<ThreadPool::Task> work;
+		if (!did_work && (work = my_wq->steal()))
 		{
-			do_work(*work);
+			run_or_defer(*work, deferred, *stats);
 
 			did_work = true;
-			spins = 0;
 		}
-		else
+		else if (!did_work)
 		{
 			for (auto& q : other_wqs)
 			{
 				work = q->steal();
 				if (work)
 				{
-					do_work(*work);
+					stats->stolen.fetch_add(1, std::memory_order_relaxed);
+					run_or_defer(*work, deferred, *stats);
 
 					did_work = true;
-					spins = 0;
 
 					// We only want to steal one work item at a time, to prioritize our own queue
 					break;
@@ -88,12 +134,33 @@ static void pool_executor(
 			}
 		}
 
-		if (!did_work)
+		if (did_work)
+		{
+			spins = 0;
+		}
+		else if (!deferred.empty())
+		{
+			// Whoever runs their dependencies won't wake us, so only nap
+			// briefly once yielding hasn't been enough
+			spins += 1;
+			if (spins > 100)
+			{
+				stats->sleeps.fetch_add(1, std::memory_order_relaxed);
+				std::unique_lock<std::mutex> ready_lock {*worker_ready_mutex};
+				worker_ready_condvar->wait_for(ready_lock, std::chrono::microseconds(200));
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+		else
 		{
 			// Spin a few loops to avoid yielding, then wait for the ready lock
 			spins += 1;
 			if (spins > 100)
 			{
+				stats->sleeps.fetch_add(1, std::memory_order_relaxed);
 				std::unique_lock<std::mutex> ready_lock {*worker_ready_mutex};
 				while (my_wq->empty() && pool_alive->load())
 				{
@@ -118,6 +185,7 @@ ThreadPool::ThreadPool(size_t threads)
 {
 	next_queue_index_ = 0;
 	pool_alive_ = std::make_shared<std::atomic<bool>>(true);
+	caller_stats_ = std::make_shared<WorkerStats>();
 
 	for (size_t i = 0; i < threads; i++)
 	{
@@ -128,6 +196,7 @@ ThreadPool::ThreadPool(size_t threads)
 		worker_ready_mutexes_.push_back(std::move(mutex));
 		std::shared_ptr<std::condition_variable> condvar = std::make_shared<std::condition_variable>();
 		worker_ready_condvars_.push_back(std::move(condvar));
+		worker_stats_.push_back(std::make_shared<WorkerStats>());
 	}
 
 	for (size_t i = 0; i < threads; i++)
@@ -163,7 +232,8 @@ ThreadPool::ThreadPool(size_t threads)
 				worker_ready_mutexes_[i],
 				worker_ready_condvars_[i],
 				my_queue,
-				other_queues
+				other_queues,
+				worker_stats_[i]
 			};
 		}
 		catch (const std::system_error& error)
@@ -182,7 +252,15 @@ ThreadPool::ThreadPool(size_t threads)
 }
 
 ThreadPool::ThreadPool(ThreadPool&&) = default;
-ThreadPool::~ThreadPool() = default;
+ThreadPool::~ThreadPool()
+{
+	// shutdown runs these, but a pool dropped without it, or after wait_sema threw,
+	// can still hold some. Nothing is left to run them, so just destroy their captures.
+	for (Task& work : caller_deferred_)
+	{
+		(work.deleter)(work.raw.data());
+	}
+}
 
 ThreadPool& ThreadPool::operator=(ThreadPool&&) = default;
 
@@ -237,7 +315,16 @@ void ThreadPool::wait_idle()
 		std::optional<Task> work;
 		while ((work = q->pop()).has_value())
 		{
-			do_work(*work);
+			run_or_defer(*work, caller_deferred_, *caller_stats_);
+		}
+	}
+
+	// Everything held back depends on something that was already running
+	while (!caller_deferred_.empty())
+	{
+		if (!run_deferred(caller_deferred_, *caller_stats_))
+		{
+			std::this_thread::yield();
 		}
 	}
 }
@@ -254,6 +341,11 @@ void ThreadPool::wait_sema(const Sema& sema)
 	while (sema.pseudosema_->load(std::memory_order_seq_cst) > 0)
 	{
 		// spin to win
+		if (run_deferred(caller_deferred_, *caller_stats_))
+		{
+			continue;
+		}
+
 		for (size_t i = 0; i < work_queues_.size(); i++)
 		{
 			auto& q = work_queues_[i];
@@ -261,7 +353,7 @@ void ThreadPool::wait_sema(const Sema& sema)
 			std::optional<Task> work;
 			if ((work = q->pop()).has_value())
 			{
-				do_work(*work);
+				run_or_defer(*work, caller_deferred_, *caller_stats_);
 				break;
 			}
 		}
@@ -271,6 +363,25 @@ void ThreadPool::wait_sema(const Sema& sema)
 	{
 		throw std::exception();
 	}
+
+	// Anything still held back belongs to a later group. Only the caller
+	// would ever run it from here, so hand it back to the workers.
+	if (!caller_deferred_.empty())
+	{
+		for (Task& work : caller_deferred_)
+		{
+			work_queues_[next_queue_index_]->push(std::move(work));
+
+			next_queue_index_ += 1;
+			if (next_queue_index_ >= threads_.size())
+			{
+				next_queue_index_ = 0;
+			}
+		}
+		caller_deferred_.clear();
+
+		notify();
+	}
 }
 
 void ThreadPool::shutdown()
@@ -294,6 +405,54 @@ void ThreadPool::shutdown()
 	}
 }
 
+std::vector<ThreadPool::Stats> ThreadPool::stats() const
+{
+	std::vector<Stats> ret;
+
+	auto add = [&ret](const WorkerStats& s)
+	{
+		ret.push_back({
+			s.tasks.load(std::memory_order_relaxed),
+			s.stolen.load(std::memory_order_relaxed),
+			s.deferred.load(std::memory_order_relaxed),
+			s.sleeps.load(std::memory_order_relaxed),
+		});
+	};
+
+	for (auto& s : worker_stats_)
+	{
+		add(*s);
+	}
+
+	if (caller_stats_)
+	{
+		add(*caller_stats_);
+	}
+
+	return ret;
+}
+
+void ThreadPool::reset_stats()
+{
+	auto reset = [](WorkerStats& s)
+	{
+		s.tasks.store(0, std::memory_order_relaxed);
+		s.stolen.store(0, std::memory_order_relaxed);
+		s.deferred.store(0, std::memory_order_relaxed);
+		s.sleeps.store(0, std::memory_order_relaxed);
+	};
+
+	for (auto& s : worker_stats_)
+	{
+		reset(*s);
+	}
+
+	if (caller_stats_)
+	{
+		reset(*caller_stats_);
+	}
+}
+
 std::unique_ptr<ThreadPool> srb2::g_main_threadpool;
 
 void I_ThreadPoolInit(void)
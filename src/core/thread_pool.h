@@ -37,7 +37,27 @@ public:
 		void (*thunk)(void*);
 		void (*deleter)(void*);
 		std::shared_ptr<std::atomic<uint32_t>> pseudosema;
-		std::array<std::byte, 512 - sizeof(void(*)(void*)) * 2 - sizeof(std::shared_ptr<std::atomic<uint32_t>>)> raw;
+		/// Must reach zero before this task runs
+		std::shared_ptr<std::atomic<uint32_t>> after;
+		std::array<std::byte, 512 - sizeof(void(*)(void*)) * 2 - sizeof(std::shared_ptr<std::atomic<uint32_t>>) * 2> raw;
+	};
+
+	struct WorkerStats
+	{
+		std::atomic<uint64_t> tasks {0};
+		/// Tasks taken from another worker's queue
+		std::atomic<uint64_t> stolen {0};
+		/// Tasks picked up before their dependency finished, and held back
+		std::atomic<uint64_t> deferred {0};
+		std::atomic<uint64_t> sleeps {0};
+	};
+
+	struct Stats
+	{
+		uint64_t tasks;
+		uint64_t stolen;
+		uint64_t deferred;
+		uint64_t sleeps;
 	};
 
 	using Queue = SpMcQueue<Task>;
@@ -59,9 +79,14 @@ private:
 	std::vector<std::shared_ptr<std::condition_variable>> worker_ready_condvars_;
 	std::vector<std::shared_ptr<Queue>> work_queues_;
 	std::vector<std::thread> threads_;
+	std::vector<std::shared_ptr<WorkerStats>> worker_stats_;
 	size_t next_queue_index_ = 0;
 	std::shared_ptr<std::atomic<uint32_t>> cur_sema_;
 
+	// For the calling thread, while it helps out in wait_idle and wait_sema
+	std::shared_ptr<WorkerStats> caller_stats_;
+	std::vector<Task> caller_deferred_;
+
 	bool immediate_mode_ = false;
 	bool sema_begun_ = false;
 
@@ -80,12 +105,22 @@ public:
 
 	/// Enqueue but don't notify
 	template <typename T> void schedule(T&& thunk);
+	/// Enqueue a task that won't start until every task of dependency has finished.
+	/// Along with begin_sema/end_sema, this builds a graph of task groups, e.g. a
+	/// group that composites only after every span of the group before it is drawn.
+	template <typename T> void schedule_after(const Sema& dependency, T&& thunk);
 	/// Notify threads after several schedules
 	void notify();
 	void notify_sema(const Sema& sema);
 	void wait_idle();
 	void wait_sema(const Sema& sema);
 	void shutdown();
+
+	size_t threads() const noexcept { return threads_.size(); }
+
+	/// One entry per worker, then one for the thread calling wait_idle/wait_sema
+	std::vector<Stats> stats() const;
+	void reset_stats();
 };
 
 extern std::unique_ptr<ThreadPool> g_main_threadpool;
@@ -104,6 +139,12 @@ void callable_destroyer(F* f)
 
 template <typename T>
 void ThreadPool::schedule(T&& thunk)
+{
+	schedule_after(Sema(), std::forward<T>(thunk));
+}
+
+template <typename T>
+void ThreadPool::schedule_after(const Sema& dependency, T&& thunk)
 {
 	static_assert(sizeof(T) <= sizeof(std::declval<Task>().raw));
 
@@ -130,6 +171,7 @@ void ThreadPool::schedule(T&& thunk)
 		task.thunk = reinterpret_cast<void(*)(void*)>(callable_caller<T>);
 		task.deleter = reinterpret_cast<void(*)(void*)>(callable_destroyer<T>);
 		task.pseudosema = cur_sema_;
+		task.after = dependency.pseudosema_;
 		new (reinterpret_cast<T*>(task.raw.data())) T(std::move(thunk));
 
 		q->push(std::move(task));
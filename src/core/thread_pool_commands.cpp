@@ -0,0 +1,191 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+
+#include "thread_pool_commands.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "../command.h"
+#include "../console.h"
+#include "../doomdef.h"
+#include "../i_system.h"
+#include "thread_pool.h"
+
+void Command_ThreadPoolStats_f(void)
+{
+	if (!srb2::g_main_threadpool)
+	{
+		return;
+	}
+
+	std::vector<srb2::ThreadPool::Stats> stats = srb2::g_main_threadpool->stats();
+
+	if (stats.empty())
+	{
+		CONS_Printf("The thread pool is running single threaded.\n");
+		return;
+	}
+
+	CONS_Printf("worker   tasks  stolen  deferred  sleeps\n");
+
+	for (size_t i = 0; i < stats.size(); ++i)
+	{
+		const srb2::ThreadPool::Stats& s = stats[i];
+		std::string name = i + 1 < stats.size() ? fmt::format("{}", i) : "main";
+
+		CONS_Printf("%-6s %7s %7s %9s %7s\n", name.c_str(),
+			fmt::format("{}", s.tasks).c_str(), fmt::format("{}", s.stolen).c_str(),
+			fmt::format("{}", s.deferred).c_str(), fmt::format("{}", s.sleeps).c_str());
+	}
+
+	if (COM_Argc() > 1 && !strcasecmp(COM_Argv(1), "reset"))
+	{
+		srb2::g_main_threadpool->reset_stats();
+	}
+}
+
+namespace
+{
+
+// Stands in for a span: enough arithmetic that it can't be optimized out
+UINT32 bench_work(UINT32 seed, int iterations)
+{
+	for (int i = 0; i < iterations; ++i)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		seed ^= seed >> 13;
+	}
+
+	return seed;
+}
+
+// Wall time in microseconds to run every task and wait for them
+double bench_run(srb2::ThreadPool& pool, int tasks, int iterations, bool uneven)
+{
+	std::atomic<UINT32> sink {0};
+
+	precise_t t = I_GetPreciseTime();
+
+	pool.begin_sema();
+	for (int i = 0; i < tasks; ++i)
+	{
+		// Every eighth task costs as much as the other seven
+		int n = uneven && i % 8 == 0 ? iterations * 7 : iterations;
+		pool.schedule([&sink, i, n] { sink.fetch_add(bench_work(i, n), std::memory_order_relaxed); });
+	}
+	srb2::ThreadPool::Sema sema = pool.end_sema();
+	pool.notify_sema(sema);
+	pool.wait_sema(sema);
+
+	t = I_GetPreciseTime() - t;
+
+	return t * 1000000.0 / I_GetPrecisePrecision();
+}
+
+}; // namespace
+
+void Command_ThreadPoolBench_f(void)
+{
+	constexpr int kRepeats = 5;
+
+	const int tasks = COM_Argc() > 1 ? std::max(atoi(COM_Argv(1)), 1) : 2048;
+	const unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+
+	auto best_of = [&](srb2::ThreadPool& pool, int iterations, bool uneven)
+	{
+		double best = bench_run(pool, tasks, iterations, uneven);
+
+		for (int i = 1; i < kRepeats; ++i)
+		{
+			best = std::min(best, bench_run(pool, tasks, iterations, uneven));
+		}
+
+		return best;
+	};
+
+	// Scheduling overhead: tasks that do nothing
+	if (srb2::g_main_threadpool)
+	{
+		double us = best_of(*srb2::g_main_threadpool, 0, false);
+		CONS_Printf("Overhead: %d empty tasks in %.0f us, %.0f ns each\n", tasks, us, us * 1000.0 / tasks);
+	}
+
+	// Scaling: the caller plus 0 to N-1 workers, even and uneven tasks
+	double base = 0.0, base_uneven = 0.0;
+
+	for (unsigned n = 1; n <= cores; ++n)
+	{
+		srb2::ThreadPool pool = n == 1 ? srb2::ThreadPool() : srb2::ThreadPool(n - 1);
+
+		double us = best_of(pool, 2000, false);
+		double uneven = best_of(pool, 2000, true);
+
+		uint64_t stolen = 0;
+		for (const srb2::ThreadPool::Stats& s : pool.stats())
+		{
+			stolen += s.stolen;
+		}
+
+		if (n == 1)
+		{
+			base = us;
+			base_uneven = uneven;
+		}
+
+		CONS_Printf("%2u cores: %8.0f us (%.2fx), uneven %8.0f us (%.2fx), %s stolen\n",
+			n, us, base / us, uneven, base_uneven / uneven, fmt::format("{}", stolen).c_str());
+
+		pool.shutdown();
+	}
+
+	// Dependencies: a second group that must see every write of the first
+	if (srb2::g_main_threadpool)
+	{
+		srb2::ThreadPool& pool = *srb2::g_main_threadpool;
+		std::vector<UINT32> values(tasks, 0);
+		std::atomic<int> misordered {0};
+
+		precise_t t = I_GetPreciseTime();
+
+		pool.begin_sema();
+		for (int i = 0; i < tasks; ++i)
+		{
+			pool.schedule([&values, i] { values[i] = bench_work(i, 200) | 1; });
+		}
+		srb2::ThreadPool::Sema first = pool.end_sema();
+
+		pool.begin_sema();
+		for (int i = 0; i < tasks; ++i)
+		{
+			pool.schedule_after(first, [&values, &misordered, i, tasks] {
+				if (values[tasks - 1 - i] == 0)
+				{
+					misordered.fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+		}
+		srb2::ThreadPool::Sema second = pool.end_sema();
+
+		pool.notify_sema(second);
+		pool.wait_sema(second);
+
+		t = I_GetPreciseTime() - t;
+
+		CONS_Printf("Graph: 2 x %d tasks in %.0f us, %d ran too early\n",
+			tasks, t * 1000000.0 / I_GetPrecisePrecision(), misordered.load());
+	}
+}
@@ -0,0 +1,27 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+
+#ifndef __SRB2_CORE_THREAD_POOL_COMMANDS_H__
+#define __SRB2_CORE_THREAD_POOL_COMMANDS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// threadpoolstats [reset]: tasks run, stolen, deferred and sleeps per worker
+void Command_ThreadPoolStats_f(void);
+
+// threadpoolbench [tasks]: scheduling overhead, scaling from 1 to N cores, and task graphs
+void Command_ThreadPoolBench_f(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // __SRB2_CORE_THREAD_POOL_COMMANDS_H__
@@ -0,0 +1,309 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+
+#include "trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace
+{
+
+// Per thread; a power of two. At a few hundred events per frame
+// this holds the last several seconds.
+constexpr std::uint64_t kEventsPerThread = 1 << 15;
+
+enum class Phase : std::uint32_t
+{
+	kBegin,
+	kEnd,
+};
+
+// The dump reads these while their thread may be overwriting them,
+// so every field is atomic. Relaxed stores cost nothing extra.
+struct Event
+{
+	std::atomic<std::uint64_t> ns;
+	std::atomic<const char*> name;
+	std::atomic<Phase> phase;
+};
+
+struct ThreadEvents
+{
+	std::uint32_t tid = 0;
+	std::string name;
+	std::atomic<std::uint64_t> head {0}; // events ever written
+	bool retired = false; // its thread has exited
+	std::unique_ptr<Event[]> events = std::make_unique<Event[]>(kEventsPerThread);
+};
+
+struct Snapshot
+{
+	std::uint64_t ns;
+	const char* name;
+	Phase phase;
+};
+
+std::atomic<bool> g_enabled {false};
+const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+// Guards registration, names and dumping, never recording
+std::mutex g_threads_mutex;
+std::vector<std::shared_ptr<ThreadEvents>> g_threads;
+std::uint32_t g_next_tid = 1;
+
+// Never shrinks, so events can keep pointing into it
+std::mutex g_names_mutex;
+std::unordered_set<std::string> g_names;
+
+ThreadEvents* register_thread()
+{
+	std::lock_guard<std::mutex> _(g_threads_mutex);
+
+	std::shared_ptr<ThreadEvents> t;
+
+	// Keep the buffers of exited threads for dumping, but
+	// don't grow forever if threads keep coming and going.
+	auto it = std::find_if(g_threads.begin(), g_threads.end(), [](auto& t) { return t->retired; });
+	if (it != g_threads.end())
+	{
+		t = *it;
+		t->retired = false;
+		t->name.clear();
+		t->head.store(0, std::memory_order_relaxed);
+	}
+	else
+	{
+		t = std::make_shared<ThreadEvents>();
+		g_threads.push_back(t);
+	}
+
+	t->tid = g_next_tid++;
+
+	return t.get();
+}
+
+struct ThreadHolder
+{
+	ThreadEvents* events = nullptr;
+
+	ThreadEvents* get()
+	{
+		if (events == nullptr)
+		{
+			events = register_thread();
+		}
+
+		return events;
+	}
+
+	~ThreadHolder()
+	{
+		if (events != nullptr)
+		{
+			std::lock_guard<std::mutex> _(g_threads_mutex);
+			events->retired = true;
+		}
+	}
+};
+
+thread_local ThreadHolder t_events;
+
+void record(const char* name, Phase phase)
+{
+	ThreadEvents* t = t_events.get();
+	const std::uint64_t h = t->head.load(std::memory_order_relaxed);
+	const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epoch).count();
+
+	Event& e = t->events[h & (kEventsPerThread - 1)];
+	e.ns.store(static_cast<std::uint64_t>(ns), std::memory_order_relaxed);
+	e.name.store(name, std::memory_order_relaxed);
+	e.phase.store(phase, std::memory_order_relaxed);
+
+	t->head.store(h + 1, std::memory_order_release);
+}
+
+std::vector<Snapshot> snapshot(const ThreadEvents& t)
+{
+	const std::uint64_t head = t.head.load(std::memory_order_acquire);
+	std::uint64_t start = head > kEventsPerThread ? head - kEventsPerThread : 0;
+
+	std::vector<Snapshot> out;
+	out.reserve(head - start);
+
+	for (std::uint64_t i = start; i < head; ++i)
+	{
+		const Event& e = t.events[i & (kEventsPerThread - 1)];
+		out.push_back({
+			e.ns.load(std::memory_order_relaxed),
+			e.name.load(std::memory_order_relaxed),
+			e.phase.load(std::memory_order_relaxed),
+		});
+	}
+
+	// Anything the thread wrote meanwhile overwrote the oldest events,
+	// up to and including the one it may still be writing
+	const std::uint64_t now = t.head.load(std::memory_order_acquire) + 1;
+	if (now > kEventsPerThread && now - kEventsPerThread > start)
+	{
+		const std::uint64_t lost = std::min<std::uint64_t>(now - kEventsPerThread - start, out.size());
+		out.erase(out.begin(), out.begin() + lost);
+	}
+
+	return out;
+}
+
+std::string escape(const char* s)
+{
+	std::string out;
+
+	for (; *s; ++s)
+	{
+		if (*s == '"' || *s == '\\')
+		{
+			out += '\\';
+		}
+
+		if (static_cast<unsigned char>(*s) >= 0x20)
+		{
+			out += *s;
+		}
+	}
+
+	return out;
+}
+
+}; // namespace
+
+void Trace_SetEnabled(int enabled)
+{
+	g_enabled.store(enabled != 0, std::memory_order_relaxed);
+}
+
+void Trace_Begin(const char* name)
+{
+	if (g_enabled.load(std::memory_order_relaxed))
+	{
+		record(name, Phase::kBegin);
+	}
+}
+
+void Trace_End(void)
+{
+	if (g_enabled.load(std::memory_order_relaxed))
+	{
+		record(nullptr, Phase::kEnd);
+	}
+}
+
+void Trace_SetThreadName(const char* name)
+{
+	ThreadEvents* t = t_events.get();
+	std::lock_guard<std::mutex> _(g_threads_mutex);
+	t->name = name;
+}
+
+const char* Trace_InternName(const char* name)
+{
+	std::lock_guard<std::mutex> _(g_names_mutex);
+	return g_names.emplace(name).first->c_str();
+}
+
+long Trace_Dump(const char* path)
+{
+	std::FILE* f = std::fopen(path, "w");
+
+	if (f == nullptr)
+	{
+		return -1;
+	}
+
+	std::lock_guard<std::mutex> _(g_threads_mutex);
+
+	long count = 0;
+	bool first = true;
+
+	auto comma = [&]
+	{
+		if (!first)
+		{
+			fmt::print(f, ",\n");
+		}
+
+		first = false;
+	};
+
+	fmt::print(f, "{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	for (auto& t : g_threads)
+	{
+		comma();
+		fmt::print(
+			f,
+			"{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+			t->tid,
+			t->name.empty() ? fmt::format("Thread {}", t->tid) : escape(t->name.c_str())
+		);
+
+		// Ends whose begin has already been overwritten would
+		// close scopes that were never opened
+		int depth = 0;
+
+		for (const Snapshot& e : snapshot(*t))
+		{
+			if (e.phase == Phase::kEnd)
+			{
+				if (depth == 0)
+				{
+					continue;
+				}
+
+				depth--;
+			}
+			else
+			{
+				depth++;
+			}
+
+			comma();
+
+			if (e.phase == Phase::kBegin)
+			{
+				fmt::print(
+					f,
+					"{{\"name\":\"{}\",\"ph\":\"B\",\"ts\":{:.3f},\"pid\":1,\"tid\":{}}}",
+					e.name ? escape(e.name) : "?",
+					e.ns / 1000.0,
+					t->tid
+				);
+			}
+			else
+			{
+				fmt::print(f, "{{\"ph\":\"E\",\"ts\":{:.3f},\"pid\":1,\"tid\":{}}}", e.ns / 1000.0, t->tid);
+			}
+
+			count++;
+		}
+	}
+
+	fmt::print(f, "\n]}}\n");
+	std::fclose(f);
+
+	return count;
+}
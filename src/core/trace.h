@@ -0,0 +1,67 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+
+#ifndef __SRB2_CORE_TRACE_H__
+#define __SRB2_CORE_TRACE_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/// @brief Starts or stops recording events. Recording keeps the most recent events of each thread
+/// in a fixed size ring buffer, so it can be left on indefinitely.
+void Trace_SetEnabled(int enabled);
+
+/// @brief Begins a timed event on the calling thread. Thread-safe, and close to free while not recording.
+/// @param name must outlive the recording; a string literal is best
+void Trace_Begin(const char* name);
+
+/// @brief Ends the calling thread's most recent Trace_Begin.
+void Trace_End(void);
+
+/// @brief Names the calling thread in dumps. The name is copied.
+void Trace_SetThreadName(const char* name);
+
+/// @brief Copies a name that isn't a literal, such as a std::string's, somewhere that lives
+/// as long as the program. Equal names share one copy, so this is fine to call once per object.
+const char* Trace_InternName(const char* name);
+
+/// @brief Writes every thread's recorded events to a Chrome trace event JSON file, which
+/// chrome://tracing and ui.perfetto.dev can open. Recording carries on while this runs.
+/// @return the number of events written, or -1 if the file couldn't be opened
+long Trace_Dump(const char* path);
+
+#ifdef __cplusplus
+} // extern "C"
+
+namespace srb2
+{
+
+class TraceScope
+{
+public:
+	explicit TraceScope(const char* name) { Trace_Begin(name); }
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+	~TraceScope() { Trace_End(); }
+};
+
+}; // namespace srb2
+
+#define SRB2_TRACE_CONCAT2(a, b) a##b
+#define SRB2_TRACE_CONCAT(a, b) SRB2_TRACE_CONCAT2(a, b)
+
+/// @brief Traces the rest of the enclosing scope.
+#define TraceScoped(name) srb2::TraceScope SRB2_TRACE_CONCAT(srb2_trace_scope_, __LINE__)(name)
+
+#endif // __cplusplus
+
+#endif // __SRB2_CORE_TRACE_H__
@@ -0,0 +1,45 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+
+#include "trace_commands.h"
+
+#include <string>
+
+#include <fmt/format.h>
+
+#include "../command.h"
+#include "../console.h"
+#include "../d_main.h" // srb2home
+#include "../d_netcmd.h" // cv_trace
+#include "../doomdef.h"
+#include "trace.h"
+
+void Trace_OnChange(void)
+{
+	Trace_SetEnabled(cv_trace.value);
+}
+
+void Command_TraceDump_f(void)
+{
+	const std::string path = fmt::format("{}" PATHSEP "{}", srb2home, COM_Argc() < 2 ? "trace.json" : COM_Argv(1));
+	const long events = Trace_Dump(path.c_str());
+
+	if (events < 0)
+	{
+		CONS_Alert(CONS_ERROR, "Couldn't open %s for writing.\n", path.c_str());
+		return;
+	}
+
+	CONS_Printf("Wrote %ld trace events to %s.\n", events, path.c_str());
+
+	if (events == 0 && !cv_trace.value)
+	{
+		CONS_Printf("Set trace to On to start recording.\n");
+	}
+}
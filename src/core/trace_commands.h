@@ -0,0 +1,27 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+
+#ifndef __SRB2_CORE_TRACE_COMMANDS_H__
+#define __SRB2_CORE_TRACE_COMMANDS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// trace on/off: record the last few seconds of every thread
+void Trace_OnChange(void);
+
+// tracedump [file]: write the recording as Chrome trace JSON to srb2home
+void Command_TraceDump_f(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // __SRB2_CORE_TRACE_COMMANDS_H__
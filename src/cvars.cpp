@@ -415,6 +415,9 @@ consvar_t cv_soundmixingbuffersize = Player("snd_mixingbuffersize", "2048")
 extern CV_PossibleValue_t perfstats_cons_t[];
 consvar_t cv_perfstats = Player("perfstats", "Off").dont_save().values(perfstats_cons_t);
 
+void Trace_OnChange(void);
+consvar_t cv_trace = Player("trace", "Off").on_off().dont_save().onchange(Trace_OnChange).description("Record frame timings for tracedump");
+
 // Window focus sound sytem toggles
 void BGAudio_OnChange(void);
 void BGAudio_OnChange(void);
@@ -433,6 +436,7 @@ consvar_t cv_renderer = Player("renderer", "Software").flags(CV_NOLUA).values(cv
 consvar_t cv_parallelsoftware = Player("parallelsoftware", "On").on_off();
 
 consvar_t cv_renderview = Player("renderview", "On").values({{0, "Off"}, {1, "On"}, {2, "Force"}}).dont_save();
+consvar_t cv_rewindmemory = Player("rewindmemory", "64").values(CV_Natural); // megabytes of demo rewind points
 consvar_t cv_rollingdemos = Player("rollingdemos", "On").on_off();
 consvar_t cv_scr_depth = Player("scr_depth", "16 bits").values({{8, "8 bits"}, {16, "16 bits"}, {24, "24 bits"}, {32, "32 bits"}});
 
@@ -546,6 +550,7 @@ consvar_t cv_netdemosize = Server("netdemo_size", "6").values(CV_Natural);
 void NetTimeout_OnChange(void);
 consvar_t cv_nettimeout = Server("nettimeout", "210").min_max(TICRATE/7, 60*TICRATE).onchange(NetTimeout_OnChange);
 
+consvar_t cv_parallelbots = Server("parallelbots", "On").on_off();
 consvar_t cv_pause = NetVar("pausepermission", "Server Admins").values({{0, "Server Admins"}, {1, "Everyone"}});
 consvar_t cv_pingmeasurement = Server("pingmeasurement", "Frames").values({{0, "Frames"}, {1, "Milliseconds"}});
 consvar_t cv_playbackspeed = Server("playbackspeed", "1").min_max(1, 10).dont_save();
@@ -70,6 +70,7 @@
 #include "sanitize.h"
 #include "r_fps.h"
 #include "filesrch.h" // refreshdirmenu
+#include "core/trace.h"
 
 // cl loading screen
 #include "v_video.h"
@@ -112,9 +113,25 @@ UINT8 playernode[MAXPLAYERS];
 tic_t jointimeout = (3*TICRATE);
 static boolean sendingsavegame[MAXNETNODES]; // Are we sending the savegame?
 static boolean resendingsavegame[MAXNETNODES]; // Are we resending the savegame?
+static boolean sentsavegamedelta[MAXNETNODES]; // Was the savegame we're sending a delta?
 static tic_t savegameresendcooldown[MAXNETNODES]; // How long before we can resend again?
 static tic_t freezetimeout[MAXNETNODES]; // Until when can this node freeze the server before getting a timeout?
 
+// A serialised gamestate, kept around so resends only have to carry what changed
+typedef struct
+{
+	UINT8 *data;
+	size_t length;
+	UINT32 hash;
+} gamestateimage_t;
+
+static gamestateimage_t ackedsavegame[MAXNETNODES]; // Last gamestate this node told us it loaded
+static gamestateimage_t pendingsavegame[MAXNETNODES]; // Gamestate we are sending this node right now
+
+// Gamestate transfer statistics, for "gamestatestats"
+static size_t gamestatesends, gamestatedeltas;
+static size_t gamestatefullbytes, gamestatesentbytes;
+
 // Incremented by cv_joindelay when a client joins, decremented each tic.
 // If higher than cv_joindelay * 2 (3 joins in a short timespan), joins are temporarily disabled.
 static tic_t joindelay = 0;
@@ -164,6 +181,7 @@ static boolean cl_packetmissed;
 // here it is for the secondary local player (splitscreen)
 static UINT8 mynode; // my address pointofview server
 static boolean cl_redownloadinggamestate = false;
+static gamestateimage_t cl_gamestatebase; // Last gamestate we loaded, the base for delta resends
 
 static UINT8 localtextcmd[MAXSPLITSCREENPLAYERS][MAXTEXTCMD];
 static tic_t neededtic;
@@ -1248,11 +1266,82 @@ static boolean SV_ResendingSavegameToAnyone(void)
 	return false;
 }
 
-static void SV_SendSaveGame(INT32 node, boolean resending)
+// Gamestate file layout: kind, base hash, image length, then the end offset
+// and hash of every netsave section, then a compressed flag and the payload.
+// A delta's payload is the image XORed against the base the client has.
+#define GAMESTATE_FULL 0
+#define GAMESTATE_DELTA 1
+#define GAMESTATE_HEADERSIZE (1 + 4 + 4 + 8*NUMNETSAVESECTIONS + 1)
+
+static const char *const netsavesectionnames[NUMNETSAVESECTIONS] = {
+	"misc",
+	"players",
+	"world",
+	"thinkers",
+	"scripts",
+};
+
+static UINT32 D_GamestateHash(const UINT8 *data, size_t length)
+{
+	UINT32 hash = 2166136261u; // FNV-1a
+
+	while (length--)
+	{
+		hash ^= *data++;
+		hash *= 16777619u;
+	}
+
+	return hash ? hash : 1; // 0 means "no gamestate"
+}
+
+static void D_FreeGamestateImage(gamestateimage_t *image)
+{
+	if (image->data)
+		Z_Free(image->data);
+	image->data = NULL;
+	image->length = 0;
+	image->hash = 0;
+}
+
+static UINT8 *SV_PackGamestate(UINT8 kind, UINT32 basehash, const UINT32 *sectionhashes, const UINT8 *payload, size_t length, size_t *packedlen)
+{
+	UINT8 *packed = Z_Malloc(GAMESTATE_HEADERSIZE + length, PU_STATIC, NULL);
+	UINT8 *p = packed;
+	size_t compressedlen;
+	INT32 i;
+
+	WRITEUINT8(p, kind);
+	WRITEUINT32(p, basehash);
+	WRITEUINT32(p, length);
+
+	for (i = 0; i < NUMNETSAVESECTIONS; i++)
+	{
+		WRITEUINT32(p, netsavesections[i]);
+		WRITEUINT32(p, sectionhashes[i]);
+	}
+
+	// One byte fewer than the raw payload, to ensure that compression is worthwhile
+	if ((compressedlen = lzf_compress(payload, length, p + 1, length - 1)))
+	{
+		WRITEUINT8(p, true);
+		*packedlen = GAMESTATE_HEADERSIZE + compressedlen;
+	}
+	else
+	{
+		WRITEUINT8(p, false);
+		M_Memcpy(p, payload, length);
+		*packedlen = GAMESTATE_HEADERSIZE + length;
+	}
+
+	return packed;
+}
+
+static void SV_SendSaveGame(INT32 node, boolean resending, UINT32 clientbase)
 {
-	size_t length, compressedlen;
+	size_t length, fulllen, deltalen, start, i;
 	savebuffer_t save = {0};
-	UINT8 *compressedsave;
+	UINT32 sectionhashes[NUMNETSAVESECTIONS];
+	gamestateimage_t *base = &ackedsavegame[node];
 	UINT8 *buffertosend;
 
 	// first save it in a malloced buffer
@@ -1262,9 +1351,6 @@ static void SV_SendSaveGame(INT32 node, boolean resending)
 		return;
 	}
 
-	// Leave room for the uncompressed length.
-	save.p += sizeof(UINT32);
-
 	P_SaveNetGame(&save, resending);
 
 	length = save.p - save.buffer;
@@ -1274,41 +1360,56 @@ static void SV_SendSaveGame(INT32 node, boolean resending)
 		I_Error("Savegame buffer overrun");
 	}
 
-	// Allocate space for compressed save: one byte fewer than for the
-	// uncompressed data to ensure that the compression is worthwhile.
-	compressedsave = Z_Malloc(length - 1, PU_STATIC, NULL);
-	if (!compressedsave)
+	for (i = 0, start = 0; i < NUMNETSAVESECTIONS; i++)
 	{
-		CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
-		return;
+		sectionhashes[i] = D_GamestateHash(save.buffer + start, netsavesections[i] - start);
+		start = netsavesections[i];
 	}
 
-	// Attempt to compress it.
-	if ((compressedlen = lzf_compress(save.buffer + sizeof(UINT32), length - sizeof(UINT32), compressedsave + sizeof(UINT32), length - sizeof(UINT32) - 1)))
-	{
-		// Compressing succeeded; send compressed data
-		P_SaveBufferFree(&save);
+	buffertosend = SV_PackGamestate(GAMESTATE_FULL, 0, sectionhashes, save.buffer, length, &fulllen);
+	gamestatefullbytes += fulllen;
+	sentsavegamedelta[node] = false;
 
-		// State that we're compressed.
-		buffertosend = compressedsave;
-		WRITEUINT32(compressedsave, length - sizeof(UINT32));
-		length = compressedlen + sizeof(UINT32);
-	}
-	else
+	// If the client still has the last gamestate we gave them, they only need what changed since
+	if (resending && base->data && base->hash == clientbase)
 	{
-		// Compression failed to make it smaller; send original
-		Z_Free(compressedsave);
+		UINT8 *diff = Z_Malloc(length, PU_STATIC, NULL);
+		UINT8 *delta;
+
+		for (i = 0; i < length; i++)
+			diff[i] = save.buffer[i] ^ (i < base->length ? base->data[i] : 0);
+
+		delta = SV_PackGamestate(GAMESTATE_DELTA, base->hash, sectionhashes, diff, length, &deltalen);
+		Z_Free(diff);
 
-		// State that we're not compressed
-		buffertosend = save.buffer;
-		WRITEUINT32(save.buffer, 0);
+		if (deltalen < fulllen)
+		{
+			Z_Free(buffertosend);
+			buffertosend = delta;
+			gamestatedeltas++;
+			sentsavegamedelta[node] = true;
+
+			CONS_Printf(M_GetText("Sending game state delta of %s bytes instead of %s\n"), sizeu1(deltalen), sizeu2(fulllen));
+			fulllen = deltalen;
+		}
+		else
+			Z_Free(delta);
 	}
 
-	AddRamToSendQueue(node, buffertosend, length, SF_Z_RAM, 0);
+	gamestatesends++;
+	gamestatesentbytes += fulllen;
+
+	// Keep what we sent, it becomes this node's base once they confirm they loaded it
+	D_FreeGamestateImage(&pendingsavegame[node]);
+	pendingsavegame[node].data = Z_Realloc(save.buffer, length, PU_STATIC, NULL);
+	pendingsavegame[node].length = length;
+	pendingsavegame[node].hash = D_GamestateHash(pendingsavegame[node].data, length);
+
+	AddRamToSendQueue(node, buffertosend, fulllen, SF_Z_RAM, 0);
 
 	// Remember when we started sending the savegame so we can handle timeouts
 	sendingsavegame[node] = true;
-	freezetimeout[node] = I_GetTime() + jointimeout + length / 1024; // 1 extra tic for each kilobyte
+	freezetimeout[node] = I_GetTime() + jointimeout + fulllen / 1024; // 1 extra tic for each kilobyte
 }
 
 #ifdef DUMPCONSISTENCY
@@ -1355,35 +1456,102 @@ static void SV_SavedGame(void)
 #define TMPSAVENAME "$$$.sav"
 
 
-static void CL_LoadReceivedSavegame(boolean reloading)
+// Reads the gamestate the server sent, rebuilding it from our last one if it is a delta
+static boolean CL_UnpackReceivedSavegame(savebuffer_t *save)
 {
-	savebuffer_t save = {0};
-	size_t length, decompressedlen;
+	savebuffer_t packed = {0};
+	UINT32 sectionends[NUMNETSAVESECTIONS], sectionhashes[NUMNETSAVESECTIONS];
+	UINT32 basehash;
+	UINT8 kind, compressed;
+	UINT8 *image = NULL;
+	size_t length, datalen, start, i;
 	char tmpsave[256];
 
 	sprintf(tmpsave, "%s" PATHSEP TMPSAVENAME, srb2home);
 
-	if (P_SaveBufferFromFile(&save, tmpsave) == false)
+	if (P_SaveBufferFromFile(&packed, tmpsave) == false)
 	{
 		I_Error("Can't read savegame sent");
-		return;
+		return false;
 	}
 
-	length = save.size;
-	CONS_Printf(M_GetText("Loading savegame length %s\n"), sizeu1(length));
+	CONS_Printf(M_GetText("Loading savegame length %s\n"), sizeu1(packed.size));
+
+	if (packed.size < GAMESTATE_HEADERSIZE)
+		goto badgamestate;
 
-	// Decompress saved game if necessary.
-	decompressedlen = READUINT32(save.p);
-	if (decompressedlen > 0)
+	kind = READUINT8(packed.p);
+	basehash = READUINT32(packed.p);
+	length = READUINT32(packed.p);
+	for (i = 0; i < NUMNETSAVESECTIONS; i++)
 	{
-		UINT8 *decompressedbuffer = Z_Malloc(decompressedlen, PU_STATIC, NULL);
+		sectionends[i] = READUINT32(packed.p);
+		sectionhashes[i] = READUINT32(packed.p);
+	}
+	compressed = READUINT8(packed.p);
+	datalen = packed.end - packed.p;
 
-		lzf_decompress(save.p, length - sizeof(UINT32), decompressedbuffer, decompressedlen);
+	if (length == 0 || length > NETSAVEGAMESIZE)
+		goto badgamestate;
 
-		P_SaveBufferFree(&save);
-		P_SaveBufferFromExisting(&save, decompressedbuffer, decompressedlen);
+	image = Z_Malloc(length, PU_STATIC, NULL);
+
+	if (compressed)
+	{
+		if (lzf_decompress(packed.p, datalen, image, length) != length)
+			goto badgamestate;
+	}
+	else
+	{
+		if (datalen != length)
+			goto badgamestate;
+		M_Memcpy(image, packed.p, length);
+	}
+
+	if (kind == GAMESTATE_DELTA)
+	{
+		if (cl_gamestatebase.data == NULL || cl_gamestatebase.hash != basehash)
+		{
+			CONS_Alert(CONS_WARNING, M_GetText("Game state delta is against a game state we don't have\n"));
+			goto badgamestate;
+		}
+
+		for (i = 0; i < length && i < cl_gamestatebase.length; i++)
+			image[i] ^= cl_gamestatebase.data[i];
+	}
+
+	for (i = 0, start = 0; i < NUMNETSAVESECTIONS; i++)
+	{
+		if (sectionends[i] < start || sectionends[i] > length)
+			goto badgamestate;
+
+		if (D_GamestateHash(image + start, sectionends[i] - start) != sectionhashes[i])
+		{
+			CONS_Alert(CONS_WARNING, M_GetText("Game state %s section doesn't match the server's\n"), netsavesectionnames[i]);
+			goto badgamestate;
+		}
+
+		start = sectionends[i];
 	}
 
+	P_SaveBufferFree(&packed);
+	P_SaveBufferFromExisting(save, image, length);
+	return true;
+
+badgamestate:
+	P_SaveBufferFree(&packed);
+	if (image)
+		Z_Free(image);
+	return false;
+}
+
+static void CL_LoadReceivedSavegame(savebuffer_t *save, boolean reloading)
+{
+	char tmpsave[256];
+	UINT32 hash = D_GamestateHash(save->buffer, save->size);
+
+	sprintf(tmpsave, "%s" PATHSEP TMPSAVENAME, srb2home);
+
 	paused = false;
 	demo.playback = false;
 	demo.attract = DEMO_ATTRACT_OFF;
@@ -1392,7 +1560,7 @@ static void CL_LoadReceivedSavegame(boolean reloading)
 	automapactive = false;
 
 	// load a base level
-	if (P_LoadNetGame(&save, reloading))
+	if (P_LoadNetGame(save, reloading))
 	{
 		if (!reloading)
 		{
@@ -1413,8 +1581,13 @@ static void CL_LoadReceivedSavegame(boolean reloading)
 		}
 	}
 
-	// done
-	P_SaveBufferFree(&save);
+	// done, keep the image so the next resend can be a delta against it
+	D_FreeGamestateImage(&cl_gamestatebase);
+	cl_gamestatebase.data = save->buffer;
+	cl_gamestatebase.length = save->size;
+	cl_gamestatebase.hash = hash;
+	save->buffer = save->p = save->end = NULL;
+	save->size = 0;
 
 	if (unlink(tmpsave) == -1)
 	{
@@ -1443,17 +1616,52 @@ static void CL_LoadReceivedSavegame(boolean reloading)
 	}
 }
 
+static boolean CL_AskForGamestate(void)
+{
+	char tmpsave[256];
+
+	// Send back a PT_CANRECEIVEGAMESTATE packet to the server
+	// so they know they can start sending the game state,
+	// along with which one we already have for them to diff against
+	netbuffer->packettype = PT_CANRECEIVEGAMESTATE;
+	netbuffer->u.gamestatebase = LONG(cl_gamestatebase.hash);
+	if (!HSendPacket(servernode, true, 0, sizeof(UINT32)))
+		return false;
+
+	sprintf(tmpsave, "%s" PATHSEP TMPSAVENAME, srb2home);
+
+	// Don't get a corrupt savegame error because tmpsave already exists
+	if (FIL_FileExists(tmpsave) && unlink(tmpsave) == -1)
+		I_Error("Can't delete %s\n", tmpsave);
+
+	CL_PrepareDownloadSaveGame(tmpsave);
+	return true;
+}
+
 static void CL_ReloadReceivedSavegame(void)
 {
+	savebuffer_t save = {0};
 	INT32 i;
 
+	if (CL_UnpackReceivedSavegame(&save) == false)
+	{
+		if (cl_gamestatebase.data == NULL)
+			I_Error("Can't read savegame sent");
+
+		// Our last gamestate must not be the one the server thinks we have, so ask for all of it
+		CONS_Printf(M_GetText("Game state delta didn't apply, asking for a full one...\n"));
+		D_FreeGamestateImage(&cl_gamestatebase);
+		CL_AskForGamestate();
+		return;
+	}
+
 	for (i = 0; i < MAXPLAYERS; i++)
 	{
 		LUA_InvalidatePlayer(&players[i]);
 		sprintf(player_names[i], "Player %c", 'A' + i);
 	}
 
-	CL_LoadReceivedSavegame(true);
+	CL_LoadReceivedSavegame(&save, true);
 
 	if (neededtic < gametic)
 		neededtic = gametic;
@@ -2109,8 +2317,13 @@ static boolean CL_ServerConnectionTicker(const char *tmpsave, tic_t *oldtic, tic
 			// At this state, the first (and only) needed file is the gamestate
 			if (fileneeded[0].status == FS_FOUND)
 			{
+				savebuffer_t save = {0};
+
+				if (CL_UnpackReceivedSavegame(&save) == false)
+					I_Error("Can't read savegame sent");
+
 				// Gamestate is now handled within CL_LoadReceivedSavegame()
-				CL_LoadReceivedSavegame(false);
+				CL_LoadReceivedSavegame(&save, false);
 				cl_mode = CL_CONNECTED;
 				break;
 			} // don't break case continue to CL_CONNECTED
@@ -3224,6 +3437,19 @@ static void Command_ResendGamestate(void)
 	}
 }
 
+static void Command_GamestateStats(void)
+{
+	if (client)
+	{
+		CONS_Printf(M_GetText("Only the server can use this.\n"));
+		return;
+	}
+
+	CONS_Printf(M_GetText("Game states sent: %s, %s of them as deltas\n"), sizeu1(gamestatesends), sizeu2(gamestatedeltas));
+	CONS_Printf(M_GetText("Bytes sent: %s of %s as full images\n"), sizeu1(gamestatesentbytes), sizeu2(gamestatefullbytes));
+	CONS_Printf(M_GetText("Bytes saved: %s\n"), sizeu1(gamestatefullbytes - gamestatesentbytes));
+}
+
 static void Got_AddPlayer(const UINT8 **p, INT32 playernum);
 static void Got_RemovePlayer(const UINT8 **p, INT32 playernum);
 static void Got_AddBot(const UINT8 **p, INT32 playernum);
@@ -3266,11 +3492,13 @@ void D_ClientServerInit(void)
 	COM_AddCommand("list_http_logins", Command_list_http_logins);
 #endif
 	COM_AddCommand("resendgamestate", Command_ResendGamestate);
+	COM_AddDebugCommand("gamestatestats", Command_GamestateStats);
 #ifdef PACKETDROP
 	COM_AddCommand("drop", Command_Drop);
 	COM_AddCommand("droprate", Command_Droprate);
 #endif
 	COM_AddCommand("numnodes", Command_Numnodes);
+	COM_AddDebugCommand("netbench", Command_NetBench);
 
 	RegisterNetXCmd(XD_KICK, Got_KickCmd);
 	RegisterNetXCmd(XD_ADDPLAYER, Got_AddPlayer);
@@ -3310,7 +3538,10 @@ static void ResetNode(INT32 node)
 
 	sendingsavegame[node] = false;
 	resendingsavegame[node] = false;
+	sentsavegamedelta[node] = false;
 	savegameresendcooldown[node] = 0;
+	D_FreeGamestateImage(&ackedsavegame[node]);
+	D_FreeGamestateImage(&pendingsavegame[node]);
 
 	bannednode[node].banid = SIZE_MAX;
 	bannednode[node].timeleft = NO_BAN_TIME;
@@ -3361,6 +3592,7 @@ void SV_ResetServer(void)
 	mynode = 0;
 	cl_packetmissed = false;
 	cl_redownloadinggamestate = false;
+	D_FreeGamestateImage(&cl_gamestatebase);
 
 	if (dedicated)
 	{
@@ -4267,7 +4499,7 @@ static void HandleConnect(SINT8 node)
 		{
 			if (node && newnode)
 			{
-				SV_SendSaveGame(node, false); // send a complete game state
+				SV_SendSaveGame(node, false, 0); // send a complete game state
 				DEBFILE("send savegame\n");
 			}
 
@@ -4354,8 +4586,6 @@ static void HandleServerInfo(SINT8 node)
 
 static void PT_WillResendGamestate(void)
 {
-	char tmpsave[256];
-
 	if (server || cl_redownloadinggamestate)
 		return;
 
@@ -4367,33 +4597,31 @@ static void PT_WillResendGamestate(void)
 		memcpy(priorKeys[i], players[i].public_key, sizeof(priorKeys[i]));
 	}
 
-	// Send back a PT_CANRECEIVEGAMESTATE packet to the server
-	// so they know they can start sending the game state
-	netbuffer->packettype = PT_CANRECEIVEGAMESTATE;
-	if (!HSendPacket(servernode, true, 0, 0))
+	if (!CL_AskForGamestate())
 		return;
 
 	CONS_Printf(M_GetText("Reloading game state...\n"));
 
-	sprintf(tmpsave, "%s" PATHSEP TMPSAVENAME, srb2home);
-
-	// Don't get a corrupt savegame error because tmpsave already exists
-	if (FIL_FileExists(tmpsave) && unlink(tmpsave) == -1)
-		I_Error("Can't delete %s\n", tmpsave);
-
-	CL_PrepareDownloadSaveGame(tmpsave);
-
 	cl_redownloadinggamestate = true;
 }
 
 static void PT_CanReceiveGamestate(SINT8 node)
 {
-	if (client || sendingsavegame[node])
+	UINT32 clientbase = 0;
+
+	if (client)
+		return;
+
+	if ((size_t)doomcom->datalength >= BASEPACKETSIZE + sizeof(UINT32))
+		clientbase = (UINT32)LONG(netbuffer->u.gamestatebase);
+
+	// A client that couldn't apply the delta we sent may ask once more, for a full one
+	if (sendingsavegame[node] && !(sentsavegamedelta[node] && clientbase == 0))
 		return;
 
 	CONS_Printf(M_GetText("Resending game state to %s...\n"), player_names[nodetoplayer[node]]);
 
-	SV_SendSaveGame(node, true); // Resend a complete game state
+	SV_SendSaveGame(node, true, clientbase); // Resend the game state, or what changed since their last one
 	resendingsavegame[node] = true;
 }
 
@@ -5197,6 +5425,15 @@ static void HandlePacketFromPlayer(SINT8 node)
 		case PT_RECEIVEDGAMESTATE:
 			sendingsavegame[node] = false;
 			resendingsavegame[node] = false;
+			sentsavegamedelta[node] = false;
+			if (pendingsavegame[node].data)
+			{
+				D_FreeGamestateImage(&ackedsavegame[node]);
+				ackedsavegame[node] = pendingsavegame[node];
+				pendingsavegame[node].data = NULL;
+				pendingsavegame[node].length = 0;
+				pendingsavegame[node].hash = 0;
+			}
 			savegameresendcooldown[node] = I_GetTime() + 5 * TICRATE;
 			break;
 // -------------------------------------------- CLIENT RECEIVE ----------
@@ -5468,6 +5705,8 @@ static void GetPackets(void)
 
 	player_joining = false;
 
+	Trace_Begin("Get Packets");
+
 	while (HGetPacket())
 	{
 		node = (SINT8)doomcom->remotenode;
@@ -5510,6 +5749,8 @@ static void GetPackets(void)
 		else
 			HandlePacketFromAwayNode(node);
 	}
+
+	Trace_End();
 }
 
 //
@@ -6004,6 +6245,8 @@ static void SV_Maketic(void)
 
 	PS_ResetBotInfo();
 
+	K_BuildBotTiccmds(netcmds[maketic%BACKUPTICS]);
+
 	for (i = 0; i < MAXPLAYERS; i++)
 	{
 		packetloss[i][maketic%PACKETMEASUREWINDOW] = false;
@@ -6013,13 +6256,7 @@ static void SV_Maketic(void)
 
 		if (K_PlayerUsesBotMovement(&players[i]))
 		{
-			const precise_t t = I_GetPreciseTime();
-
-			K_BuildBotTiccmd(&players[i], &netcmds[maketic%BACKUPTICS][i]);
-
-			ps_bots[i].isBot = true;
-			ps_bots[i].total = I_GetPreciseTime() - t;
-			ps_botticcmd_time += ps_bots[i].total;
+			// Bot ticcmd is generated by K_BuildBotTiccmds
 			continue;
 		}
 
@@ -6598,6 +6835,9 @@ void NetKeepAlive(void)
 	Net_AckTicker();
 	HandleNodeTimeouts();
 	FileSendTicker();
+
+	if (I_NetFlush)
+		I_NetFlush();
 }
 
 // If a tree falls in the forest but nobody is around to hear it, does it make a tic?
@@ -6746,7 +6986,13 @@ void NetUpdate(void)
 			for (; tictoclear < firstticstosend; tictoclear++) // Clear only when acknowledged
 				D_Clearticcmd(tictoclear);                    // Clear the maketic the new tic
 
+			Trace_Begin("Send Tics");
 			SV_SendTics();
+			Trace_End();
+
+			// Get this tic out to everyone at once
+			if (I_NetFlush)
+				I_NetFlush();
 
 			neededtic = maketic; // The server is a client too
 		}
@@ -6783,6 +7029,10 @@ void NetUpdate(void)
 	}
 
 	FileSendTicker();
+
+	// Client cmds and file parts shouldn't wait for the next receive
+	if (I_NetFlush)
+		I_NetFlush();
 }
 
 /** Returns the number of players playing.
@@ -6825,39 +7075,179 @@ tic_t GetLag(INT32 node)
 	return gametic - nettics[node];
 }
 
+// Rewind points are kept as a keyframe every REWIND_KEYFRAME_INTERVAL
+// points, with the ones in between stored as the XOR against the point
+// before them. Nearly all of the game state stays the same over a few
+// seconds, so those come out as long runs of zeroes that LZF packs down
+// to almost nothing. Rewinding only has to replay back from the nearest
+// keyframe. Once they use more than cv_rewindmemory, the oldest keyframe
+// and everything that depends on it is dropped.
 #define REWIND_POINT_INTERVAL 4*TICRATE + 16
+#define REWIND_KEYFRAME_INTERVAL 8
 rewind_t *rewindhead;
 
+static UINT8 *rewindimage; // Uncompressed image of rewindhead
+static size_t rewindimagelen;
+static UINT8 *rewindwork; // Scratch space for encoding and decoding
+static size_t rewindmemory; // Total size of the stored rewind points
+
+static void CL_FreeRewind(rewind_t *rewind)
+{
+	rewindmemory -= sizeof (rewind_t) + rewind->datalen;
+	free(rewind->data);
+	free(rewind);
+}
+
 void CL_ClearRewinds(void)
 {
 	rewind_t *head;
 	while ((head = rewindhead))
 	{
 		rewindhead = rewindhead->next;
-		free(head);
+		CL_FreeRewind(head);
+	}
+	rewindimagelen = 0;
+}
+
+// Drop the oldest keyframe, and all of the points between it and the next one
+static boolean CL_DropOldestRewinds(void)
+{
+	rewind_t *rewind, *oldestkey = NULL, *keepkey = NULL;
+
+	// The list runs newest first, so the last two keyframes found are the
+	// oldest one and the one after it, which is the oldest one kept
+	for (rewind = rewindhead; rewind; rewind = rewind->next)
+	{
+		if (rewind->keyframe)
+		{
+			keepkey = oldestkey;
+			oldestkey = rewind;
+		}
+	}
+
+	// Always keep the points the newest one depends on
+	if (keepkey == NULL)
+		return false;
+
+	// Everything past the kept keyframe only leads back to the oldest one
+	while ((rewind = keepkey->next))
+	{
+		keepkey->next = rewind->next;
+		CL_FreeRewind(rewind);
 	}
+
+	return true;
+}
+
+// Turn the point back into the full save image, assuming that the
+// image of the point before it is already in dest.
+static void CL_DecodeRewind(const rewind_t *rewind, UINT8 *dest, size_t destlen)
+{
+	UINT8 *raw = rewind->keyframe ? dest : rewindwork;
+	const size_t common = min(rewind->rawlen, destlen);
+	size_t i;
+
+	if (rewind->compressed)
+		lzf_decompress(rewind->data, rewind->datalen, raw, rewind->rawlen);
+	else
+		memcpy(raw, rewind->data, rewind->rawlen);
+
+	if (rewind->keyframe)
+		return;
+
+	for (i = 0; i < common; i++)
+		dest[i] ^= raw[i];
+	if (rewind->rawlen > destlen)
+		memcpy(dest + destlen, raw + destlen, rewind->rawlen - destlen);
 }
 
 rewind_t *CL_SaveRewindPoint(size_t demopos)
 {
 	savebuffer_t save = {0};
 	rewind_t *rewind;
+	UINT8 *raw;
+	size_t rawlen, common, datalen, i;
+	boolean keyframe;
 
 	if (rewindhead && rewindhead->leveltime + REWIND_POINT_INTERVAL > leveltime)
 		return NULL;
 
-	rewind = (rewind_t *)malloc(sizeof (rewind_t));
+	if (rewindimage == NULL)
+	{
+		rewindimage = malloc(NETSAVEGAMESIZE);
+		rewindwork = malloc(NETSAVEGAMESIZE);
+		if (!rewindimage || !rewindwork)
+		{
+			free(rewindimage);
+			free(rewindwork);
+			rewindimage = rewindwork = NULL;
+			return NULL;
+		}
+	}
+
+	rewind = (rewind_t *)calloc(1, sizeof (rewind_t));
 	if (!rewind)
 		return NULL;
 
-	P_SaveBufferFromExisting(&save, rewind->savebuffer, NETSAVEGAMESIZE);
+	keyframe = (rewindhead == NULL || rewindhead->sincekeyframe + 1 >= REWIND_KEYFRAME_INTERVAL);
+
+	// Save straight into the image buffer for keyframes, otherwise
+	// into the scratch space so it can be XOR'd with the last image.
+	raw = keyframe ? rewindimage : rewindwork;
+	P_SaveBufferFromExisting(&save, raw, NETSAVEGAMESIZE);
 	P_SaveNetGame(&save, false);
+	rawlen = save.p - save.buffer;
 
+	if (!keyframe)
+	{
+		common = min(rawlen, rewindimagelen);
+		for (i = 0; i < common; i++)
+		{
+			const UINT8 cur = raw[i];
+			raw[i] ^= rewindimage[i];
+			rewindimage[i] = cur;
+		}
+		if (rawlen > rewindimagelen)
+			memcpy(rewindimage + rewindimagelen, raw + rewindimagelen, rawlen - rewindimagelen);
+	}
+	rewindimagelen = rawlen;
+
+	rewind->data = malloc(rawlen);
+	if (!rewind->data)
+	{
+		free(rewind);
+		CL_ClearRewinds(); // The image no longer matches rewindhead
+		return NULL;
+	}
+
+	datalen = lzf_compress(raw, rawlen, rewind->data, rawlen - 1);
+	if (datalen)
+	{
+		UINT8 *shrunk = realloc(rewind->data, datalen);
+		if (shrunk)
+			rewind->data = shrunk;
+		rewind->compressed = true;
+	}
+	else
+	{
+		memcpy(rewind->data, raw, rawlen);
+		datalen = rawlen;
+	}
+
+	rewind->datalen = datalen;
+	rewind->rawlen = rawlen;
+	rewind->keyframe = keyframe;
+	rewind->sincekeyframe = keyframe ? 0 : rewindhead->sincekeyframe + 1;
 	rewind->leveltime = leveltime;
 	rewind->next = rewindhead;
 	rewind->demopos = demopos;
 	rewindhead = rewind;
 
+	rewindmemory += sizeof (rewind_t) + datalen;
+
+	while (rewindmemory > (size_t)cv_rewindmemory.value * 1024 * 1024 && CL_DropOldestRewinds())
+		;
+
 	return rewind;
 }
 
@@ -6865,18 +7255,44 @@ rewind_t *CL_RewindToTime(tic_t time)
 {
 	savebuffer_t save = {0};
 	rewind_t *rewind;
+	rewind_t *chain[REWIND_KEYFRAME_INTERVAL];
+	INT32 i;
 
 	while (rewindhead && rewindhead->leveltime > time)
 	{
 		rewind = rewindhead->next;
-		free(rewindhead);
+		CL_FreeRewind(rewindhead);
 		rewindhead = rewind;
 	}
 
 	if (!rewindhead)
+	{
+		rewindimagelen = 0;
 		return NULL;
+	}
+
+	// Replay forward from the keyframe this point depends on
+	for (i = 0, rewind = rewindhead; rewind && i < REWIND_KEYFRAME_INTERVAL; rewind = rewind->next)
+	{
+		chain[i++] = rewind;
+		if (rewind->keyframe)
+			break;
+	}
+
+	if (!chain[i - 1]->keyframe)
+	{
+		CL_ClearRewinds();
+		return NULL;
+	}
+
+	rewindimagelen = 0;
+	while (i--)
+	{
+		CL_DecodeRewind(chain[i], rewindimage, rewindimagelen);
+		rewindimagelen = chain[i]->rawlen;
+	}
 
-	P_SaveBufferFromExisting(&save, rewindhead->savebuffer, NETSAVEGAMESIZE);
+	P_SaveBufferFromExisting(&save, rewindimage, NETSAVEGAMESIZE);
 	P_LoadNetGame(&save, false);
 
 	wipegamestate = gamestate; // No fading back in!
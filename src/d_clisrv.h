@@ -34,7 +34,7 @@ The 'packet version' is used to distinguish packet formats.
 This version is independent of VERSION and SUBVERSION. Different
 applications may follow different packet versions.
 */
-#define PACKETVERSION 0
+#define PACKETVERSION 1
 
 // Network play related stuff.
 // There is a data struct that stores network
@@ -150,6 +150,7 @@ void Command_Drop(void);
 void Command_Droprate(void);
 #endif
 void Command_Numnodes(void);
+void Command_NetBench(void);
 
 #if defined(_MSC_VER)
 #pragma pack(1)
@@ -443,6 +444,7 @@ struct doomdata_t
 		plrinfo playerinfo[MSCOMPAT_MAXPLAYERS];//         576 bytes(?)
 		plrconfig playerconfig[MAXPLAYERS]; // (up to) 528 bytes(?)
 		INT32 filesneedednum;               //           4 bytes
+		UINT32 gamestatebase;               //           4 bytes
 		filesneededconfig_pak filesneededcfg; //       ??? bytes
 		netinfo_pak netinfo;					// Don't believe their lies
 		clientkey_pak clientkey;				// 32 bytes
@@ -680,7 +682,13 @@ extern boolean hu_stopped;
 //
 
 struct rewind_t {
-	UINT8 savebuffer[NETSAVEGAMESIZE];
+	UINT8 *data; // LZF compressed, unless it wouldn't get any smaller
+	size_t datalen;
+	size_t rawlen;
+	boolean compressed;
+	boolean keyframe; // Otherwise XOR'd against the point before it
+	UINT8 sincekeyframe;
+
 	tic_t leveltime;
 	size_t demopos;
 
@@ -690,6 +698,8 @@ struct rewind_t {
 	rewind_t *next;
 };
 
+extern consvar_t cv_rewindmemory;
+
 void CL_ClearRewinds(void);
 rewind_t *CL_SaveRewindPoint(size_t demopos);
 rewind_t *CL_RewindToTime(tic_t time);
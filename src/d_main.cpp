@@ -73,6 +73,7 @@
 #include "g_input.h" // tutorial mode control scheming
 #include "m_perfstats.h"
 #include "core/memory.h"
+#include "core/trace.h"
 
 #include "monocypher/monocypher.h"
 #include "stun.h"
@@ -364,6 +365,7 @@ static bool D_Display(bool world)
 	UINT8 i;
 
 	ZoneScoped;
+	TraceScoped("Display");
 
 	if (!dedicated)
 	{
@@ -823,7 +825,9 @@ static bool D_Display(bool world)
 		}
 
 		ps_swaptime = I_GetPreciseTime();
+		Trace_Begin("Swap");
 		I_FinishUpdate(); // page flip or blit buffer
+		Trace_End();
 		ps_swaptime = I_GetPreciseTime() - ps_swaptime;
 	}
 
@@ -858,6 +862,8 @@ void D_SRB2Loop(void)
 
 	// Pushing of + parameters is now done back in D_SRB2Main, not here.
 
+	Trace_SetThreadName("Main");
+
 	I_UpdateTime();
 	oldentertics = I_GetTime();
 
@@ -951,6 +957,7 @@ void D_SRB2Loop(void)
 			// process tics (but maybe not if realtic == 0)
 			{
 				ZoneScopedN("TryRunTics");
+				TraceScoped("TryRunTics");
 				TryRunTics(realtics);
 			}
 
@@ -1065,12 +1072,14 @@ void D_SRB2Loop(void)
 			I_CaptureVideoFrame();
 
 		// consoleplayer -> displayplayers (hear sounds from viewpoint)
+		Trace_Begin("Sound");
 		S_UpdateSounds(); // move positional sounds
 		if (realtics > 0 || singletics)
 		{
 			S_UpdateClosedCaptions();
 			S_TickSoundTest();
 		}
+		Trace_End();
 
 		LUA_Step();
 
@@ -62,8 +62,12 @@
 #include "doomstat.h"
 #include "deh_tables.h"
 #include "m_perfstats.h"
+#include "m_profile.h"
+#include "core/thread_pool_commands.h"
+#include "core/trace_commands.h"
 #include "k_specialstage.h"
 #include "k_race.h"
+#include "k_waypoint.h" // K_BenchmarkPathfinding
 #include "g_party.h"
 #include "k_vote.h"
 #include "k_zvote.h"
@@ -135,6 +139,8 @@ static void Command_LeaveParty_f(void);
 
 static void Command_Addfile(void);
 static void Command_ListWADS_f(void);
+static void Command_LumpStats_f(void);
+static void Command_PathfindBench_f(void);
 static void Command_ListDoomednums_f(void);
 static void Command_cxdiag_f(void);
 static void Command_ListUnusedSprites_f(void);
@@ -241,6 +247,7 @@ CV_PossibleValue_t perfstats_cons_t[] = {
 	{PS_LOGIC, "Logic"},
 	{PS_BOT, "Bots"},
 	{PS_THINKFRAME, "ThinkFrame"},
+	{PS_PROFILE, "Profile"},
 	{0, NULL}
 };
 
@@ -405,6 +412,8 @@ void D_RegisterServerCommands(void)
 
 	COM_AddCommand("addfile", Command_Addfile);
 	COM_AddDebugCommand("listwad", Command_ListWADS_f);
+	COM_AddDebugCommand("lumpstats", Command_LumpStats_f);
+	COM_AddDebugCommand("pathfindbench", Command_PathfindBench_f);
 	COM_AddDebugCommand("listmapthings", Command_ListDoomednums_f);
 	COM_AddDebugCommand("cxdiag", Command_cxdiag_f);
 	COM_AddCommand("listunusedsprites", Command_ListUnusedSprites_f);
@@ -517,8 +526,15 @@ void D_RegisterClientCommands(void)
 	COM_AddCommand("timedemo", Command_Timedemo_f);
 	COM_AddCommand("stopdemo", Command_Stopdemo_f);
 	COM_AddCommand("playintro", Command_Playintro_f);
+	COM_AddCommand("profilelog", Command_ProfileLog_f);
+	COM_AddCommand("tracedump", Command_TraceDump_f);
 
 	COM_AddDebugCommand("resetcamera", Command_ResetCamera_f);
+	COM_AddDebugCommand("threadpoolstats", Command_ThreadPoolStats_f);
+	COM_AddDebugCommand("threadpoolbench", Command_ThreadPoolBench_f);
+	COM_AddDebugCommand("hookbench", Command_HookBench_f);
+	COM_AddDebugCommand("textmapbench", Command_TextmapBench_f);
+	COM_AddDebugCommand("blockmapbench", Command_BlockMapBench_f);
 
 	COM_AddDebugCommand("view", Command_View_f);
 	COM_AddCommand("view2", Command_View_f);
@@ -4529,11 +4545,8 @@ static void Command_Addfile(void)
 
 			if ((fhandle = W_OpenWadFile(&fn, true)) != NULL)
 			{
-				tic_t t = I_GetTime();
-				CONS_Debug(DBG_SETUP, "Making MD5 for %s\n",fn);
-				md5_stream(fhandle, md5sum);
-				CONS_Debug(DBG_SETUP, "MD5 calc for %s took %f second\n", fn, (float)(I_GetTime() - t)/TICRATE);
 				fclose(fhandle);
+				W_MakeFileMD5(fn, md5sum);
 			}
 			else // file not found
 				continue;
@@ -4694,6 +4707,22 @@ static void Command_ListWADS_f(void)
 	}
 }
 
+static void Command_LumpStats_f(void)
+{
+	W_PrintLumpIndexStats();
+}
+
+static void Command_PathfindBench_f(void)
+{
+	if (gamestate != GS_LEVEL)
+	{
+		CONS_Printf(M_GetText("You must be in a level to use this.\n"));
+		return;
+	}
+
+	K_BenchmarkPathfinding();
+}
+
 #define MAXDOOMEDNUM 4095
 
 static void Command_ListDoomednums_f(void)
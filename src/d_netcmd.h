@@ -133,6 +133,7 @@ extern consvar_t cv_skipmapcheck;
 extern consvar_t cv_sleep;
 
 extern consvar_t cv_perfstats;
+extern consvar_t cv_trace;
 
 extern consvar_t cv_schedule;
 
@@ -10,6 +10,8 @@
 
 #include "pass_manager.hpp"
 
+#include "../core/trace.h"
+
 using namespace srb2;
 using namespace srb2::hwr2;
 using namespace srb2::rhi;
@@ -89,7 +91,7 @@ void PassManager::insert(const std::string& name, std::shared_ptr<Pass> pass)
 	SRB2_ASSERT(pass_by_name_.find(name) == pass_by_name_.end());
 
 	std::size_t index = passes_.size();
-	passes_.push_back(PassManagerEntry {name, pass, true});
+	passes_.push_back(PassManagerEntry {name, pass, true, Trace_InternName(name.c_str())});
 	pass_by_name_.insert({name, index});
 }
 
@@ -133,6 +135,7 @@ void PassManager::prepass(Rhi& rhi)
 	{
 		if (pass.enabled)
 		{
+			TraceScoped(pass.trace_name);
 			pass.pass->prepass(rhi);
 		}
 	}
@@ -144,6 +147,7 @@ void PassManager::transfer(Rhi& rhi, Handle<GraphicsContext> ctx)
 	{
 		if (pass.enabled)
 		{
+			TraceScoped(pass.trace_name);
 			pass.pass->transfer(rhi, ctx);
 		}
 	}
@@ -155,6 +159,7 @@ void PassManager::graphics(Rhi& rhi, Handle<GraphicsContext> ctx)
 	{
 		if (pass.enabled)
 		{
+			TraceScoped(pass.trace_name);
 			pass.pass->graphics(rhi, ctx);
 		}
 	}
@@ -166,6 +171,7 @@ void PassManager::postpass(Rhi& rhi)
 	{
 		if (pass.enabled)
 		{
+			TraceScoped(pass.trace_name);
 			pass.pass->postpass(rhi);
 		}
 	}
@@ -178,12 +184,20 @@ void PassManager::render(Rhi& rhi)
 		return;
 	}
 
+	Trace_Begin("Prepass");
 	prepass(rhi);
+	Trace_End();
 
 	Handle<GraphicsContext> gc = rhi.begin_graphics();
+	Trace_Begin("Transfer");
 	transfer(rhi, gc);
+	Trace_End();
+	Trace_Begin("Graphics");
 	graphics(rhi, gc);
+	Trace_End();
 	rhi.end_graphics(gc);
 
+	Trace_Begin("Postpass");
 	postpass(rhi);
+	Trace_End();
 }
@@ -31,6 +31,7 @@ class PassManager final : public Pass
 		std::string name;
 		std::shared_ptr<Pass> pass;
 		bool enabled;
+		const char* trace_name;
 	};
 
 	std::unordered_map<std::string, std::size_t> pass_by_name_;
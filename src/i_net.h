@@ -110,6 +110,10 @@ extern void (*I_NetSend)(void);
 */
 extern boolean (*I_NetCanSend)(void);
 
+/**	\brief send any packets the driver is holding back to batch together
+*/
+extern void (*I_NetFlush)(void);
+
 /**	\brief	close a connection
 
 	\param	nodenum	node to be closed
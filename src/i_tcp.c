@@ -13,6 +13,10 @@
 ///        This is not really OS-dependent because all OSes have the same socket API.
 ///        Just use ifdef for OS-dependent parts.
 
+#if defined (__linux__) && !defined (_GNU_SOURCE)
+#define _GNU_SOURCE // recvmmsg and sendmmsg
+#endif
+
 #include "i_tcp_detail.h"
 #include "i_system.h"
 #include "i_time.h"
@@ -22,6 +26,8 @@
 #include "m_argv.h"
 #include "stun.h"
 #include "z_zone.h"
+#include "command.h"
+#include "core/trace.h"
 
 #include "doomstat.h"
 
@@ -36,6 +42,10 @@
 
 #define SELECTTEST
 
+#if defined (__linux__) && !defined (USE_WINSOCK)
+#define USE_MMSG
+#endif
+
 #define DEFAULTPORT "5029"
 
 #ifdef USE_WINSOCK
@@ -420,15 +430,169 @@ static boolean hole_punch(ssize_t c)
 	}
 }
 
+// Works out which node the datagram now in doomcom came from.
+// Returns 1 for a new node, 0 for a known one, -1 if it wasn't a
+// game packet and -2 if it was meant for nobody (no free node).
+static int SOCK_ReceivedFrom(size_t n, ssize_t c, mysockaddr_t *fromaddress, socklen_t fromlen)
+{
+	int j;
+
+#ifdef USE_STUN
+	if (STUN_got_response(doomcom->data, c))
+	{
+		return -1;
+	}
+#endif
+
+	if (hole_punch(c))
+	{
+		return -1;
+	}
+
+	// find remote node number
+	for (j = 1; j <= MAXNETNODES; j++) //include LAN
+	{
+		if (SOCK_cmpaddr(fromaddress, &clientaddress[j], 0))
+		{
+			doomcom->remotenode = (INT16)j; // good packet from a game player
+			doomcom->datalength = (INT16)c;
+			nodesocket[j] = mysockets[n];
+			return 0;
+		}
+	}
+	// not found
+
+	// find a free slot
+	j = getfreenode();
+	if (j > 0)
+	{
+		M_Memcpy(&clientaddress[j], fromaddress, fromlen);
+		nodesocket[j] = mysockets[n];
+		DEBFILE(va("New node detected: node:%d address:%s\n", j,
+				SOCK_GetNodeAddress(j)));
+		doomcom->remotenode = (INT16)j; // good packet from a game player
+		doomcom->datalength = (INT16)c;
+
+		return 1;
+	}
+	else
+		DEBFILE("New node detected: No more free slots\n");
+
+	return -2;
+}
+
+#ifdef USE_MMSG
+// Instead of a syscall per datagram, everything waiting on the sockets is
+// drained with recvmmsg into a ring and handed out one packet per SOCK_Get.
+// Sends to nodes we know the socket of are queued up and go out together
+// through sendmmsg, in the order they were made.
+#define NETBATCH 64
+
+typedef struct
+{
+	mysockaddr_t address;
+	socklen_t addrlen;
+	SOCKET_TYPE socket;
+	size_t socketnum;
+	INT16 node;
+	INT16 length;
+	char data[MAXPACKETLENGTH];
+} netpacket_t;
+
+static boolean netbatching = false;
+
+static netpacket_t recvring[NETBATCH];
+static size_t recvhead = 0, recvcount = 0;
+
+static netpacket_t sendqueue[NETBATCH];
+static size_t sendcount = 0;
+
+static void SOCK_Flush(void);
+
+static boolean SOCK_FillRecvRing(void)
+{
+	struct mmsghdr msgs[NETBATCH];
+	struct iovec iov[NETBATCH];
+	size_t n;
+	int i, got;
+
+	recvhead = recvcount = 0;
+
+	for (n = 0; n < mysocketses && recvcount < NETBATCH; n++)
+	{
+		const int room = (int)(NETBATCH - recvcount);
+
+		memset(msgs, 0, sizeof (msgs[0]) * room);
+		for (i = 0; i < room; i++)
+		{
+			netpacket_t *packet = &recvring[recvcount + i];
+			iov[i].iov_base = packet->data;
+			iov[i].iov_len = MAXPACKETLENGTH;
+			msgs[i].msg_hdr.msg_name = &packet->address;
+			msgs[i].msg_hdr.msg_namelen = (socklen_t)sizeof (packet->address);
+			msgs[i].msg_hdr.msg_iov = &iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		got = recvmmsg(mysockets[n], msgs, room, MSG_DONTWAIT, NULL);
+		if (got <= 0)
+			continue;
+
+		for (i = 0; i < got; i++)
+		{
+			netpacket_t *packet = &recvring[recvcount + i];
+			packet->length = (INT16)msgs[i].msg_len;
+			packet->addrlen = msgs[i].msg_hdr.msg_namelen;
+			packet->socketnum = n;
+		}
+		recvcount += got;
+	}
+
+	return recvcount > 0;
+}
+
+static boolean SOCK_GetBatched(void)
+{
+	// Anything we were holding back goes out before we look at replies
+	SOCK_Flush();
+
+	while (recvcount > 0 || SOCK_FillRecvRing())
+	{
+		netpacket_t *packet = &recvring[recvhead];
+		int from;
+
+		recvhead++;
+		recvcount--;
+
+		if (packet->length <= 0)
+			continue;
+
+		M_Memcpy(doomcom->data, packet->data, packet->length);
+
+		from = SOCK_ReceivedFrom(packet->socketnum, packet->length, &packet->address, packet->addrlen);
+		if (from >= 0)
+			return (from == 1);
+	}
+
+	doomcom->remotenode = -1; // no packet
+	return false;
+}
+#endif
+
 // Returns true if a packet was received from a new node, false in all other cases
 static boolean SOCK_Get(void)
 {
 	size_t n;
-	int j;
+	int from;
 	ssize_t c;
 	mysockaddr_t fromaddress;
 	socklen_t fromlen;
 
+#ifdef USE_MMSG
+	if (netbatching)
+		return SOCK_GetBatched();
+#endif
+
 	for (n = 0; n < mysocketses; n++)
 	{
 		fromlen = (socklen_t)sizeof(fromaddress);
@@ -436,51 +600,138 @@ static boolean SOCK_Get(void)
 			(void *)&fromaddress, &fromlen);
 		if (c > 0)
 		{
-#ifdef USE_STUN
-			if (STUN_got_response(doomcom->data, c))
-			{
+			from = SOCK_ReceivedFrom(n, c, &fromaddress, fromlen);
+			if (from == -1)
 				break;
-			}
-#endif
+			if (from >= 0)
+				return (from == 1);
+		}
+	}
 
-			if (hole_punch(c))
-			{
-				break;
-			}
+	doomcom->remotenode = -1; // no packet
+	return false;
+}
+
+#ifdef USE_MMSG
+static SOCKET_TYPE SOCK_BenchSocket(mysockaddr_t *addr)
+{
+	socklen_t len = (socklen_t)sizeof(addr->ip4);
+	SOCKET_TYPE s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+	if (s == (SOCKET_TYPE)ERRSOCKET)
+		return (SOCKET_TYPE)ERRSOCKET;
+
+	memset(addr, 0, sizeof (*addr));
+	addr->ip4.sin_family = AF_INET;
+	addr->ip4.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr->ip4.sin_port = 0; // any port
 
-			// find remote node number
-			for (j = 1; j <= MAXNETNODES; j++) //include LAN
+	if (bind(s, &addr->any, len) == -1 || getsockname(s, &addr->any, &len) == -1)
+	{
+		close(s);
+		return (SOCKET_TYPE)ERRSOCKET;
+	}
+
+	return s;
+}
+
+static void SOCK_RunNetBench(SOCKET_TYPE from, SOCKET_TYPE to, mysockaddr_t *toaddr, size_t count, boolean batched)
+{
+	static char packets[NETBATCH][INETPACKETLENGTH];
+	struct mmsghdr sendmsgs[NETBATCH], recvmsgs[NETBATCH];
+	struct iovec iov[NETBATCH];
+	size_t sent = 0, received = 0, batch, i;
+	precise_t start = I_GetPreciseTime();
+	clock_t cpustart = clock();
+	double seconds, cpums;
+	int got;
+
+	memset(sendmsgs, 0, sizeof (sendmsgs));
+	for (i = 0; i < NETBATCH; i++)
+	{
+		iov[i].iov_base = packets[i];
+		iov[i].iov_len = INETPACKETLENGTH;
+		sendmsgs[i].msg_hdr.msg_name = &toaddr->any;
+		sendmsgs[i].msg_hdr.msg_namelen = (socklen_t)sizeof(toaddr->ip4);
+		sendmsgs[i].msg_hdr.msg_iov = &iov[i];
+		sendmsgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while (sent < count)
+	{
+		batch = min(count - sent, NETBATCH);
+		sent += batch;
+
+		if (batched)
+		{
+			sendmmsg(from, sendmsgs, (unsigned int)batch, 0);
+
+			do
 			{
-				if (SOCK_cmpaddr(&fromaddress, &clientaddress[j], 0))
+				memset(recvmsgs, 0, sizeof (recvmsgs));
+				for (i = 0; i < NETBATCH; i++)
 				{
-					doomcom->remotenode = (INT16)j; // good packet from a game player
-					doomcom->datalength = (INT16)c;
-					nodesocket[j] = mysockets[n];
-					return false;
+					recvmsgs[i].msg_hdr.msg_iov = &iov[i];
+					recvmsgs[i].msg_hdr.msg_iovlen = 1;
 				}
-			}
-			// not found
 
-			// find a free slot
-			j = getfreenode();
-			if (j > 0)
-			{
-				M_Memcpy(&clientaddress[j], &fromaddress, fromlen);
-				nodesocket[j] = mysockets[n];
-				DEBFILE(va("New node detected: node:%d address:%s\n", j,
-						SOCK_GetNodeAddress(j)));
-				doomcom->remotenode = (INT16)j; // good packet from a game player
-				doomcom->datalength = (INT16)c;
-
-				return true;
-			}
-			else
-				DEBFILE("New node detected: No more free slots\n");
+				got = recvmmsg(to, recvmsgs, NETBATCH, MSG_DONTWAIT, NULL);
+				if (got > 0)
+					received += got;
+			} while (got == NETBATCH);
+		}
+		else
+		{
+			for (i = 0; i < batch; i++)
+				sendto(from, packets[i], INETPACKETLENGTH, 0, &toaddr->any, (socklen_t)sizeof(toaddr->ip4));
+
+			while (recvfrom(to, packets[0], INETPACKETLENGTH, MSG_DONTWAIT, NULL, NULL) > 0)
+				received++;
 		}
 	}
 
-	doomcom->remotenode = -1; // no packet
-	return false;
+	seconds = (double)(I_GetPreciseTime() - start) / I_GetPrecisePrecision();
+	cpums = (double)(clock() - cpustart) * 1000.0 / CLOCKS_PER_SEC;
+
+	CONS_Printf("%-17s %s of %s packets arrived in %.3f sec, %.0f packets/sec, %.1f ms CPU\n",
+		batched ? "sendmmsg/recvmmsg" : "sendto/recvfrom",
+		sizeu1(received), sizeu2(sent), seconds,
+		seconds > 0.0 ? received / seconds : 0.0, cpums);
+}
+#endif
+
+// Sends packets between two loopback sockets, first one syscall
+// per packet and then batched, to compare the two network paths
+void Command_NetBench(void)
+{
+#ifdef USE_MMSG
+	SOCKET_TYPE from, to;
+	mysockaddr_t fromaddr, toaddr;
+	size_t count = 100000;
+
+	if (COM_Argc() > 1)
+		count = max(atoi(COM_Argv(1)), 1);
+
+	from = SOCK_BenchSocket(&fromaddr);
+	to = SOCK_BenchSocket(&toaddr);
+
+	if (from == (SOCKET_TYPE)ERRSOCKET || to == (SOCKET_TYPE)ERRSOCKET)
+	{
+		CONS_Alert(CONS_ERROR, "netbench: couldn't open loopback sockets\n");
+	}
+	else
+	{
+		SOCK_RunNetBench(from, to, &toaddr, count, false);
+		SOCK_RunNetBench(from, to, &toaddr, count, true);
+	}
+
+	if (from != (SOCKET_TYPE)ERRSOCKET)
+		close(from);
+	if (to != (SOCKET_TYPE)ERRSOCKET)
+		close(to);
+#else
+	CONS_Printf("Batched networking is only available on Linux.\n");
+#endif
 }
 
 // check if we can send (do not go over the buffer)
@@ -525,6 +776,11 @@ static boolean SOCK_CanGet(void)
 	fd_set tset;
 	int rselect;
 
+#ifdef USE_MMSG
+	if (recvcount > 0)
+		return true;
+#endif
+
 	if(!FD_CPY(&masterset, &tset, mysockets, mysocketses))
 		return false;
 	rselect = select(255, &tset, NULL, NULL, &timeval_for_select);
@@ -534,26 +790,91 @@ static boolean SOCK_CanGet(void)
 }
 #endif
 
-static inline ssize_t SOCK_SendToAddr(SOCKET_TYPE socket, mysockaddr_t *sockaddr)
+static inline socklen_t SOCK_AddrLen(mysockaddr_t *sockaddr)
 {
-	socklen_t d4 = (socklen_t)sizeof(struct sockaddr_in);
-#ifdef HAVE_IPV6
-	socklen_t d6 = (socklen_t)sizeof(struct sockaddr_in6);
-#endif
-	socklen_t d, da = (socklen_t)sizeof(mysockaddr_t);
-
 	switch (sockaddr->any.sa_family)
 	{
-		case AF_INET:  d = d4; break;
+		case AF_INET:  return (socklen_t)sizeof(struct sockaddr_in);
 #ifdef HAVE_IPV6
-		case AF_INET6: d = d6; break;
+		case AF_INET6: return (socklen_t)sizeof(struct sockaddr_in6);
 #endif
-		default:       d = da; break;
+		default:       return (socklen_t)sizeof(mysockaddr_t);
+	}
+}
+
+static inline ssize_t SOCK_SendToAddr(SOCKET_TYPE socket, mysockaddr_t *sockaddr)
+{
+	return sendto(socket, (char *)&doomcom->data, doomcom->datalength, 0, &sockaddr->any, SOCK_AddrLen(sockaddr));
+}
+
+static void SOCK_SendError(INT32 node, int e)
+{
+	if (e != ECONNREFUSED && e != EWOULDBLOCK)
+		I_Error("SOCK_Send, error sending to node %d (%s) #%u: %s", node,
+			SOCK_GetNodeAddress(node), e, strerror(e));
+}
+
+#ifdef USE_MMSG
+static void SOCK_Flush(void)
+{
+	struct mmsghdr msgs[NETBATCH];
+	struct iovec iov[NETBATCH];
+	size_t i, run;
+	int sent;
+
+	if (sendcount == 0)
+		return;
+
+	Trace_Begin("Net Flush");
+
+	memset(msgs, 0, sizeof (msgs[0]) * sendcount);
+	for (i = 0; i < sendcount; i++)
+	{
+		iov[i].iov_base = sendqueue[i].data;
+		iov[i].iov_len = sendqueue[i].length;
+		msgs[i].msg_hdr.msg_name = &sendqueue[i].address.any;
+		msgs[i].msg_hdr.msg_namelen = sendqueue[i].addrlen;
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	for (i = 0; i < sendcount; i += sent)
+	{
+		// sendmmsg works on one socket, so send each run going out the same one
+		for (run = 1; i + run < sendcount && sendqueue[i + run].socket == sendqueue[i].socket; run++)
+			;
+
+		sent = sendmmsg(sendqueue[i].socket, &msgs[i], (unsigned int)run, 0);
+		if (sent <= 0)
+		{
+			// Skip the packet that failed, like a failed sendto would
+			SOCK_SendError(sendqueue[i].node, errno);
+			sent = 1;
+		}
 	}
 
-	return sendto(socket, (char *)&doomcom->data, doomcom->datalength, 0, &sockaddr->any, d);
+	sendcount = 0;
+
+	Trace_End();
 }
 
+static void SOCK_QueueSend(SOCKET_TYPE socket, INT32 node)
+{
+	netpacket_t *packet;
+
+	if (sendcount == NETBATCH)
+		SOCK_Flush();
+
+	packet = &sendqueue[sendcount++];
+	M_Memcpy(&packet->address, &clientaddress[node], sizeof (packet->address));
+	packet->addrlen = SOCK_AddrLen(&packet->address);
+	packet->socket = socket;
+	packet->node = (INT16)node;
+	packet->length = doomcom->datalength;
+	M_Memcpy(packet->data, doomcom->data, doomcom->datalength);
+}
+#endif
+
 static void SOCK_Send(void)
 {
 	ssize_t c = ERRSOCKET;
@@ -562,6 +883,21 @@ static void SOCK_Send(void)
 	if (!nodeconnected[doomcom->remotenode])
 		return;
 
+#ifdef USE_MMSG
+	if (netbatching)
+	{
+		if (doomcom->remotenode != BROADCASTADDR
+			&& nodesocket[doomcom->remotenode] != (SOCKET_TYPE)ERRSOCKET)
+		{
+			SOCK_QueueSend(nodesocket[doomcom->remotenode], doomcom->remotenode);
+			return;
+		}
+
+		// Keep the queued packets ahead of this one
+		SOCK_Flush();
+	}
+#endif
+
 	if (doomcom->remotenode == BROADCASTADDR)
 	{
 		for (i = 0; i < mysocketses; i++)
@@ -589,12 +925,7 @@ static void SOCK_Send(void)
 	}
 
 	if (c == ERRSOCKET)
-	{
-		int e = errno; // save error code so it can't be modified later
-		if (e != ECONNREFUSED && e != EWOULDBLOCK)
-			I_Error("SOCK_Send, error sending to node %d (%s) #%u: %s", doomcom->remotenode,
-				SOCK_GetNodeAddress(doomcom->remotenode), e, strerror(e));
-	}
+		SOCK_SendError(doomcom->remotenode, errno);
 }
 
 static void SOCK_FreeNodenum(INT32 numnode)
@@ -1009,6 +1340,12 @@ boolean I_InitTcpDriver(void)
 static void SOCK_CloseSocket(void)
 {
 	size_t i;
+
+#ifdef USE_MMSG
+	SOCK_Flush();
+	recvhead = recvcount = 0;
+#endif
+
 	for (i=0; i < MAXNETNODES+1; i++)
 	{
 		if (mysockets[i] != (SOCKET_TYPE)ERRSOCKET
@@ -1169,6 +1506,13 @@ static boolean SOCK_OpenSocket(void)
 	I_NetCanGet = SOCK_CanGet;
 #endif
 
+#ifdef USE_MMSG
+	// -nonetbatch goes back to a syscall per packet, for comparison
+	netbatching = !M_CheckParm("-nonetbatch");
+	if (netbatching)
+		I_NetFlush = SOCK_Flush;
+#endif
+
 	I_NetRequestHolePunch = SOCK_RequestHolePunch;
 	I_NetRegisterHolePunch = SOCK_RegisterHolePunch;
 
@@ -45,6 +45,7 @@
 #include "discord.h" // DRPC_UpdatePresence
 #endif
 #include "i_net.h" // doomcom
+#include "core/thread_pool.h"
 
 extern "C" consvar_t cv_forcebots;
 
@@ -1687,21 +1688,47 @@ static void K_BuildBotPodiumTiccmd(const player_t *player, ticcmd_t *cmd)
 }
 
 /*--------------------------------------------------
-	static void K_BuildBotTiccmdNormal(const player_t *player, ticcmd_t *cmd)
-
-		Build ticcmd for bots with a style of BOT_STYLE_NORMAL
+	struct botticcmd_t
+
+		A bot ticcmd in the middle of being built. The parts of bot
+		thinking that allocate memory, pathfind, or could call into
+		Lua are done on the main thread first (K_StartBotTiccmd);
+		everything after that only reads the game state and writes
+		to this bot's own ticcmd and prediction, so it's allowed to
+		run on the thread pool (K_FinishBotTiccmd).
 --------------------------------------------------*/
-static void K_BuildBotTiccmdNormal(const player_t *player, ticcmd_t *cmd)
+struct botticcmd_t
 {
-	precise_t t = 0;
+	player_t *player;
+	ticcmd_t *cmd;
 
-	botprediction_t *predict = nullptr;
-	auto predict_finally = srb2::finally([&predict]() { Z_Free(predict); });
+	boolean pending; // Still needs K_FinishBotTiccmd
+	const botcontroller_t *botController;
+	botprediction_t *predict;
+	boolean predictUnused; // Made ahead of time, but went for a bully instead
+	boolean forcedDir;
 
-	boolean trySpindash = true;
-	angle_t destangle = 0;
-	UINT8 spindash = 0;
-	INT32 turnamt = 0;
+	// Handle POSITION!!
+	boolean position;
+	fixed_t distToFinish;
+	fixed_t closeDist;
+	fixed_t farDist;
+
+	precise_t time;
+};
+
+/*--------------------------------------------------
+	static void K_StartBotTiccmdNormal(botticcmd_t *bot)
+
+		First half of building a ticcmd for bots with a style of
+		BOT_STYLE_NORMAL, which has to run on the main thread.
+		Makes the prediction ahead of time if the second half will
+		want one.
+--------------------------------------------------*/
+static void K_StartBotTiccmdNormal(botticcmd_t *bot)
+{
+	const player_t *player = bot->player;
+	ticcmd_t *cmd = bot->cmd;
 
 	if (!(gametyperules & GTR_BOTS) // No bot behaviors
 		|| K_GetNumWaypoints() == 0 // No waypoints
@@ -1748,21 +1775,18 @@ static void K_BuildBotTiccmdNormal(const player_t *player, ticcmd_t *cmd)
 		return;
 	}
 
-	destangle = player->mo->angle;
-
-	boolean forcedDir = false;
 	if (botController != nullptr && (botController->flags & TMBOT_FORCEDIR) == TMBOT_FORCEDIR)
 	{
 		const fixed_t dist = DEFAULT_WAYPOINT_RADIUS * player->mo->scale;
 
 		// Overwritten prediction
-		predict = static_cast<botprediction_t *>(Z_Calloc(sizeof(botprediction_t), PU_STATIC, nullptr));
+		bot->predict = static_cast<botprediction_t *>(Z_Calloc(sizeof(botprediction_t), PU_STATIC, nullptr));
 
-		predict->x = player->mo->x + FixedMul(dist, FINECOSINE(botController->forceAngle >> ANGLETOFINESHIFT));
-		predict->y = player->mo->y + FixedMul(dist, FINESINE(botController->forceAngle >> ANGLETOFINESHIFT));
-		predict->radius = (DEFAULT_WAYPOINT_RADIUS / 4) * mapobjectscale;
+		bot->predict->x = player->mo->x + FixedMul(dist, FINECOSINE(botController->forceAngle >> ANGLETOFINESHIFT));
+		bot->predict->y = player->mo->y + FixedMul(dist, FINESINE(botController->forceAngle >> ANGLETOFINESHIFT));
+		bot->predict->radius = (DEFAULT_WAYPOINT_RADIUS / 4) * mapobjectscale;
 
-		forcedDir = true;
+		bot->forcedDir = true;
 	}
 
 	if (P_IsObjectOnGround(player->mo) == false)
@@ -1780,38 +1804,84 @@ static void K_BuildBotTiccmdNormal(const player_t *player, ticcmd_t *cmd)
 		//return; // Don't allow bots to turn in the air.
 	}
 
-	if (forcedDir == true)
+	bot->botController = botController;
+	bot->pending = true;
+
+	if (bot->forcedDir == true)
 	{
-		destangle = R_PointToAngle2(player->mo->x, player->mo->y, predict->x, predict->y);
-		turnamt = K_HandleBotTrack(player, cmd, predict, destangle);
-		trySpindash = false;
+		return;
 	}
-	else if (leveltime <= starttime && finishBeamLine != nullptr)
+
+	if (leveltime <= starttime && finishBeamLine != nullptr)
 	{
 		// Handle POSITION!!
 		const fixed_t distBase = 480*mapobjectscale;
 		const fixed_t distAdjust = 128*mapobjectscale;
 
-		const fixed_t closeDist = distBase + (distAdjust * (9 - player->kartweight));
-		const fixed_t farDist = closeDist + (distAdjust * 2);
-
 		const tic_t futureSight = (TICRATE >> 1);
 
-		fixed_t distToFinish = K_DistanceOfLineFromPoint(
+		bot->position = true;
+
+		bot->closeDist = distBase + (distAdjust * (9 - player->kartweight));
+		bot->farDist = bot->closeDist + (distAdjust * 2);
+
+		bot->distToFinish = K_DistanceOfLineFromPoint(
 			finishBeamLine->v1->x, finishBeamLine->v1->y,
 			finishBeamLine->v2->x, finishBeamLine->v2->y,
 			player->mo->x, player->mo->y
 		) - (K_BotSpeedScaled(player, player->speed) * futureSight);
 
+		if (bot->distToFinish < bot->closeDist)
+		{
+			// Backing up doesn't use a prediction.
+			return;
+		}
+
+		// In the middle distance, this goes unused if someone can be bullied.
+	}
+
+	// Create a prediction.
+	bot->predict = K_CreateBotPrediction(player);
+}
+
+/*--------------------------------------------------
+	static void K_FinishBotTiccmdNormal(botticcmd_t *bot)
+
+		Second half of building a ticcmd for bots with a style of
+		BOT_STYLE_NORMAL. Safe to run on the thread pool.
+--------------------------------------------------*/
+static void K_FinishBotTiccmdNormal(botticcmd_t *bot)
+{
+	const player_t *player = bot->player;
+	ticcmd_t *cmd = bot->cmd;
+	botprediction_t *predict = bot->predict;
+
+	precise_t t = 0;
+
+	boolean trySpindash = true;
+	angle_t destangle = 0;
+	UINT8 spindash = 0;
+	INT32 turnamt = 0;
+
+	destangle = player->mo->angle;
+
+	if (bot->forcedDir == true)
+	{
+		destangle = R_PointToAngle2(player->mo->x, player->mo->y, predict->x, predict->y);
+		turnamt = K_HandleBotTrack(player, cmd, predict, destangle);
+		trySpindash = false;
+	}
+	else if (bot->position == true)
+	{
 		// Don't run the spindash code at all until we're in the right place
 		trySpindash = false;
 
-		if (distToFinish < closeDist)
+		if (bot->distToFinish < bot->closeDist)
 		{
 			// We're too close, we need to start backing up.
 			turnamt = K_HandleBotReverse(player, cmd, predict, destangle);
 		}
-		else if (distToFinish < farDist)
+		else if (bot->distToFinish < bot->farDist)
 		{
 			INT32 bullyTurn = INT32_MAX;
 
@@ -1829,12 +1899,6 @@ static void K_BuildBotTiccmdNormal(const player_t *player, ticcmd_t *cmd)
 			if (bullyTurn == INT32_MAX)
 			{
 				// No one to bully, just go for a spindash as anyone.
-				if (predict == nullptr)
-				{
-					// Create a prediction.
-					predict = K_CreateBotPrediction(player);
-				}
-
 				if (predict != nullptr)
 				{
 					K_NudgePredictionTowardsObjects(predict, player);
@@ -1848,6 +1912,7 @@ static void K_BuildBotTiccmdNormal(const player_t *player, ticcmd_t *cmd)
 			else
 			{
 				turnamt = bullyTurn;
+				bot->predictUnused = true;
 
 				// If already spindashing, wait until we get a relatively OK charge first.
 				if (player->spindash == 0 || player->spindash > TICRATE)
@@ -1861,12 +1926,6 @@ static void K_BuildBotTiccmdNormal(const player_t *player, ticcmd_t *cmd)
 		else
 		{
 			// Too far away, we need to just drive up.
-			if (predict == nullptr)
-			{
-				// Create a prediction.
-				predict = K_CreateBotPrediction(player);
-			}
-
 			if (predict != nullptr)
 			{
 				K_NudgePredictionTowardsObjects(predict, player);
@@ -1878,12 +1937,6 @@ static void K_BuildBotTiccmdNormal(const player_t *player, ticcmd_t *cmd)
 	else
 	{
 		// Handle steering towards waypoints!
-		if (predict == nullptr)
-		{
-			// Create a prediction.
-			predict = K_CreateBotPrediction(player);
-		}
-
 		if (predict != nullptr)
 		{
 			K_NudgePredictionTowardsObjects(predict, player);
@@ -1964,27 +2017,18 @@ static void K_BuildBotTiccmdNormal(const player_t *player, ticcmd_t *cmd)
 			cmd->turning = turnamt;
 		}
 	}
-
-	// Free the prediction we made earlier
-	if (predict != nullptr)
-	{
-		if (cv_kartdebugbots.value != 0 && player - players == displayplayers[0] && !(paused || P_AutoPause()))
-		{
-			K_DrawPredictionDebug(predict, player);
-		}
-	}
 }
 
 /*--------------------------------------------------
-	void K_BuildBotTiccmd(player_t *player, ticcmd_t *cmd)
+	static void K_StartBotTiccmd(botticcmd_t *bot)
 
-		See header file for description.
+		Does everything for a bot's ticcmd that has to happen
+		on the main thread, in player order.
 --------------------------------------------------*/
-void K_BuildBotTiccmd(
-	player_t *player, // annoyingly NOT const because of LUA_HookTiccmd... grumble grumble
-	ticcmd_t *cmd)
+static void K_StartBotTiccmd(botticcmd_t *bot)
 {
-	ZoneScoped;
+	player_t *player = bot->player; // annoyingly NOT const because of LUA_HookTiccmd... grumble grumble
+	ticcmd_t *cmd = bot->cmd;
 
 	// Remove any existing controls
 	memset(cmd, 0, sizeof(ticcmd_t));
@@ -2024,12 +2068,164 @@ void K_BuildBotTiccmd(
 		}
 		default:
 		{
-			K_BuildBotTiccmdNormal(player, cmd);
+			K_StartBotTiccmdNormal(bot);
 			break;
 		}
 	}
 }
 
+/*--------------------------------------------------
+	static void K_FinishBotTiccmd(botticcmd_t *bot)
+
+		Does the rest of a bot's ticcmd. Only reads the game
+		state, so any number of these can run at once.
+--------------------------------------------------*/
+static void K_FinishBotTiccmd(botticcmd_t *bot)
+{
+	ZoneScoped;
+
+	if (bot->pending == true)
+	{
+		K_FinishBotTiccmdNormal(bot);
+	}
+}
+
+/*--------------------------------------------------
+	static void K_EndBotTiccmd(botticcmd_t *bot)
+
+		Cleans up after K_FinishBotTiccmd, on the main thread.
+--------------------------------------------------*/
+static void K_EndBotTiccmd(botticcmd_t *bot)
+{
+	const player_t *player = bot->player;
+
+	// Free the prediction we made earlier
+	if (bot->predict != nullptr)
+	{
+		if (bot->pending == true && bot->predictUnused == false && cv_kartdebugbots.value != 0 && player - players == displayplayers[0] && !(paused || P_AutoPause()))
+		{
+			K_DrawPredictionDebug(bot->predict, player);
+		}
+
+		Z_Free(bot->predict);
+		bot->predict = nullptr;
+	}
+}
+
+/*--------------------------------------------------
+	void K_BuildBotTiccmd(player_t *player, ticcmd_t *cmd)
+
+		See header file for description.
+--------------------------------------------------*/
+void K_BuildBotTiccmd(
+	player_t *player, // annoyingly NOT const because of LUA_HookTiccmd... grumble grumble
+	ticcmd_t *cmd)
+{
+	ZoneScoped;
+
+	botticcmd_t bot = {};
+
+	bot.player = player;
+	bot.cmd = cmd;
+
+	K_StartBotTiccmd(&bot);
+	K_FinishBotTiccmd(&bot);
+	K_EndBotTiccmd(&bot);
+}
+
+/*--------------------------------------------------
+	void K_BuildBotTiccmds(ticcmd_t *cmds)
+
+		See header file for description.
+--------------------------------------------------*/
+void K_BuildBotTiccmds(ticcmd_t *cmds)
+{
+	ZoneScoped;
+
+	botticcmd_t bots[MAXPLAYERS] = {};
+	UINT8 numbots = 0;
+	const precise_t start = I_GetPreciseTime();
+	UINT8 i;
+
+	// BotTiccmd hooks can change anything, so then every bot
+	// has to be built from start to finish before the next.
+	const boolean parallel = (cv_parallelbots.value && srb2::g_main_threadpool != nullptr
+		&& LUA_HookExists(HOOK(BotTiccmd)) == false);
+
+	for (i = 0; i < MAXPLAYERS; i++)
+	{
+		if (!playeringame[i] || !K_PlayerUsesBotMovement(&players[i]))
+		{
+			continue;
+		}
+
+		if (parallel == false)
+		{
+			const precise_t t = I_GetPreciseTime();
+
+			K_BuildBotTiccmd(&players[i], &cmds[i]);
+
+			ps_bots[i].isBot = true;
+			ps_bots[i].total = I_GetPreciseTime() - t;
+			continue;
+		}
+
+		botticcmd_t *bot = &bots[numbots++];
+		const precise_t t = I_GetPreciseTime();
+
+		bot->player = &players[i];
+		bot->cmd = &cmds[i];
+
+		K_StartBotTiccmd(bot);
+		bot->time = I_GetPreciseTime() - t;
+	}
+
+	if (numbots > 0)
+	{
+		srb2::g_main_threadpool->begin_sema();
+
+		for (i = 0; i < numbots; i++)
+		{
+			botticcmd_t *bot = &bots[i];
+
+			if (bot->pending == false)
+			{
+				continue;
+			}
+
+			srb2::g_main_threadpool->schedule([bot]()
+			{
+				const precise_t t = I_GetPreciseTime();
+
+				P_SetThreadSight(true);
+				K_FinishBotTiccmd(bot);
+				P_SetThreadSight(false);
+
+				bot->time += I_GetPreciseTime() - t;
+			});
+		}
+
+		srb2::ThreadPool::Sema sema = srb2::g_main_threadpool->end_sema();
+		srb2::g_main_threadpool->notify_sema(sema);
+		srb2::g_main_threadpool->wait_sema(sema);
+	}
+
+	for (i = 0; i < numbots; i++)
+	{
+		botticcmd_t *bot = &bots[i];
+		const precise_t t = I_GetPreciseTime();
+		const size_t num = bot->player - players;
+
+		K_EndBotTiccmd(bot);
+
+		ps_bots[num].isBot = true;
+		ps_bots[num].total = bot->time + (I_GetPreciseTime() - t);
+	}
+
+	// Wall time, so that running them side by side shows up here
+	ps_botticcmd_time += I_GetPreciseTime() - start;
+}
+
 /*--------------------------------------------------
 	void K_UpdateBotGameplayVars(player_t *player);
 
@@ -26,6 +26,8 @@ extern "C" {
 	extern consvar_t cv_botcontrol;
 #endif
 
+extern consvar_t cv_parallelbots;
+
 // Maximum value of botvars.difficulty
 #define MAXBOTDIFFICULTY (13)
 
@@ -328,6 +330,24 @@ INT32 K_PositionBully(const player_t *player);
 void K_BuildBotTiccmd(player_t *player, ticcmd_t *cmd);
 
 
+/*--------------------------------------------------
+	void K_BuildBotTiccmds(ticcmd_t *cmds);
+
+		Creates the ticcmds of every bot in the game, like
+		K_BuildBotTiccmd. With parallelbots on, the parts that
+		only look at the game state run on the thread pool;
+		the resulting ticcmds are the same either way.
+
+	Input Arguments:-
+		cmds - Array of MAXPLAYERS ticcmds to fill in.
+
+	Return:-
+		None
+--------------------------------------------------*/
+
+void K_BuildBotTiccmds(ticcmd_t *cmds);
+
+
 /*--------------------------------------------------
 	void K_UpdateBotGameplayVarsItemUsage(player_t *player)
 
@@ -46,7 +46,7 @@
 	Return:-
 		BlockItReturn_t enum, see its definition for more information.
 --------------------------------------------------*/
-static struct eggboxSearch_s
+static thread_local struct eggboxSearch_s
 {
 	fixed_t distancetocheck;
 	fixed_t eggboxx, eggboxy;
@@ -115,7 +115,7 @@ UINT8 K_EggboxStealth(fixed_t x, fixed_t y)
 	{
 		for (by = yl; by <= yh; by++)
 		{
-			P_BlockThingsIterator(bx, by, K_FindEggboxes);
+			P_BlockThingsSearch(bx, by, K_FindEggboxes);
 		}
 	}
 
@@ -262,7 +262,7 @@ boolean K_BotHatesThisSector(const player_t *player, sector_t *sec, fixed_t x, f
 	Return:-
 		None
 --------------------------------------------------*/
-static struct nudgeSearch_s
+static thread_local struct nudgeSearch_s
 {
 	mobj_t *botmo;
 	angle_t angle;
@@ -746,7 +746,7 @@ void K_NudgePredictionTowardsObjects(botprediction_t *predict, const player_t *p
 	{
 		for (by = yl; by <= yh; by++)
 		{
-			P_BlockThingsIterator(bx, by, K_FindObjectsForNudging);
+			P_BlockThingsSearch(bx, by, K_FindObjectsForNudging);
 		}
 	}
 
@@ -877,7 +877,7 @@ void K_NudgePredictionTowardsObjects(botprediction_t *predict, const player_t *p
 	Return:-
 		BlockItReturn_t enum, see its definition for more information.
 --------------------------------------------------*/
-static struct bullySearch_s
+static thread_local struct bullySearch_s
 {
 	mobj_t *botmo;
 	fixed_t distancetocheck;
@@ -993,7 +993,7 @@ INT32 K_PositionBully(const player_t *player)
 	{
 		for (by = yl; by <= yh; by++)
 		{
-			P_BlockThingsIterator(bx, by, K_FindPlayersToBully);
+			P_BlockThingsSearch(bx, by, K_FindPlayersToBully);
 		}
 	}
 
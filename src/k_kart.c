@@ -10123,12 +10123,10 @@ static void K_UpdateDistanceFromFinishLine(player_t *const player)
 		else if ((player->currentwaypoint != NULL) && (player->nextwaypoint != NULL) && (finishline != NULL))
 		{
 			const boolean useshortcuts = false;
-			const boolean huntbackwards = false;
 			boolean pathfindsuccess = false;
-			path_t pathtofinish = {0};
+			UINT32 distancetofinish = 0U;
 
-			pathfindsuccess =
-				K_PathfindToWaypoint(player->nextwaypoint, finishline, &pathtofinish, useshortcuts, huntbackwards);
+			pathfindsuccess = K_GetFinishLineDistance(player->nextwaypoint, useshortcuts, &distancetofinish);
 
 			// Update the player's distance to the finish line if a path was found.
 			// Using shortcuts won't find a path, so distance won't be updated until the player gets back on track
@@ -10255,9 +10253,9 @@ static void K_UpdateDistanceFromFinishLine(player_t *const player)
 
 				if (pathBackwardsReverse == false)
 				{
-					if (pathtofinish.totaldist > adddist)
+					if (distancetofinish > adddist)
 					{
-						player->distancetofinish = pathtofinish.totaldist - adddist;
+						player->distancetofinish = distancetofinish - adddist;
 					}
 					else
 					{
@@ -10266,9 +10264,8 @@ static void K_UpdateDistanceFromFinishLine(player_t *const player)
 				}
 				else
 				{
-					player->distancetofinish = pathtofinish.totaldist + adddist;
+					player->distancetofinish = distancetofinish + adddist;
 				}
-				Z_Free(pathtofinish.array);
 
 				// distancetofinish is currently a flat distance to the finish line, but in order to be fully
 				// correct we need to add to it the length of the entire circuit multiplied by the number of laps
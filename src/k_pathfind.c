@@ -20,6 +20,16 @@ static const size_t DEFAULT_NODEARRAY_CAPACITY = 8U;
 static const size_t DEFAULT_OPENSET_CAPACITY   = 8U;
 static const size_t DEFAULT_CLOSEDSET_CAPACITY = 8U;
 
+// When the graph gives its nodes dense indices, each index gets a slot here so that finding a node in the nodes array
+// or the closed set is a lookup instead of a search. The arrays are kept between pathfinds, and each pathfind has its
+// own generation, so a stale stamp just means "not seen yet" and nothing ever has to be cleared.
+// Pathfinding only runs on the main thread.
+static UINT32 *nodeindexstamps    = NULL; // generation the node was added to the nodes array in
+static UINT32 *nodeindexclosed    = NULL; // generation the node was added to the closed set in
+static size_t *nodeindexslots     = NULL; // where the node is in the nodes array
+static size_t nodeindexcapacity   = 0U;
+static UINT32 nodeindexgeneration = 0U;
+
 
 /*--------------------------------------------------
 	static UINT32 K_NodeGetFScore(const pathfindnode_t *const node)
@@ -145,6 +155,80 @@ static boolean K_ClosedsetContainsNode(pathfindnode_t **closedset, pathfindnode_
 	return nodeisinclosedset;
 }
 
+/*--------------------------------------------------
+	static boolean K_NodeIndexBegin(const pathfindsetup_t *const pathfindsetup)
+
+		Gets the dense node index arrays ready for a new pathfind, if the setup has dense indices.
+
+	Input Arguments:-
+		pathfindsetup - The setup for the pathfinding given
+
+	Return:-
+		True if the dense node index arrays can be used for this pathfind, false if the sets need to be searched.
+--------------------------------------------------*/
+static boolean K_NodeIndexBegin(const pathfindsetup_t *const pathfindsetup)
+{
+	I_Assert(pathfindsetup != NULL);
+
+	if (pathfindsetup->getnodeindex == NULL || pathfindsetup->numnodeindices == 0U)
+	{
+		return false;
+	}
+
+	if (pathfindsetup->numnodeindices > nodeindexcapacity)
+	{
+		nodeindexcapacity = pathfindsetup->numnodeindices;
+		nodeindexstamps = Z_Realloc(nodeindexstamps, nodeindexcapacity * sizeof(UINT32), PU_STATIC, NULL);
+		nodeindexclosed = Z_Realloc(nodeindexclosed, nodeindexcapacity * sizeof(UINT32), PU_STATIC, NULL);
+		nodeindexslots  = Z_Realloc(nodeindexslots, nodeindexcapacity * sizeof(size_t), PU_STATIC, NULL);
+		if (nodeindexstamps == NULL || nodeindexclosed == NULL || nodeindexslots == NULL)
+		{
+			I_Error("K_NodeIndexBegin: Out of memory allocating node indices.");
+		}
+
+		// New memory could hold anything
+		memset(nodeindexstamps, 0, nodeindexcapacity * sizeof(UINT32));
+		memset(nodeindexclosed, 0, nodeindexcapacity * sizeof(UINT32));
+		nodeindexgeneration = 0U;
+	}
+
+	nodeindexgeneration++;
+	if (nodeindexgeneration == 0U)
+	{
+		// Wrapped around, old stamps could match again
+		memset(nodeindexstamps, 0, nodeindexcapacity * sizeof(UINT32));
+		memset(nodeindexclosed, 0, nodeindexcapacity * sizeof(UINT32));
+		nodeindexgeneration = 1U;
+	}
+
+	return true;
+}
+
+/*--------------------------------------------------
+	static size_t K_NodeIndexOf(const pathfindsetup_t *const pathfindsetup, void *nodedata)
+
+		Gets the dense index of a node's data, checking it is in range.
+
+	Input Arguments:-
+		pathfindsetup - The setup for the pathfinding given
+		nodedata      - The node data to get the index of
+
+	Return:-
+		The dense index of the node data.
+--------------------------------------------------*/
+static size_t K_NodeIndexOf(const pathfindsetup_t *const pathfindsetup, void *nodedata)
+{
+	size_t nodeindex = pathfindsetup->getnodeindex(nodedata);
+
+	if (nodeindex >= pathfindsetup->numnodeindices)
+	{
+		I_Error("K_NodeIndexOf: Node index %s out of range (%s nodes).",
+			sizeu1(nodeindex), sizeu2(pathfindsetup->numnodeindices));
+	}
+
+	return nodeindex;
+}
+
 /*--------------------------------------------------
 	static boolean K_PathfindSetupValid(const pathfindsetup_t *const pathfindsetup)
 
@@ -332,6 +416,8 @@ boolean K_PathfindAStar(path_t *const path, pathfindsetup_t *const pathfindsetup
 			size_t         closedsetcount          = 0U;
 			size_t         i                       = 0U;
 			UINT32         tentativegscore         = 0U;
+			const boolean  useindices              = K_NodeIndexBegin(pathfindsetup);
+			size_t         checknodeindex          = 0U;
 
 			// Set the dynamic structure capacites to defaults if they are 0
 			if (pathfindsetup->nodesarraycapacity == 0U)
@@ -367,6 +453,12 @@ boolean K_PathfindAStar(path_t *const path, pathfindsetup_t *const pathfindsetup
 			newnode->camefrom  = NULL;
 			newnode->gscore    = 0U;
 			newnode->hscore    = pathfindsetup->getheuristic(newnode->nodedata, pathfindsetup->endnodedata);
+			if (useindices)
+			{
+				checknodeindex = K_NodeIndexOf(pathfindsetup, newnode->nodedata);
+				nodeindexstamps[checknodeindex] = nodeindexgeneration;
+				nodeindexslots[checknodeindex]  = nodesarraycount;
+			}
 			nodesarraycount++;
 			K_BHeapPush(&openset, newnode, K_NodeGetFScore(newnode), K_NodeUpdateHeapIndex);
 
@@ -404,6 +496,10 @@ boolean K_PathfindAStar(path_t *const path, pathfindsetup_t *const pathfindsetup
 				}
 				closedset[closedsetcount] = currentnode;
 				closedsetcount++;
+				if (useindices)
+				{
+					nodeindexclosed[K_NodeIndexOf(pathfindsetup, currentnode->nodedata)] = nodeindexgeneration;
+				}
 
 				// Get the needed data for the next nodes from the current node
 				connectingnodesdata = pathfindsetup->getconnectednodes(currentnode->nodedata, &numconnectingnodes);
@@ -441,13 +537,27 @@ boolean K_PathfindAStar(path_t *const path, pathfindsetup_t *const pathfindsetup
 							tentativegscore = currentnode->gscore + connectingnodecosts[i];
 
 							// find this data in the nodes array if it's been generated before
-							connectingnode = K_NodesArrayContainsNodeData(nodesarray, checknodedata, nodesarraycount);
+							if (useindices)
+							{
+								checknodeindex = K_NodeIndexOf(pathfindsetup, checknodedata);
+								connectingnode = NULL;
+								if (nodeindexstamps[checknodeindex] == nodeindexgeneration)
+								{
+									connectingnode = &nodesarray[nodeindexslots[checknodeindex]];
+								}
+							}
+							else
+							{
+								connectingnode = K_NodesArrayContainsNodeData(nodesarray, checknodedata, nodesarraycount);
+							}
 
 							if (connectingnode != NULL)
 							{
 								// The connecting node has been seen before, so it must be in either the closedset (skip it)
 								// or the openset (re-evaluate it's gscore)
-								if (K_ClosedsetContainsNode(closedset, connectingnode, closedsetcount) == true)
+								if (useindices
+									? (nodeindexclosed[checknodeindex] == nodeindexgeneration)
+									: (K_ClosedsetContainsNode(closedset, connectingnode, closedsetcount) == true))
 								{
 									continue;
 								}
@@ -524,6 +634,11 @@ boolean K_PathfindAStar(path_t *const path, pathfindsetup_t *const pathfindsetup
 								newnode->camefrom  = currentnode;
 								newnode->gscore    = tentativegscore;
 								newnode->hscore    = pathfindsetup->getheuristic(newnode->nodedata, pathfindsetup->endnodedata);
+								if (useindices)
+								{
+									nodeindexstamps[checknodeindex] = nodeindexgeneration;
+									nodeindexslots[checknodeindex]  = nodesarraycount;
+								}
 								nodesarraycount++;
 								K_BHeapPush(&openset, newnode, K_NodeGetFScore(newnode), K_NodeUpdateHeapIndex);
 							}
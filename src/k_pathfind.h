@@ -36,6 +36,9 @@ typedef boolean(*getnodetraversablefunc)(void*, void*);
 // function pointer for getting if a node is our pathfinding end point
 typedef boolean(*getpathfindfinishedfunc)(void*, void*);
 
+// function pointer for getting a node's dense index from its base data, must be less than numnodeindices
+typedef size_t(*getnodeindexfunc)(void*);
+
 
 // A pathfindnode contains information about a node from the pathfinding
 // heapindex is only used within the pathfinding algorithm itself, and is always 0 after it is completed
@@ -71,6 +74,8 @@ struct pathfindsetup_t {
 	getnodeheuristicfunc getheuristic;
 	getnodetraversablefunc gettraversable;
 	getpathfindfinishedfunc getfinished;
+	getnodeindexfunc getnodeindex; // optional, lets the sets be checked without searching them
+	size_t numnodeindices;         // number of dense indices getnodeindex can return
 };
 
 
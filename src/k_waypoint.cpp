@@ -20,10 +20,14 @@
 #include "z_zone.h"
 #include "g_game.h"
 #include "p_slopes.h"
+#include "i_system.h" // I_GetPreciseTime
 
 #include "cxxutil.hpp"
 
 #include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
 #include <vector>
 
 #include <fmt/format.h>
@@ -354,9 +358,8 @@ static void K_CompareOverlappingWaypoint
 		fixed_t     *const bestfindist)
 {
 	const boolean useshortcuts = false;
-	const boolean huntbackwards = false;
 	boolean pathfindsuccess = false;
-	path_t pathtofinish = {0};
+	UINT32 distancetofinish = 0U;
 
 	if (K_GetWaypointIsShortcut(*bestwaypoint) == false
 		&& K_GetWaypointIsShortcut(checkwaypoint) == true)
@@ -365,18 +368,15 @@ static void K_CompareOverlappingWaypoint
 		return;
 	}
 
-	pathfindsuccess =
-		K_PathfindToWaypoint(checkwaypoint, finishline, &pathtofinish, useshortcuts, huntbackwards);
+	pathfindsuccess = K_GetFinishLineDistance(checkwaypoint, useshortcuts, &distancetofinish);
 
 	if (pathfindsuccess == true)
 	{
-		if ((INT32)(pathtofinish.totaldist) < *bestfindist)
+		if ((INT32)(distancetofinish) < *bestfindist)
 		{
 			*bestwaypoint = checkwaypoint;
-			*bestfindist = pathtofinish.totaldist;
+			*bestfindist = distancetofinish;
 		}
-
-		Z_Free(pathtofinish.array);
 	}
 }
 
@@ -1157,6 +1157,30 @@ static boolean K_WaypointPathfindTraversableNoShortcuts(void *data, void *prevda
 	return traversable;
 }
 
+/*--------------------------------------------------
+	static size_t K_WaypointPathfindGetIndex(void *data)
+
+		Gets the dense pathfinding index of a waypoint, which is its heap index. Waypoints that aren't in the heap
+		(the copied finish line K_SetupCircuitLength starts from) all share the one index after the heap.
+
+	Input Arguments:-
+		data - Should point to a waypoint_t to get the index of
+
+	Return:-
+		The pathfinding index of the waypoint.
+--------------------------------------------------*/
+static size_t K_WaypointPathfindGetIndex(void *data)
+{
+	waypoint_t *waypoint = (waypoint_t *)data;
+
+	if (waypoint < waypointheap || waypoint >= waypointheap + numwaypoints)
+	{
+		return numwaypoints;
+	}
+
+	return (size_t)(waypoint - waypointheap);
+}
+
 /*--------------------------------------------------
 	static boolean K_WaypointPathfindReachedEnd(void *data, void *setupData)
 
@@ -1365,6 +1389,8 @@ boolean K_PathfindToWaypoint(
 		pathfindsetup.getheuristic       = heuristicfunc;
 		pathfindsetup.gettraversable     = traversablefunc;
 		pathfindsetup.getfinished        = finishedfunc;
+		pathfindsetup.getnodeindex       = K_WaypointPathfindGetIndex;
+		pathfindsetup.numnodeindices     = numwaypoints + 1U;
 
 		pathfound = K_PathfindAStar(returnpath, &pathfindsetup);
 
@@ -1441,6 +1467,8 @@ boolean K_PathfindThruCircuit(
 		pathfindsetup.getheuristic       = heuristicfunc;
 		pathfindsetup.gettraversable     = traversablefunc;
 		pathfindsetup.getfinished        = finishedfunc;
+		pathfindsetup.getnodeindex       = K_WaypointPathfindGetIndex;
+		pathfindsetup.numnodeindices     = numwaypoints + 1U;
 
 		pathfound = K_PathfindAStar(returnpath, &pathfindsetup);
 
@@ -1452,6 +1480,376 @@ boolean K_PathfindThruCircuit(
 	return pathfound;
 }
 
+// Pathfinding the same static graph every tic, for every player, is wasteful, so K_SetupWaypointList
+// works everything out once. For both traversal variants ([useshortcuts]) there is each waypoint's
+// distance to the finish line, and for each waypoint with more than one way to go ([huntbackwards]),
+// which of those ways leads to every other waypoint. Waypoints with only one way to go don't need a
+// row, since K_GetNextWaypointToDestination never pathfinds from them.
+#define WAYPOINTTABLE_NOHOP (0xFF)
+#define WAYPOINTTABLE_NOROW (SIZE_MAX)
+
+static std::vector<UINT32> finishdistances[2];    // [useshortcuts][waypoint], UINT32_MAX if unreachable
+static std::vector<size_t> nexthoprows[2];        // [huntbackwards][waypoint], WAYPOINTTABLE_NOROW if unbranched
+static std::vector<UINT8>  nexthops[2][2];        // [useshortcuts][huntbackwards][row * numwaypoints + destination]
+static std::vector<UINT8>  waypointtableflags;    // Enabled and shortcut flags the tables were built with
+static boolean             waypointtablesvalid = false;
+static tic_t               waypointtablecheck  = 0;
+
+#define WAYPOINTTABLE_ENABLED  (1U)
+#define WAYPOINTTABLE_SHORTCUT (2U)
+
+/*--------------------------------------------------
+	static UINT8 K_GetWaypointTableFlags(waypoint_t *const waypoint)
+
+		Gets everything about a waypoint that changes how the waypoint tables are built.
+
+	Input Arguments:-
+		waypoint - The waypoint to get the flags of
+
+	Return:-
+		WAYPOINTTABLE_ENABLED and WAYPOINTTABLE_SHORTCUT, as they apply.
+--------------------------------------------------*/
+static UINT8 K_GetWaypointTableFlags(waypoint_t *const waypoint)
+{
+	UINT8 flags = 0U;
+
+	if (K_GetWaypointIsEnabled(waypoint) == true)
+	{
+		flags |= WAYPOINTTABLE_ENABLED;
+	}
+
+	if (K_GetWaypointIsShortcut(waypoint) == true)
+	{
+		flags |= WAYPOINTTABLE_SHORTCUT;
+	}
+
+	return flags;
+}
+
+/*--------------------------------------------------
+	static boolean K_WaypointTableTraversable(size_t waypointindex, size_t previndex, const boolean useshortcuts)
+
+		The waypoint tables' version of the pathfinding traversable functions, from the flags the tables are
+		being built with.
+
+	Input Arguments:-
+		waypointindex - The heap index of the waypoint being moved to
+		previndex     - The heap index of the waypoint being moved from
+		useshortcuts  - Whether shortcut waypoints are traversable
+
+	Return:-
+		True if the waypoint is traversable, false otherwise.
+--------------------------------------------------*/
+static boolean K_WaypointTableTraversable(size_t waypointindex, size_t previndex, const boolean useshortcuts)
+{
+	const UINT8 flags = waypointtableflags[waypointindex];
+
+	if ((flags & WAYPOINTTABLE_ENABLED) == 0U)
+	{
+		return false;
+	}
+
+	// Allow shortcuts to be used if the starting waypoint is already a shortcut.
+	return (useshortcuts == true || (flags & WAYPOINTTABLE_SHORTCUT) == 0U
+		|| (waypointtableflags[previndex] & WAYPOINTTABLE_SHORTCUT) != 0U);
+}
+
+/*--------------------------------------------------
+	static void K_BuildFinishDistances(const boolean useshortcuts)
+
+		Builds every waypoint's distance to the finish line, with a search outwards from the finish line
+		through the previous waypoints.
+
+	Input Arguments:-
+		useshortcuts - Whether shortcut waypoints are traversable
+--------------------------------------------------*/
+static void K_BuildFinishDistances(const boolean useshortcuts)
+{
+	using queued_t = std::pair<UINT32, size_t>;
+	std::priority_queue<queued_t, std::vector<queued_t>, std::greater<queued_t>> openset;
+	std::vector<UINT32> &distances = finishdistances[useshortcuts ? 1 : 0];
+	const size_t finishindex = (size_t)(finishline - waypointheap);
+
+	distances.assign(numwaypoints, UINT32_MAX);
+
+	// K_PathfindToWaypoint can't get anywhere if nothing leads to the finish line
+	if (finishline->numprevwaypoints == 0U)
+	{
+		return;
+	}
+
+	distances[finishindex] = 0U;
+	openset.push({0U, finishindex});
+
+	while (openset.empty() == false)
+	{
+		const queued_t top = openset.top();
+		waypoint_t *const waypoint = &waypointheap[top.second];
+		size_t i;
+
+		openset.pop();
+
+		if (top.first > distances[top.second])
+		{
+			continue;
+		}
+
+		for (i = 0U; i < waypoint->numprevwaypoints; i++)
+		{
+			const size_t previndex = (size_t)(waypoint->prevwaypoints[i] - waypointheap);
+			const UINT32 distance = top.first + waypoint->prevwaypointdistances[i];
+
+			if (K_WaypointTableTraversable(top.second, previndex, useshortcuts) == true
+				&& distance < distances[previndex])
+			{
+				distances[previndex] = distance;
+				openset.push({distance, previndex});
+			}
+		}
+	}
+}
+
+/*--------------------------------------------------
+	static void K_BuildNextHopRow(size_t sourceindex, const boolean useshortcuts, const boolean huntbackwards)
+
+		Builds which of a waypoint's connections leads to every other waypoint, with a search outwards from it.
+
+	Input Arguments:-
+		sourceindex   - The heap index of the waypoint to build the row of
+		useshortcuts  - Whether shortcut waypoints are traversable
+		huntbackwards - Goes through the waypoints backwards if true
+--------------------------------------------------*/
+static void K_BuildNextHopRow(size_t sourceindex, const boolean useshortcuts, const boolean huntbackwards)
+{
+	using queued_t = std::pair<UINT32, size_t>;
+	std::priority_queue<queued_t, std::vector<queued_t>, std::greater<queued_t>> openset;
+	std::vector<UINT32> distances(numwaypoints, UINT32_MAX);
+	UINT8 *const hops = &nexthops[useshortcuts ? 1 : 0][huntbackwards ? 1 : 0][nexthoprows[huntbackwards ? 1 : 0][sourceindex] * numwaypoints];
+
+	distances[sourceindex] = 0U;
+	openset.push({0U, sourceindex});
+
+	while (openset.empty() == false)
+	{
+		const queued_t top = openset.top();
+		waypoint_t *const waypoint = &waypointheap[top.second];
+		waypoint_t **const connections = huntbackwards ? waypoint->prevwaypoints : waypoint->nextwaypoints;
+		UINT32 *const costs = huntbackwards ? waypoint->prevwaypointdistances : waypoint->nextwaypointdistances;
+		const size_t numconnections = huntbackwards ? waypoint->numprevwaypoints : waypoint->numnextwaypoints;
+		size_t i;
+
+		openset.pop();
+
+		if (top.first > distances[top.second])
+		{
+			continue;
+		}
+
+		for (i = 0U; i < numconnections; i++)
+		{
+			const size_t nextindex = (size_t)(connections[i] - waypointheap);
+			const UINT32 distance = top.first + costs[i];
+
+			if (K_WaypointTableTraversable(nextindex, top.second, useshortcuts) == true
+				&& distance < distances[nextindex])
+			{
+				distances[nextindex] = distance;
+				hops[nextindex] = (top.second == sourceindex) ? (UINT8)i : hops[top.second];
+				openset.push({distance, nextindex});
+			}
+		}
+	}
+}
+
+/*--------------------------------------------------
+	static void K_BuildWaypointTables(void)
+
+		Builds every waypoint table from the waypoints as they are now.
+--------------------------------------------------*/
+static void K_BuildWaypointTables(void)
+{
+	size_t i;
+	size_t numrows[2] = {0U, 0U};
+
+	for (i = 0U; i < numwaypoints; i++)
+	{
+		waypointtableflags[i] = K_GetWaypointTableFlags(&waypointheap[i]);
+	}
+
+	for (i = 0U; i < 2U; i++)
+	{
+		K_BuildFinishDistances(i == 1U);
+	}
+
+	for (i = 0U; i < numwaypoints; i++)
+	{
+		const size_t numconnections[2] = {waypointheap[i].numnextwaypoints, waypointheap[i].numprevwaypoints};
+		size_t backwards;
+
+		for (backwards = 0U; backwards < 2U; backwards++)
+		{
+			// Hops are stored as connection indexes, with WAYPOINTTABLE_NOHOP kept for none
+			if (numconnections[backwards] > 1U && numconnections[backwards] < WAYPOINTTABLE_NOHOP)
+			{
+				nexthoprows[backwards][i] = numrows[backwards]++;
+			}
+			else
+			{
+				nexthoprows[backwards][i] = WAYPOINTTABLE_NOROW;
+			}
+		}
+	}
+
+	for (i = 0U; i < 4U; i++)
+	{
+		const boolean useshortcuts = (i & 1U) != 0U;
+		const boolean huntbackwards = (i & 2U) != 0U;
+		size_t source;
+
+		nexthops[useshortcuts][huntbackwards].assign(numrows[huntbackwards] * numwaypoints, WAYPOINTTABLE_NOHOP);
+
+		for (source = 0U; source < numwaypoints; source++)
+		{
+			if (nexthoprows[huntbackwards][source] != WAYPOINTTABLE_NOROW)
+			{
+				K_BuildNextHopRow(source, useshortcuts, huntbackwards);
+			}
+		}
+	}
+}
+
+/*--------------------------------------------------
+	void K_UpdateWaypointTables(void)
+
+		See header file for description.
+--------------------------------------------------*/
+void K_UpdateWaypointTables(void)
+{
+	boolean changed = (waypointtablesvalid == false);
+	size_t i;
+
+	waypointtablecheck = leveltime;
+
+	if (waypointheap == NULL || numwaypoints == 0U || finishline == NULL)
+	{
+		waypointtablesvalid = false;
+		return;
+	}
+
+	if (waypointtableflags.size() != numwaypoints)
+	{
+		waypointtableflags.assign(numwaypoints, 0U);
+		finishdistances[0].assign(numwaypoints, UINT32_MAX);
+		finishdistances[1].assign(numwaypoints, UINT32_MAX);
+		nexthoprows[0].assign(numwaypoints, WAYPOINTTABLE_NOROW);
+		nexthoprows[1].assign(numwaypoints, WAYPOINTTABLE_NOROW);
+		changed = true;
+	}
+
+	for (i = 0U; i < numwaypoints && changed == false; i++)
+	{
+		changed = (waypointtableflags[i] != K_GetWaypointTableFlags(&waypointheap[i]));
+	}
+
+	if (changed == true)
+	{
+		K_BuildWaypointTables();
+	}
+
+	waypointtablesvalid = true;
+}
+
+/*--------------------------------------------------
+	void K_InvalidateWaypointTables(void)
+
+		See header file for description.
+--------------------------------------------------*/
+void K_InvalidateWaypointTables(void)
+{
+	waypointtablesvalid = false;
+}
+
+/*--------------------------------------------------
+	static boolean K_WaypointTablesReady(void)
+
+		Checks the waypoints against the tables once per tic, rebuilding them if anything changed, since not
+		everything that toggles a waypoint invalidates them.
+
+	Return:-
+		True if the tables can be used, false if waypoints have changed since they were built this tic.
+--------------------------------------------------*/
+static boolean K_WaypointTablesReady(void)
+{
+	if (waypointtablecheck != leveltime)
+	{
+		K_UpdateWaypointTables();
+	}
+
+	return waypointtablesvalid;
+}
+
+/*--------------------------------------------------
+	boolean K_GetFinishLineDistance(
+		waypoint_t *const sourcewaypoint,
+		const boolean     useshortcuts,
+		UINT32 *const     returndist)
+
+		See header file for description.
+--------------------------------------------------*/
+boolean K_GetFinishLineDistance(
+	waypoint_t *const sourcewaypoint,
+	const boolean     useshortcuts,
+	UINT32 *const     returndist)
+{
+	const boolean huntbackwards = false;
+	boolean pathfound = false;
+	path_t pathtofinish = {0};
+	size_t index;
+
+	if (sourcewaypoint == NULL)
+	{
+		CONS_Debug(DBG_GAMELOGIC, "NULL sourcewaypoint in K_GetFinishLineDistance.\n");
+		return false;
+	}
+
+	if (returndist == NULL)
+	{
+		CONS_Debug(DBG_GAMELOGIC, "NULL returndist in K_GetFinishLineDistance.\n");
+		return false;
+	}
+
+	if (finishline == NULL)
+	{
+		return false;
+	}
+
+	index = K_WaypointPathfindGetIndex(sourcewaypoint);
+
+	if (index < numwaypoints && K_WaypointTablesReady() == true)
+	{
+		const UINT32 distance = finishdistances[useshortcuts ? 1 : 0][index];
+
+		// Like K_PathfindToWaypoint, there's no path from a waypoint that goes nowhere, even the finish line
+		if (distance == UINT32_MAX || sourcewaypoint->numnextwaypoints == 0U)
+		{
+			return false;
+		}
+
+		*returndist = distance;
+		return true;
+	}
+
+	pathfound = K_PathfindToWaypoint(sourcewaypoint, finishline, &pathtofinish, useshortcuts, huntbackwards);
+
+	if (pathfound == true)
+	{
+		*returndist = pathtofinish.totaldist;
+		Z_Free(pathtofinish.array);
+	}
+
+	return pathfound;
+}
+
 /*--------------------------------------------------
 	boolean K_PathfindThruCircuitSpawnable(
 		waypoint_t *const sourcewaypoint,
@@ -1517,6 +1915,8 @@ boolean K_PathfindThruCircuitSpawnable(
 		pathfindsetup.getheuristic       = heuristicfunc;
 		pathfindsetup.gettraversable     = traversablefunc;
 		pathfindsetup.getfinished        = finishedfunc;
+		pathfindsetup.getnodeindex       = K_WaypointPathfindGetIndex;
+		pathfindsetup.numnodeindices     = numwaypoints + 1U;
 
 		pathfound = K_PathfindAStar(returnpath, &pathfindsetup);
 
@@ -1528,6 +1928,65 @@ boolean K_PathfindThruCircuitSpawnable(
 	return pathfound;
 }
 
+/*--------------------------------------------------
+	void K_BenchmarkPathfinding(void)
+
+		See header file for description.
+--------------------------------------------------*/
+void K_BenchmarkPathfinding(void)
+{
+	const double us = 1000000.0 / I_GetPrecisePrecision();
+	const UINT32 traveldist = (circuitlength > 0U) ? circuitlength / 2U : 8192U;
+	path_t path = {0};
+	size_t found = 0U;
+	UINT64 pathnodes = 0U;
+	precise_t t = 0;
+	size_t i = 0U;
+
+	if (numwaypoints == 0U || finishline == NULL)
+	{
+		CONS_Printf("There are no waypoints on this map to pathfind through.\n");
+		return;
+	}
+
+	t = I_GetPreciseTime();
+	for (i = 0U; i < numwaypoints; i++)
+	{
+		if (K_PathfindToWaypoint(&waypointheap[i], finishline, &path, false, false))
+		{
+			found++;
+			pathnodes += path.numnodes;
+		}
+		Z_Free(path.array);
+		path = {0};
+	}
+	t = I_GetPreciseTime() - t;
+
+	CONS_Printf("K_PathfindToWaypoint: %s waypoints to the finish line, %s found (%llu nodes), %.0f us (%.2f us each)\n",
+		sizeu1(numwaypoints), sizeu2(found), (unsigned long long)pathnodes,
+		(double)t * us, (double)t * us / numwaypoints);
+
+	found = 0U;
+	pathnodes = 0U;
+
+	t = I_GetPreciseTime();
+	for (i = 0U; i < numwaypoints; i++)
+	{
+		if (K_PathfindThruCircuit(&waypointheap[i], traveldist, &path, false, false))
+		{
+			found++;
+			pathnodes += path.numnodes;
+		}
+		Z_Free(path.array);
+		path = {0};
+	}
+	t = I_GetPreciseTime() - t;
+
+	CONS_Printf("K_PathfindThruCircuit: %s waypoints, %u units ahead, %s found (%llu nodes), %.0f us (%.2f us each)\n",
+		sizeu1(numwaypoints), traveldist, sizeu2(found), (unsigned long long)pathnodes,
+		(double)t * us, (double)t * us / numwaypoints);
+}
+
 /*--------------------------------------------------
 	waypoint_t *K_GetNextWaypointToDestination(
 		waypoint_t *const sourcewaypoint,
@@ -1585,6 +2044,8 @@ waypoint_t *K_GetNextWaypointToDestination(
 		}
 		else
 		{
+			const size_t               sourceindex     = K_WaypointPathfindGetIndex(sourcewaypoint);
+			const size_t               destindex       = K_WaypointPathfindGetIndex(destinationwaypoint);
 			path_t                     pathtowaypoint  = {0};
 			pathfindsetup_t            pathfindsetup   = {0};
 			boolean                    pathfindsuccess = false;
@@ -1605,22 +2066,39 @@ waypoint_t *K_GetNextWaypointToDestination(
 				traversablefunc = K_WaypointPathfindTraversableAllEnabled;
 			}
 
-			pathfindsetup.opensetcapacity    = K_GetOpensetBaseSize();
-			pathfindsetup.closedsetcapacity  = K_GetClosedsetBaseSize();
-			pathfindsetup.nodesarraycapacity = K_GetNodesArrayBaseSize();
-			pathfindsetup.startnodedata      = sourcewaypoint;
-			pathfindsetup.endnodedata        = destinationwaypoint;
-			pathfindsetup.getconnectednodes  = nextnodesfunc;
-			pathfindsetup.getconnectioncosts = nodecostsfunc;
-			pathfindsetup.getheuristic       = heuristicfunc;
-			pathfindsetup.gettraversable     = traversablefunc;
-			pathfindsetup.getfinished        = finishedfunc;
-
-			pathfindsuccess = K_PathfindAStar(&pathtowaypoint, &pathfindsetup);
+			if (sourceindex < numwaypoints && destindex < numwaypoints
+				&& K_WaypointTablesReady() == true
+				&& nexthoprows[huntbackwards ? 1 : 0][sourceindex] != WAYPOINTTABLE_NOROW)
+			{
+				const size_t row = nexthoprows[huntbackwards ? 1 : 0][sourceindex];
+				const UINT8 hop = nexthops[useshortcuts ? 1 : 0][huntbackwards ? 1 : 0][row * numwaypoints + destindex];
 
-			K_UpdateOpensetBaseSize(pathfindsetup.opensetcapacity);
-			K_UpdateClosedsetBaseSize(pathfindsetup.closedsetcapacity);
-			K_UpdateNodesArrayBaseSize(pathfindsetup.nodesarraycapacity);
+				if (hop != WAYPOINTTABLE_NOHOP)
+				{
+					nextwaypoint = huntbackwards ? sourcewaypoint->prevwaypoints[hop] : sourcewaypoint->nextwaypoints[hop];
+				}
+			}
+			else
+			{
+				pathfindsetup.opensetcapacity    = K_GetOpensetBaseSize();
+				pathfindsetup.closedsetcapacity  = K_GetClosedsetBaseSize();
+				pathfindsetup.nodesarraycapacity = K_GetNodesArrayBaseSize();
+				pathfindsetup.startnodedata      = sourcewaypoint;
+				pathfindsetup.endnodedata        = destinationwaypoint;
+				pathfindsetup.getconnectednodes  = nextnodesfunc;
+				pathfindsetup.getconnectioncosts = nodecostsfunc;
+				pathfindsetup.getheuristic       = heuristicfunc;
+				pathfindsetup.gettraversable     = traversablefunc;
+				pathfindsetup.getfinished        = finishedfunc;
+				pathfindsetup.getnodeindex       = K_WaypointPathfindGetIndex;
+				pathfindsetup.numnodeindices     = numwaypoints + 1U;
+
+				pathfindsuccess = K_PathfindAStar(&pathtowaypoint, &pathfindsetup);
+
+				K_UpdateOpensetBaseSize(pathfindsetup.opensetcapacity);
+				K_UpdateClosedsetBaseSize(pathfindsetup.closedsetcapacity);
+				K_UpdateNodesArrayBaseSize(pathfindsetup.nodesarraycapacity);
+			}
 
 			if (pathfindsuccess)
 			{
@@ -1638,7 +2116,7 @@ waypoint_t *K_GetNextWaypointToDestination(
 
 				Z_Free(pathtowaypoint.array);
 			}
-			else
+			else if (nextwaypoint == NULL)
 			{
 				size_t     i                   = 0U;
 				waypoint_t **nextwaypointlist  = NULL;
@@ -2775,6 +3253,9 @@ boolean K_SetupWaypointList(void)
 					finishline = firstwaypoint;
 				}
 
+				K_InvalidateWaypointTables();
+				K_UpdateWaypointTables();
+
 				if (K_SetupCircuitLength() == 0)
 				{
 					CONS_Alert(CONS_ERROR, "Circuit track waypoints do not form a circuit.\n");
@@ -2808,6 +3289,8 @@ void K_ClearWaypoints(void)
 	numwaypointmobjs = 0U;
 	circuitlength    = 0U;
 	trackcomplexity  = 0U;
+
+	K_InvalidateWaypointTables();
 }
 
 /*--------------------------------------------------
@@ -267,6 +267,54 @@ boolean K_PathfindToWaypoint(
 	const boolean     huntbackwards);
 
 
+/*--------------------------------------------------
+	boolean K_GetFinishLineDistance(
+		waypoint_t *const sourcewaypoint,
+		const boolean     useshortcuts,
+		UINT32 *const     returndist)
+
+		Gets the shortest distance from a waypoint to the finish line, the same path K_PathfindToWaypoint
+		looks for. It's looked up in a table built with the waypoint list, so it's cheap to call every tic;
+		only waypoints outside the heap, or the rest of a tic where waypoints were toggled, pathfind.
+
+	Input Arguments:-
+		sourcewaypoint - The waypoint to start searching from
+		useshortcuts   - Whether to use waypoints that are marked as being shortcuts in the search
+		returndist     - Set to the distance to the finish line if one was found
+
+	Return:-
+		True if a path was found to the finish line, false if there wasn't.
+--------------------------------------------------*/
+
+boolean K_GetFinishLineDistance(
+	waypoint_t *const sourcewaypoint,
+	const boolean     useshortcuts,
+	UINT32 *const     returndist);
+
+
+/*--------------------------------------------------
+	void K_UpdateWaypointTables(void)
+
+		Rebuilds the tables K_GetFinishLineDistance and K_GetNextWaypointToDestination look paths up in, if any
+		waypoint has been enabled, disabled or made a shortcut since they were built, or they were invalidated.
+		This already happens on its own once per tic. Call it when the waypoints are replaced, such as after
+		loading a netgame, so the tables are the same as everyone else's straight away.
+--------------------------------------------------*/
+
+void K_UpdateWaypointTables(void);
+
+
+/*--------------------------------------------------
+	void K_InvalidateWaypointTables(void)
+
+		Makes K_GetFinishLineDistance and K_GetNextWaypointToDestination pathfind instead of using the waypoint
+		tables, until the next tic rebuilds them. Call this whenever a waypoint is enabled, disabled or made a
+		shortcut, so nothing uses tables that no longer match for the rest of the tic.
+--------------------------------------------------*/
+
+void K_InvalidateWaypointTables(void);
+
+
 /*--------------------------------------------------
 	boolean K_PathfindThruCircuit(
 		waypoint_t *const sourcewaypoint,
@@ -337,7 +385,8 @@ boolean K_PathfindThruCircuitSpawnable(
 
 		Uses pathfinding to find the next waypoint to go to in order to get to the destination waypoint, from the source
 		waypoint. If the source waypoint only has one next waypoint it will always pick that one and not do any
-		pathfinding.
+		pathfinding. Otherwise the answer comes from a table built with the waypoint list, and it only pathfinds
+		for the rest of a tic where waypoints were toggled.
 
 	Input Arguments:-
 		sourcewaypoint      - The waypoint to start searching from
@@ -429,6 +478,16 @@ size_t K_GetNumWaypoints(void);
 waypoint_t *K_GetWaypointFromIndex(size_t waypointindex);
 
 
+/*--------------------------------------------------
+	void K_BenchmarkPathfinding(void)
+
+		Pathfinds from every waypoint on the map, both to the finish line and a set distance around the circuit,
+		and prints how long it took. For profiling the pathfinding.
+--------------------------------------------------*/
+
+void K_BenchmarkPathfinding(void);
+
+
 /*--------------------------------------------------
 	void K_DebugWaypointsVisualise()
 
@@ -118,6 +118,10 @@ ENUM (STRING_HOOK);
 
 extern boolean hook_cmd_running;
 
+boolean LUA_HookExists(int hook);
+
+void Command_HookBench_f(void);
+
 void LUA_HookVoid(int hook);
 void LUA_HookHUD(huddrawlist_h, int hook);
 
@@ -14,6 +14,7 @@
 #include "doomdef.h"
 #include "doomstat.h"
 #include "p_mobj.h"
+#include "p_local.h" // thlist
 #include "g_game.h"
 #include "r_skins.h"
 #include "k_bot.h"
@@ -31,6 +32,7 @@
 #include "i_system.h" // I_GetPreciseTime
 
 #include "v_video.h" // V_ClearClipRect
+#include "core/trace.h"
 
 /* =========================================================================
                                   ABSTRACTION
@@ -60,6 +62,13 @@ static hook_t hookIds[HOOK(MAX)];
 static hook_t hudHookIds[HUD_HOOK(MAX)];
 static hook_t mobjHookIds[NUMMOBJTYPES][MOBJ_HOOK(MAX)];
 
+// The functions a mobj type's hooks run, generic hooks first, cached in
+// one Lua table so a call fetches that once, instead of every function
+// from the registry. Types with no hooks of their own share MT_NULL's.
+// 0 until built; all of them are dropped when addHook adds a mobj hook.
+static int mobjDispatchRefs[NUMMOBJTYPES][MOBJ_HOOK(MAX)];
+static boolean mobjDispatchDirty;
+
 // Lua tables are used to lookup string hook ids.
 static stringhook_t stringHooks[STRING_HOOK(MAX)];
 
@@ -167,6 +176,7 @@ static void add_mobj_hook(lua_State *L, int hook_type)
 	luaL_argcheck(L, mobj_type < NUMMOBJTYPES, 3, "invalid mobjtype_t");
 
 	add_hook(&mobjHookIds[mobj_type][hook_type]);
+	mobjDispatchDirty = true;
 }
 
 static void add_hud_hook(lua_State *L, int idx)
@@ -236,6 +246,10 @@ int LUA_HookLib(lua_State *L)
 	lua_pushcfunction(L, LUA_GetErrorMessage);
 	errorRef = luaL_ref(L, LUA_REGISTRYINDEX);
 
+	/* the cached tables went with the old state */
+	memset(mobjDispatchRefs, 0, sizeof mobjDispatchRefs);
+	mobjDispatchDirty = false;
+
 	lua_register(L, "addHook", lib_addHook);
 
 	return 0;
@@ -334,6 +348,12 @@ static boolean prepare_hook
 			hookIds[hook_type].numHooks);
 }
 
+/* for callers that need to know ahead of time, not just to skip work */
+boolean LUA_HookExists(int hook_type)
+{
+	return (hookIds[hook_type].numHooks > 0);
+}
+
 static boolean prepare_mobj_hook
 (
 		Hook_State * hook,
@@ -433,19 +453,24 @@ static const char *hook_name(Hook_State *hook)
 static int pcall_timed_or_untimed(Hook_State *hook)
 {
 	extern consvar_t cv_lua_profile;
+	int k;
+
+	Trace_Begin(hook_name(hook));
 
 	if (!hud_running && cv_lua_profile.value > 0)
 	{
 		lua_timer_t *timer = LUA_BeginFunctionTimer(gL, -1 - hook->values, hook_name(hook));
-		int k = pcall(hook);
+		k = pcall(hook);
 		LUA_EndFunctionTimer(timer);
-
-		return k;
 	}
 	else
 	{
-		return pcall(hook);
+		k = pcall(hook);
 	}
+
+	Trace_End();
+
+	return k;
 }
 
 static int call_single_hook_no_copy(Hook_State *hook)
@@ -531,9 +556,93 @@ static int call_string_hooks(Hook_State *hook)
 	return calls;
 }
 
-static int call_mobj_type_hooks(Hook_State *hook, mobjtype_t mobj_type)
+static void clear_mobj_dispatch(void)
+{
+	int i, k;
+
+	for (i = 0; i < NUMMOBJTYPES; ++i)
+	{
+		for (k = 0; k < MOBJ_HOOK(MAX); ++k)
+		{
+			if (mobjDispatchRefs[i][k])
+				luaL_unref(gL, LUA_REGISTRYINDEX, mobjDispatchRefs[i][k]);
+			mobjDispatchRefs[i][k] = 0;
+		}
+	}
+
+	mobjDispatchDirty = false;
+}
+
+static void push_hook_functions(const hook_t *map, int n)
 {
-	return call_mapped(hook, &mobjHookIds[mobj_type][hook->hook_type]);
+	int k;
+
+	for (k = 0; k < map->numHooks; ++k)
+	{
+		lua_getref(gL, hookRefs[map->ids[k]]);
+		lua_rawseti(gL, -2, n + k + 1);
+	}
+}
+
+/* push the table of functions this hook runs for this type */
+static void push_mobj_dispatch(Hook_State *hook)
+{
+	const hook_t *generic = &mobjHookIds[MT_NULL][hook->hook_type];
+	const hook_t *specific = &mobjHookIds[hook->mobj_type][hook->hook_type];
+	int *ref;
+
+	if (mobjDispatchDirty)
+		clear_mobj_dispatch();
+
+	if (specific->numHooks > 0)
+		ref = &mobjDispatchRefs[hook->mobj_type][hook->hook_type];
+	else
+		ref = &mobjDispatchRefs[MT_NULL][hook->hook_type];
+
+	if (*ref == 0)
+	{
+		lua_createtable(gL, generic->numHooks + specific->numHooks, 0);
+		push_hook_functions(generic, 0);
+
+		if (specific->numHooks > 0)
+			push_hook_functions(specific, generic->numHooks);
+
+		*ref = luaL_ref(gL, LUA_REGISTRYINDEX);
+	}
+
+	lua_getref(gL, *ref);
+}
+
+/* call every function of a dispatch table on top of the stack */
+static int call_dispatch_table(Hook_State *hook, const hook_t *generic, const hook_t *specific)
+{
+	int k;
+
+	for (k = 0; k < generic->numHooks; ++k)
+	{
+		hook->id = generic->ids[k];
+		lua_rawgeti(gL, -1, k + 1);
+		call_single_hook(hook);
+	}
+
+	for (k = 0; k < specific->numHooks; ++k)
+	{
+		hook->id = specific->ids[k];
+		lua_rawgeti(gL, -1, generic->numHooks + k + 1);
+		call_single_hook(hook);
+	}
+
+	return generic->numHooks + specific->numHooks;
+}
+
+static int call_mobj_hooks(Hook_State *hook)
+{
+	const hook_t *generic = &mobjHookIds[MT_NULL][hook->hook_type];
+	const hook_t *specific = &mobjHookIds[hook->mobj_type][hook->hook_type];
+
+	push_mobj_dispatch(hook);
+
+	return call_dispatch_table(hook, generic, specific);
 }
 
 static int call_hooks
@@ -552,9 +661,7 @@ static int call_hooks
 	}
 	else if (hook->mobj_type > 0)
 	{
-		/* call generic mobj hooks first */
-		calls += call_mobj_type_hooks(hook, MT_NULL);
-		calls += call_mobj_type_hooks(hook, hook->mobj_type);
+		calls += call_mobj_hooks(hook);
 
 		ps_lua_mobjhooks += calls;
 	}
@@ -1008,3 +1115,127 @@ int LUA_HookSeenPlayer(player_t *player, player_t *seenfriend)
 }
 
 boolean hook_cmd_running = false;
+
+/* one MobjThinker call as LUA_HookMobj makes it, on functions that aren't hooked */
+static void bench_mobj_hook(mobj_t *mobj, const int *refs, int tableref, const hook_t *generic)
+{
+	const hook_t specific = {0};
+	Hook_State hook;
+	int k;
+
+	init_hook_type(&hook, false, MOBJ_HOOK(MobjThinker), mobj->type, NULL, 1);
+	LUA_PushUserdata(gL, mobj, META_MOBJ);
+	init_hook_call(&hook, 1, res_true);
+
+	if (tableref)
+	{
+		lua_getref(gL, tableref);
+		call_dispatch_table(&hook, generic, &specific);
+	}
+	else
+	{
+		/* how call_mapped fetches each function */
+		for (k = 0; k < generic->numHooks; ++k)
+		{
+			hook.id = generic->ids[k];
+			lua_getref(gL, refs[k]);
+			call_single_hook(&hook);
+		}
+	}
+
+	lua_settop(gL, 0);
+}
+
+// hookbench [mobjs] [hooks]: call that many empty functions (default 8)
+// the way a MobjThinker hook would, on that many of the level's mobjs
+// (default 5000, repeated as needed). Functions are fetched one by one
+// from the registry, then from one cached table. They're never given to
+// addHook, so the game's own hooks are left alone.
+void Command_HookBench_f(void)
+{
+	const int repeats = 10;
+	const int count = COM_Argc() > 1 ? max(atoi(COM_Argv(1)), 1) : 5000;
+	const int numhooks = COM_Argc() > 2 ? max(atoi(COM_Argv(2)), 1) : 8;
+	mobj_t **mobjs;
+	int *refs;
+	hook_t generic;
+	int tableref;
+	thinker_t *th;
+	precise_t best_old = UINT64_MAX;
+	precise_t best_new = UINT64_MAX;
+	int found = 0;
+	int i, r;
+
+	if (gL == NULL || gamestate != GS_LEVEL)
+	{
+		CONS_Printf("You must be in a level to use this.\n");
+		return;
+	}
+
+	mobjs = Z_Malloc(count * sizeof *mobjs, PU_STATIC, NULL);
+
+	for (th = thlist[THINK_MOBJ].next; th != &thlist[THINK_MOBJ] && found < count; th = th->next)
+	{
+		if (th->function.acp1 == (actionf_p1)P_RemoveThinkerDelayed)
+			continue;
+
+		mobjs[found++] = (mobj_t *)th;
+	}
+
+	if (found == 0)
+	{
+		CONS_Printf("There are no mobjs in this level.\n");
+		Z_Free(mobjs);
+		return;
+	}
+
+	refs = Z_Malloc(numhooks * sizeof *refs, PU_STATIC, NULL);
+	generic.numHooks = numhooks;
+	generic.ids = Z_Calloc(numhooks * sizeof *generic.ids, PU_STATIC, NULL);
+
+	for (i = 0; i < numhooks; ++i)
+	{
+		luaL_loadstring(gL, "local mo = ...");
+		refs[i] = luaL_ref(gL, LUA_REGISTRYINDEX);
+	}
+
+	lua_createtable(gL, numhooks, 0);
+	for (i = 0; i < numhooks; ++i)
+	{
+		lua_getref(gL, refs[i]);
+		lua_rawseti(gL, -2, i + 1);
+	}
+	tableref = luaL_ref(gL, LUA_REGISTRYINDEX);
+
+	for (r = 0; r < repeats; ++r)
+	{
+		precise_t t = I_GetPreciseTime();
+
+		for (i = 0; i < count; ++i)
+			bench_mobj_hook(mobjs[i % found], refs, 0, &generic);
+
+		best_old = min(best_old, I_GetPreciseTime() - t);
+		t = I_GetPreciseTime();
+
+		for (i = 0; i < count; ++i)
+			bench_mobj_hook(mobjs[i % found], refs, tableref, &generic);
+
+		best_new = min(best_new, I_GetPreciseTime() - t);
+	}
+
+	luaL_unref(gL, LUA_REGISTRYINDEX, tableref);
+	for (i = 0; i < numhooks; ++i)
+		luaL_unref(gL, LUA_REGISTRYINDEX, refs[i]);
+
+	CONS_Printf("%d mobjs (%d unique), %d hooks each\n", count, found, numhooks);
+	CONS_Printf("Fetched from the registry: %.0f us, %.3f us per mobj\n",
+		best_old * 1000000.0 / I_GetPrecisePrecision(),
+		best_old * 1000000.0 / I_GetPrecisePrecision() / count);
+	CONS_Printf("Cached table:              %.0f us, %.3f us per mobj\n",
+		best_new * 1000000.0 / I_GetPrecisePrecision(),
+		best_new * 1000000.0 / I_GetPrecisePrecision() / count);
+
+	Z_Free(generic.ids);
+	Z_Free(refs);
+	Z_Free(mobjs);
+}
@@ -802,6 +802,8 @@ static int mobj_set(lua_State *L)
 		return NOSET;
 	case mobj_lastlook:
 		mo->lastlook = luaL_checkinteger(L, 3);
+		if (mo->type == MT_WAYPOINT)
+			K_InvalidateWaypointTables(); // shortcut flag
 		break;
 	case mobj_spawnpoint:
 		if (lua_isnil(L, 3))
@@ -861,6 +863,8 @@ static int mobj_set(lua_State *L)
 		break;
 	case mobj_extravalue1:
 		mo->extravalue1 = luaL_checkinteger(L, 3);
+		if (mo->type == MT_WAYPOINT)
+			K_InvalidateWaypointTables(); // enabled flag
 		break;
 	case mobj_extravalue2:
 		mo->extravalue2 = luaL_checkinteger(L, 3);
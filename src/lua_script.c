@@ -42,6 +42,14 @@
 
 lua_State *gL = NULL;
 
+// Every pointer that has a userdata in LREG_VALID, so that
+// LUA_InvalidateUserdata can skip the registry for the vast
+// majority of frees, which Lua never saw.
+// Open addressing with linear probing; NULL is an empty slot.
+static void **pushedptrs = NULL;
+static size_t pushedcapacity = 0; // always a power of two
+static size_t numpushedptrs = 0;
+
 // List of internal libraries to load from SRB2
 static lua_CFunction liblist[] = {
 	LUA_EnumLib, // global metatable for enums
@@ -76,6 +84,91 @@ static void *LUA_Alloc(void *ud, void *ptr, size_t osize, size_t nsize)
 		return Z_Realloc(ptr, nsize, PU_LUA, NULL);
 }
 
+static size_t LUA_PushedSlot(const void *data)
+{
+	uintptr_t h = (uintptr_t)data;
+
+	// Pointers are aligned, and neighbours are often pushed
+	// together, so mix the bits before masking.
+	h ^= h >> 17;
+	h *= (uintptr_t)0x9E3779B97F4A7C15ull;
+	h ^= h >> 29;
+
+	return (size_t)h & (pushedcapacity - 1);
+}
+
+static void LUA_AddPushed(void *data);
+
+static void LUA_GrowPushed(void)
+{
+	void **old = pushedptrs;
+	size_t oldcapacity = pushedcapacity;
+	size_t i;
+
+	pushedcapacity = oldcapacity ? oldcapacity * 2 : 1024;
+	// PU_LUA, so freeing it doesn't come back through LUA_InvalidateUserdata
+	pushedptrs = Z_Calloc(pushedcapacity * sizeof *pushedptrs, PU_LUA, NULL);
+	numpushedptrs = 0;
+
+	for (i = 0; i < oldcapacity; i++)
+	{
+		if (old[i] != NULL)
+			LUA_AddPushed(old[i]);
+	}
+
+	Z_Free(old);
+}
+
+static void LUA_AddPushed(void *data)
+{
+	size_t i;
+
+	if ((numpushedptrs + 1) * 4 > pushedcapacity * 3)
+		LUA_GrowPushed();
+
+	for (i = LUA_PushedSlot(data); pushedptrs[i] != NULL; i = (i + 1) & (pushedcapacity - 1))
+	{
+		if (pushedptrs[i] == data)
+			return;
+	}
+
+	pushedptrs[i] = data;
+	numpushedptrs++;
+}
+
+// Returns true if the pointer was in the set.
+static boolean LUA_RemovePushed(const void *data)
+{
+	size_t i, j;
+
+	if (numpushedptrs == 0)
+		return false;
+
+	for (i = LUA_PushedSlot(data); pushedptrs[i] != data; i = (i + 1) & (pushedcapacity - 1))
+	{
+		if (pushedptrs[i] == NULL)
+			return false;
+	}
+
+	// Shift the rest of the cluster back instead of leaving a tombstone
+	for (j = (i + 1) & (pushedcapacity - 1); pushedptrs[j] != NULL; j = (j + 1) & (pushedcapacity - 1))
+	{
+		size_t home = LUA_PushedSlot(pushedptrs[j]);
+
+		// Can the entry at j move into the hole at i?
+		if (((j - home) & (pushedcapacity - 1)) >= ((j - i) & (pushedcapacity - 1)))
+		{
+			pushedptrs[i] = pushedptrs[j];
+			i = j;
+		}
+	}
+
+	pushedptrs[i] = NULL;
+	numpushedptrs--;
+
+	return true;
+}
+
 // Panic function Lua calls when there's an unprotected error.
 // This function cannot return. Lua would kill the application anyway if it did.
 FUNCNORETURN static int LUA_Panic(lua_State *L)
@@ -496,6 +589,10 @@ void LUA_ClearState(void)
 		lua_close(gL);
 	gL = NULL;
 
+	Z_Free(pushedptrs);
+	pushedptrs = NULL;
+	pushedcapacity = numpushedptrs = 0;
+
 	CONS_Printf(M_GetText("Pardon me while I initialize the Lua scripting interface...\n"));
 
 	// allocate state
@@ -778,6 +875,8 @@ lpushed_t LUA_RawPushUserdata(lua_State *L, void *data)
 		lua_pushvalue(L, -2); // v (copy of the userdata)
 		lua_rawset(L, -4);
 
+		LUA_AddPushed(data);
+
 		// stack is left with the userdata on top, as if getting it had originally succeeded.
 
 		status = LPUSHED_NEW;
@@ -805,6 +904,10 @@ void LUA_InvalidateUserdata(void *data)
 	if (!gL)
 		return;
 
+	// never pushed, so there's nothing in the registry
+	if (!LUA_RemovePushed(data))
+		return;
+
 	// fetch the userdata
 	lua_getfield(gL, LUA_REGISTRYINDEX, LREG_VALID);
 	I_Assert(lua_istable(gL, -1));
@@ -841,7 +944,7 @@ void LUA_InvalidateLevel(void)
 	thinker_t *th;
 	size_t i;
 	ffloor_t *rover = NULL;
-	if (!gL)
+	if (!gL || numpushedptrs == 0)
 		return;
 	for (i = 0; i < NUM_THINKERLISTS; i++)
 		for (th = thlist[i].next; th && th != &thlist[i]; th = th->next)
@@ -902,7 +1005,7 @@ void LUA_InvalidateLevel(void)
 void LUA_InvalidateMapthings(void)
 {
 	size_t i;
-	if (!gL)
+	if (!gL || numpushedptrs == 0)
 		return;
 
 	for (i = 0; i < nummapthings; i++)
@@ -20,6 +20,7 @@
 #include "z_zone.h"
 #include "p_local.h"
 #include "g_game.h"
+#include "m_profile.h"
 
 #ifdef HWRENDER
 #include "hardware/hw_main.h"
@@ -161,6 +162,48 @@ static void M_DrawPerfCount(perfstatcol_t *col)
 	M_DrawPerfString(col, PERF_COUNT);
 }
 
+static void M_DrawPortalStats(void)
+{
+	const boolean hires = M_HighResolution();
+	const INT32 draw_flags = V_MONOSPACE | V_PURPLEMAP;
+	const INT32 x = hires ? 200 : 155;
+	INT32 y = 10;
+	int i;
+
+	if (ps_sw_numportals == 0)
+		return;
+
+	for (i = -1; i < ps_sw_numportals; i++)
+	{
+		const char *text;
+
+		if (i == -1)
+		{
+			text = va("Portals: %d", ps_sw_numportals);
+		}
+		else
+		{
+			const portalstats_t *stats = &ps_sw_portals[i];
+
+			text = va("%s %d: %d (%s)",
+				stats->isskybox ? "Sky" : "Prt", stats->pass,
+				(int)(stats->time / (I_GetPrecisePrecision() / 1000000)),
+				sizeu1(stats->drawsegs));
+		}
+
+		if (hires)
+		{
+			V_DrawSmallString(x, y, draw_flags, text);
+			y += 5;
+		}
+		else
+		{
+			V_DrawThinString(x, y, draw_flags, text);
+			y += 8;
+		}
+	}
+}
+
 static void M_DrawRenderStats(void)
 {
 	const boolean hires = M_HighResolution();
@@ -298,6 +341,7 @@ static void M_DrawRenderStats(void)
 				ps_sw_maskedtime;
 
 			M_DrawPerfTiming(&softwaretime_col);
+			M_DrawPortalStats();
 		}
 	}
 
@@ -615,6 +659,13 @@ void M_DrawPerfStats(void)
 			}
 		}
 	}
+	else if (cv_perfstats.value == PS_PROFILE) // mobj types and thinkers
+	{
+		if (G_GamestateUsesLevel() == false)
+			return;
+
+		PS_DrawProfile();
+	}
 	else if (cv_perfstats.value == PS_THINKFRAME) // lua thinkframe
 	{
 		if (G_GamestateUsesLevel() == false)
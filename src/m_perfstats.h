@@ -28,6 +28,7 @@ typedef enum
 	PS_LOGIC,
 	PS_BOT,
 	PS_THINKFRAME,
+	PS_PROFILE,
 } ps_types_t;
 
 extern precise_t ps_tictime;
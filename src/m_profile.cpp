@@ -0,0 +1,480 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+/// \file m_profile.cpp
+/// \brief Per-mobjtype and per-thinker game logic profiling.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "v_draw.hpp"
+
+#include "command.h"
+#include "d_main.h" // srb2home
+#include "d_netcmd.h" // cv_perfstats
+#include "deh_tables.h" // MOBJTYPE_LIST, FREE_MOBJS
+#include "doomdef.h"
+#include "i_system.h"
+#include "info.h"
+#include "m_perfstats.h"
+#include "m_profile.h"
+#include "p_local.h"
+#include "p_polyobj.h"
+#include "p_slopes.h"
+#include "p_spec.h"
+
+boolean ps_profiling = false;
+
+namespace
+{
+
+// Averages are taken over this many tics
+constexpr int kWindowTics = TICRATE;
+
+// Per-call times: under 1 us, then 1-2 us, 2-4 us, ..., 1 ms and over
+constexpr int kHistogramBuckets = 12;
+
+constexpr int kRowHeight = 4;
+
+struct Stat
+{
+	precise_t time = 0;
+	UINT32 calls = 0;
+	std::array<UINT32, kHistogramBuckets> histogram {};
+};
+
+struct Timer
+{
+	Stat running, avg;
+
+	void add(precise_t t, int bucket)
+	{
+		running.time += t;
+		running.calls++;
+		running.histogram[bucket]++;
+	}
+
+	void roll()
+	{
+		avg = running;
+		running = {};
+	}
+};
+
+precise_t g_ticks_per_us = 1;
+
+std::vector<Timer> g_mobjtypes;
+std::unordered_map<std::uintptr_t, Timer> g_thinkers;
+std::array<Timer, NUMPSCALLS> g_calls;
+
+// Nearly every thinker is P_MobjThinker, so skip the map for runs of the same one
+std::uintptr_t g_last_thinker;
+Timer* g_last_thinker_timer;
+
+int g_tics_counted;
+bool g_invalid = true;
+
+std::FILE* g_log;
+std::string g_log_name;
+UINT32 g_log_window;
+
+#define THINKER(fn) {reinterpret_cast<std::uintptr_t>(fn), #fn}
+
+const std::unordered_map<std::uintptr_t, const char*> kThinkerNames = {
+	THINKER(P_MobjThinker),
+	THINKER(P_RemoveThinkerDelayed),
+	THINKER(T_BounceCheese),
+	THINKER(T_CameraScanner),
+	THINKER(T_ContinuousFalling),
+	THINKER(T_CrushCeiling),
+	THINKER(T_Disappear),
+	THINKER(T_DynamicSlopeLine),
+	THINKER(T_DynamicSlopeVert),
+	THINKER(T_EachTimeThinker),
+	THINKER(T_ExecutorDelay),
+	THINKER(T_Fade),
+	THINKER(T_FadeColormap),
+	THINKER(T_FireFlicker),
+	THINKER(T_FloatSector),
+	THINKER(T_Friction),
+	THINKER(T_Glow),
+	THINKER(T_LaserFlash),
+	THINKER(T_LightFade),
+	THINKER(T_LightningFlash),
+	THINKER(T_MarioBlock),
+	THINKER(T_MarioBlockChecker),
+	THINKER(T_MoveCeiling),
+	THINKER(T_MoveElevator),
+	THINKER(T_MoveFloor),
+	THINKER(T_NoEnemiesSector),
+	THINKER(T_PlaneDisplace),
+	THINKER(T_PolyDoorSlide),
+	THINKER(T_PolyDoorSwing),
+	THINKER(T_PolyObjDisplace),
+	THINKER(T_PolyObjFade),
+	THINKER(T_PolyObjFlag),
+	THINKER(T_PolyObjMove),
+	THINKER(T_PolyObjRotDisplace),
+	THINKER(T_PolyObjRotate),
+	THINKER(T_PolyObjWaypoint),
+	THINKER(T_Pusher),
+	THINKER(T_RaiseSector),
+	THINKER(T_Scroll),
+	THINKER(T_StartCrumble),
+	THINKER(T_StrobeFlash),
+	THINKER(T_ThwompSector),
+};
+
+#undef THINKER
+
+const char* const kCallNames[NUMPSCALLS] = {
+	"P_CheckPosition",
+	"P_TryMove",
+	"P_CheckSight",
+};
+
+int bucket(precise_t t)
+{
+	precise_t us = t / g_ticks_per_us;
+	int b = 0;
+
+	while (us > 0 && b < kHistogramBuckets - 1)
+	{
+		us >>= 1;
+		b++;
+	}
+
+	return b;
+}
+
+std::string mobjtype_name(std::size_t type)
+{
+	if (type < MT_FIRSTFREESLOT)
+	{
+		return MOBJTYPE_LIST[type];
+	}
+
+	if (const char* name = FREE_MOBJS[type - MT_FIRSTFREESLOT])
+	{
+		return fmt::format("MT_{}", name);
+	}
+
+	return fmt::format("MT_{}", type);
+}
+
+std::string thinker_name(std::uintptr_t fn)
+{
+	if (auto it = kThinkerNames.find(fn); it != kThinkerNames.end())
+	{
+		return it->second;
+	}
+
+	return fmt::format("thinker {:#x}", fn);
+}
+
+void reset()
+{
+	g_mobjtypes.assign(NUMMOBJTYPES, {});
+	g_thinkers.clear();
+	g_calls = {};
+
+	g_last_thinker = 0;
+	g_last_thinker_timer = nullptr;
+
+	g_tics_counted = 0;
+	g_invalid = true;
+
+	g_ticks_per_us = std::max<precise_t>(I_GetPrecisePrecision() / 1000000, 1);
+}
+
+void log_timer(const char* category, const std::string& name, const Stat& s)
+{
+	if (s.calls == 0)
+	{
+		return;
+	}
+
+	fmt::print(g_log, "{},{},{},{},{}", g_log_window, category, name, s.calls, s.time / g_ticks_per_us);
+
+	for (UINT32 n : s.histogram)
+	{
+		fmt::print(g_log, ",{}", n);
+	}
+
+	fmt::print(g_log, "\n");
+}
+
+void log_window()
+{
+	for (int i = 0; i < NUMPSCALLS; ++i)
+	{
+		log_timer("call", kCallNames[i], g_calls[i].avg);
+	}
+
+	for (auto& [fn, timer] : g_thinkers)
+	{
+		log_timer("thinker", thinker_name(fn), timer.avg);
+	}
+
+	for (std::size_t i = 0; i < g_mobjtypes.size(); ++i)
+	{
+		log_timer("mobjtype", mobjtype_name(i), g_mobjtypes[i].avg);
+	}
+
+	std::fflush(g_log);
+
+	g_log_window++;
+}
+
+void close_log()
+{
+	if (g_log)
+	{
+		std::fclose(g_log);
+		g_log = nullptr;
+
+		CONS_Printf("Stopped logging profile to %s.\n", g_log_name.c_str());
+	}
+}
+
+}; // namespace
+
+void PS_ResetProfileTic(void)
+{
+	const boolean profiling = (cv_perfstats.value == PS_PROFILE);
+
+	if (profiling != ps_profiling)
+	{
+		ps_profiling = profiling;
+
+		if (ps_profiling)
+		{
+			reset();
+		}
+		else
+		{
+			// Free it all up again
+			g_mobjtypes = {};
+			g_thinkers = {};
+			g_last_thinker_timer = nullptr;
+		}
+	}
+
+	if (!ps_profiling)
+	{
+		return;
+	}
+
+	if (g_tics_counted >= kWindowTics)
+	{
+		for (Timer& timer : g_mobjtypes)
+		{
+			timer.roll();
+		}
+
+		for (auto& [fn, timer] : g_thinkers)
+		{
+			timer.roll();
+		}
+
+		for (Timer& timer : g_calls)
+		{
+			timer.roll();
+		}
+
+		g_tics_counted = 0;
+		g_invalid = false;
+
+		if (g_log)
+		{
+			log_window();
+		}
+	}
+
+	g_tics_counted++;
+}
+
+void PS_ProfileThinker(actionf_p1 func, INT32 mobjtype, precise_t time)
+{
+	const std::uintptr_t fn = reinterpret_cast<std::uintptr_t>(func);
+	const int b = bucket(time);
+
+	if (fn != g_last_thinker || g_last_thinker_timer == nullptr)
+	{
+		g_last_thinker = fn;
+		g_last_thinker_timer = &g_thinkers[fn];
+	}
+
+	g_last_thinker_timer->add(time, b);
+
+	if (mobjtype >= 0 && mobjtype < NUMMOBJTYPES)
+	{
+		g_mobjtypes[mobjtype].add(time, b);
+	}
+}
+
+void PS_ProfileCall(ps_call_t call, precise_t time)
+{
+	g_calls[call].add(time, bucket(time));
+}
+
+void PS_DrawProfile(void)
+{
+	using srb2::Draw;
+
+	constexpr std::size_t kTopThinkers = 8;
+	constexpr std::size_t kTopMobjTypes = 24;
+
+	Draw row = Draw(4, kRowHeight).font(Draw::Font::kConsole).align(Draw::Align::kLeft).scale(0.5).flags(V_MONOSPACE);
+
+	row.flags(V_YELLOWMAP).text("-- AVERAGES PER TIC (over {} tics) --", kWindowTics);
+	row = row.y(kRowHeight);
+
+	if (g_log)
+	{
+		row.flags(V_GRAYMAP).text("Logging to {}", g_log_name);
+		row = row.y(kRowHeight);
+	}
+
+	if (g_invalid)
+	{
+		row.flags(V_GRAYMAP).text("  <Data pending>");
+		return;
+	}
+
+	auto print = [&row](const std::string& name, const Stat& s)
+	{
+		const double us = s.time / static_cast<double>(g_ticks_per_us) / kWindowTics;
+		const double calls = s.calls / static_cast<double>(kWindowTics);
+
+		// Upper bound of the slowest bucket anything landed in
+		int worst = kHistogramBuckets - 1;
+		while (worst > 0 && s.histogram[worst] == 0)
+		{
+			worst--;
+		}
+
+		std::string slowest = worst == kHistogramBuckets - 1 ?
+			fmt::format(">{}", 1 << (worst - 1)) : fmt::format("<{}", 1 << worst);
+
+		row.flags(us >= 100.0 ? V_YELLOWMAP : us < 10.0 ? V_GRAYMAP : 0).text(
+			"{:>8.2f} us {:>8.2f} calls {:>6} us max - {}",
+			us,
+			calls,
+			slowest,
+			name
+		);
+
+		row = row.y(kRowHeight);
+	};
+
+	auto top = [&print](auto& timers, std::size_t n, auto name_of)
+	{
+		std::vector<std::pair<precise_t, std::size_t>> view;
+
+		for (std::size_t i = 0; i < timers.size(); ++i)
+		{
+			if (timers[i].second->avg.calls > 0)
+			{
+				view.emplace_back(timers[i].second->avg.time, i);
+			}
+		}
+
+		n = std::min(n, view.size());
+		std::partial_sort(view.begin(), view.begin() + n, view.end(), std::greater<>());
+
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			auto& [key, timer] = timers[view[i].second];
+			print(name_of(key), timer->avg);
+		}
+	};
+
+	row.flags(V_BLUEMAP).text("Calls (inclusive):");
+	row = row.y(kRowHeight);
+
+	for (int i = 0; i < NUMPSCALLS; ++i)
+	{
+		print(kCallNames[i], g_calls[i].avg);
+	}
+
+	row = row.y(kRowHeight);
+	row.flags(V_BLUEMAP).text("Thinkers:");
+	row = row.y(kRowHeight);
+
+	{
+		std::vector<std::pair<std::uintptr_t, const Timer*>> thinkers;
+		thinkers.reserve(g_thinkers.size());
+
+		for (auto& [fn, timer] : g_thinkers)
+		{
+			thinkers.emplace_back(fn, &timer);
+		}
+
+		top(thinkers, kTopThinkers, thinker_name);
+	}
+
+	row = row.y(kRowHeight);
+	row.flags(V_BLUEMAP).text("Mobj types:");
+	row = row.y(kRowHeight);
+
+	{
+		std::vector<std::pair<std::size_t, const Timer*>> mobjtypes;
+		mobjtypes.reserve(g_mobjtypes.size());
+
+		for (std::size_t i = 0; i < g_mobjtypes.size(); ++i)
+		{
+			mobjtypes.emplace_back(i, &g_mobjtypes[i]);
+		}
+
+		top(mobjtypes, kTopMobjTypes, mobjtype_name);
+	}
+}
+
+void Command_ProfileLog_f(void)
+{
+	close_log();
+
+	if (COM_Argc() < 2)
+	{
+		return;
+	}
+
+	g_log_name = fmt::format("{}" PATHSEP "{}", srb2home, COM_Argv(1));
+	g_log = std::fopen(g_log_name.c_str(), "a");
+
+	if (g_log == nullptr)
+	{
+		CONS_Alert(CONS_ERROR, "Couldn't open %s for writing.\n", g_log_name.c_str());
+		return;
+	}
+
+	g_log_window = 0;
+
+	fmt::print(g_log, "window,category,name,calls,time_us");
+
+	for (int i = 0; i < kHistogramBuckets - 1; ++i)
+	{
+		fmt::print(g_log, ",under_{}us", 1 << i);
+	}
+
+	fmt::print(g_log, ",over_{}us", 1 << (kHistogramBuckets - 2));
+
+	fmt::print(g_log, "\n");
+
+	CONS_Printf("Logging profile to %s every %d tics. Set perfstats to Profile to start.\n", g_log_name.c_str(), kWindowTics);
+}
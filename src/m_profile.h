@@ -0,0 +1,52 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+/// \file m_profile.h
+/// \brief Per-mobjtype and per-thinker game logic profiling.
+
+#ifndef __M_PROFILE_H__
+#define __M_PROFILE_H__
+
+#include "doomtype.h"
+#include "d_think.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Hot functions timed on their own, inclusive of anything they call.
+typedef enum
+{
+	PS_CALL_CHECKPOSITION,
+	PS_CALL_TRYMOVE,
+	PS_CALL_CHECKSIGHT,
+	NUMPSCALLS
+} ps_call_t;
+
+// True while the "Profile" perfstats page is up.
+// Check this before reading the clock for any of the below.
+extern boolean ps_profiling;
+
+// Call at the start of every tic. Turns profiling on and off
+// with the perfstats page, and rolls over the averages.
+void PS_ResetProfileTic(void);
+
+// mobjtype is -1 for thinkers that aren't mobjs.
+void PS_ProfileThinker(actionf_p1 func, INT32 mobjtype, precise_t time);
+void PS_ProfileCall(ps_call_t call, precise_t time);
+
+void PS_DrawProfile(void);
+
+// profilelog [file]: append every average to a CSV file in srb2home
+void Command_ProfileLog_f(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif/*__M_PROFILE_H__*/
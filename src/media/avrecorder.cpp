@@ -14,6 +14,7 @@
 #include <iterator>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <utility>
 
@@ -32,12 +33,20 @@ namespace
 
 constexpr auto kBufferMethod = VideoFrame::BufferMethod::kEncoderAllocatedRGBA8888;
 
+std::size_t conversion_threads()
+{
+	// Conversion is memory bound, so a few threads are enough
+	return std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+}
+
 }; // namespace
 
 Impl::Impl(Config cfg) :
 	max_size_(cfg.max_size),
 	max_duration_(cfg.max_duration),
 
+	bands_(conversion_threads()),
+
 	container_(std::make_unique<WebmContainer>(MediaContainer::Config {
 		cfg.file_name,
 		[this](const MediaContainer& container) { container_dtor_handler(container); },
@@ -64,7 +73,7 @@ std::unique_ptr<AudioEncoder> Impl::make_audio_encoder(const Config cfg) const
 	return container_->make_audio_encoder({2, a.sample_rate});
 }
 
-std::unique_ptr<VideoEncoder> Impl::make_video_encoder(const Config cfg) const
+std::unique_ptr<VideoEncoder> Impl::make_video_encoder(const Config cfg)
 {
 	if (!cfg.video)
 	{
@@ -73,15 +82,27 @@ std::unique_ptr<VideoEncoder> Impl::make_video_encoder(const Config cfg) const
 
 	const Config::Video& v = *cfg.video;
 
-	return container_->make_video_encoder({v.width, v.height, v.frame_rate, kBufferMethod});
+	return container_->make_video_encoder({v.width, v.height, v.frame_rate, kBufferMethod, &bands_});
 }
 
 Impl::~Impl()
 {
-	valid_ = false;
+	{
+		auto _ = queue_guard();
+		valid_ = false;
+	}
+
 	wake_up_worker();
 	thread_.join();
 
+	// Drop any frames the worker didn't get to
+	frame_pool_->close();
+
+	while (std::optional<StagingVideoFrame*> p = video_frames_.steal())
+	{
+		delete *p;
+	}
+
 	try
 	{
 		// Finally flush encoders, unless queues were finished
@@ -113,7 +134,7 @@ std::optional<int> Impl::advance_video_pts()
 	// spend longer than one frame rate on a single
 	// frame. It should normalize though.
 
-	if (video_queue_.vec_.size() >= 3)
+	if (video_frames_.size() >= kMaxQueuedVideoFrames)
 	{
 		return {};
 	}
@@ -152,7 +173,15 @@ void Impl::worker()
 		{
 			std::unique_lock lock(queue_mutex_);
 
-			queue_cond_.wait(lock);
+			// Video frames are pushed without the lock, so
+			// look again now that it's held before sleeping.
+			const bool idle = valid_ && video_frames_.empty() && audio_queue_.vec_.empty() &&
+				!(audio_queue_.finished() && video_queue_.finished());
+
+			if (idle)
+			{
+				queue_cond_.wait(lock);
+			}
 		}
 		else
 		{
@@ -34,6 +34,7 @@ public:
 	using audio_buffer_t = tcb::span<const audio_sample_t>;
 
 	class Impl;
+	class FramePool;
 
 	struct Config
 	{
@@ -61,12 +62,24 @@ public:
 	// TODO: remove once hwr2 twodee is finished
 	struct StagingVideoFrame
 	{
-		using instance_t = std::unique_ptr<StagingVideoFrame>;
+		// Hands the frame back to the pool it came from,
+		// or frees it if that pool is gone.
+		struct Recycler
+		{
+			std::weak_ptr<FramePool> pool;
+
+			void operator()(StagingVideoFrame* frame) const;
+		};
+
+		using instance_t = std::unique_ptr<StagingVideoFrame, Recycler>;
 
 		std::vector<uint8_t> screen;
 		uint32_t width, height;
 		int pts;
 
+		// When the frame was pushed, for latency statistics.
+		std::chrono::steady_clock::time_point queued_at;
+
 		StagingVideoFrame(uint32_t width_, uint32_t height_, int pts_) :
 			screen(width_ * height_ * 3), width(width_), height(height_), pts(pts_)
 		{
@@ -86,12 +86,13 @@ void AVRecorder::print_configuration() const
 		const auto& v = *impl_->video_encoder_;
 
 		CONS_Printf(
-			"Video: %s %dx%d %d fps %d threads\n",
+			"Video: %s %dx%d %d fps %d threads (%d for conversion)\n",
 			v.name(),
 			v.width(),
 			v.height(),
 			v.frame_rate(),
-			v.thread_count()
+			v.thread_count(),
+			static_cast<int>(impl_->bands_.threads())
 		);
 	}
 }
@@ -147,4 +148,21 @@ void AVRecorder::draw_statistics() const
 	draw(200, fmt::format("{:.0f}", fps), fps_color);
 	draw(230, fmt::format("{:.1f}s", impl_->container_->duration().count()));
 	draw(260, fmt::format("{:.1f} MB", size / kMb), mb_color);
+
+	// Frames waiting, then how long each stage of the
+	// pipeline takes per frame
+	const auto& lat = impl_->video_latency_;
+
+	V_DrawThinString(
+		200,
+		182,
+		V_SNAPTOBOTTOM | V_SNAPTORIGHT,
+		fmt::format(
+			"q{} {:.1f}/{:.1f}/{:.1f} ms",
+			impl_->video_queue_depth(),
+			lat.queue.load(),
+			lat.convert.load(),
+			lat.encode.load()
+		).c_str()
+	);
 }
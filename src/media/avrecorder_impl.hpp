@@ -21,9 +21,12 @@
 #include <thread>
 #include <vector>
 
+#include "../core/spmc_queue.hpp"
 #include "../i_time.h"
 #include "avrecorder.hpp"
+#include "band_pool.hpp"
 #include "container.hpp"
+#include "frame_pool.hpp"
 
 namespace srb2::media
 {
@@ -90,6 +93,15 @@ public:
 		time_unit_t time_scale() const;
 	};
 
+	// Milliseconds a video frame spends in each stage,
+	// smoothed over the last several frames.
+	struct StageLatency
+	{
+		std::atomic<float> queue = 0.f;	  // waiting for the worker
+		std::atomic<float> convert = 0.f; // RGB to RGBA
+		std::atomic<float> encode = 0.f;  // scaling, YUV and VP8
+	};
+
 	const std::optional<std::size_t> max_size_;
 	std::optional<std::chrono::duration<float>> max_duration_;
 
@@ -98,6 +110,9 @@ public:
 	// the original, unmodified value.
 	const decltype(max_duration_) max_duration_config_ = max_duration_;
 
+	// Declared before the encoders, which borrow it.
+	BandPool bands_;
+
 	std::unique_ptr<MediaContainer> container_;
 	std::unique_ptr<AudioEncoder> audio_encoder_;
 	std::unique_ptr<VideoEncoder> video_encoder_;
@@ -105,6 +120,23 @@ public:
 	Queue<AudioEncoder> audio_queue_ {audio_encoder_, *this};
 	Queue<VideoEncoder> video_queue_ {video_encoder_, *this};
 
+	// Staging frames travel from the game thread to the
+	// worker through here without taking queue_mutex_, so
+	// the game never waits for a frame to finish encoding.
+	// Only the game thread pushes; the worker steals, which
+	// takes frames in the order they were pushed.
+	srb2::SpMcQueue<StagingVideoFrame*> video_frames_ {8};
+
+	// Frames waiting in video_frames_ before new ones are
+	// dropped instead.
+	static constexpr std::size_t kMaxQueuedVideoFrames = 3;
+
+	// Enough frames for a full queue, plus the one being
+	// converted and the one the game is filling in.
+	const std::shared_ptr<FramePool> frame_pool_ = std::make_shared<FramePool>(kMaxQueuedVideoFrames + 2);
+
+	StageLatency video_latency_;
+
 	// This class becomes invalid if:
 	//
 	// 1) an exception occurred
@@ -126,6 +158,9 @@ public:
 	// Use to notify worker thread if queues were modified.
 	void wake_up_worker() { queue_cond_.notify_one(); }
 
+	// Number of video frames waiting for the worker.
+	std::size_t video_queue_depth() const { return video_frames_.size(); }
+
 private:
 	enum class QueueState
 	{
@@ -143,9 +178,10 @@ private:
 	std::condition_variable_any queue_cond_;
 
 	std::unique_ptr<AudioEncoder> make_audio_encoder(const Config cfg) const;
-	std::unique_ptr<VideoEncoder> make_video_encoder(const Config cfg) const;
+	std::unique_ptr<VideoEncoder> make_video_encoder(const Config cfg);
 
 	QueueState encode_queues();
+	bool encode_video_frames();
 	void update_video_frame_rate_avg();
 
 	void worker();
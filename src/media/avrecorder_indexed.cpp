@@ -10,11 +10,14 @@
 
 // TODO: remove this file once hwr2 twodee is finished
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
 
+#include <libyuv/convert_argb.h>
+
 #include "../cxxutil.hpp"
 #include "avrecorder_impl.hpp"
 
@@ -29,24 +32,27 @@ VideoFrame::instance_t Impl::convert_staging_video_frame(const StagingVideoFrame
 	SRB2_ASSERT(frame != nullptr);
 
 	const VideoFrame::Buffer& buffer = frame->rgba_buffer();
-
-	const uint8_t* s = staging.screen.data();
-	uint8_t* p = buffer.plane.data();
-
-	// Convert from RGB8 to RGBA8
-	for (int y = 0; y < frame->height(); ++y)
-	{
-		for (int x = 0; x < frame->width(); ++x)
+	const int width = frame->width();
+	const int stride = staging.width * 3;
+
+	// Convert from RGB8 to RGBA8. libyuv's RGB24 is BGR in
+	// memory and its ARGB is BGRA, so this only appends an
+	// opaque alpha to every pixel and keeps channel order.
+	bands_.run(
+		frame->height(),
+		1,
+		[&](int y, int rows)
 		{
-			p[x * 4] = s[x * 3];
-			p[x * 4 + 1] = s[x * 3 + 1];
-			p[x * 4 + 2] = s[x * 3 + 2];
-			p[x * 4 + 3] = 255;
+			libyuv::RGB24ToARGB(
+				staging.screen.data() + (y * stride),
+				stride,
+				buffer.plane.data() + (y * buffer.row_stride),
+				buffer.row_stride,
+				width,
+				rows
+			);
 		}
-
-		s += staging.width * 3;
-		p += buffer.row_stride;
-	}
+	);
 
 	return frame;
 }
@@ -60,13 +66,21 @@ AVRecorder::StagingVideoFrame::instance_t AVRecorder::new_staging_video_frame(ui
 		return nullptr;
 	}
 
-	return std::make_unique<StagingVideoFrame>(width, height, *pts);
+	return impl_->frame_pool_->acquire(width, height, *pts);
 }
 
 void AVRecorder::push_staging_video_frame(StagingVideoFrame::instance_t frame)
 {
-	auto _ = impl_->queue_guard();
+	frame->queued_at = std::chrono::steady_clock::now();
+
+	impl_->video_frames_.push(frame.release());
+
+	{
+		// The worker checks for frames under this lock
+		// before it sleeps, so taking it here means it has
+		// either seen this frame or is asleep to be woken.
+		auto _ = impl_->queue_guard();
+	}
 
-	impl_->video_queue_.vec_.emplace_back(std::move(frame));
 	impl_->wake_up_worker();
 }
@@ -11,6 +11,7 @@
 #include <chrono>
 #include <cstddef>
 #include <mutex>
+#include <optional>
 #include <utility>
 
 #include "avrecorder_impl.hpp"
@@ -55,6 +56,10 @@ bool Impl::Queue<T>::advance(int new_pts, int duration)
 			impl_->max_duration_ = t;
 		}
 
+		// No more frames will be recorded, so the pooled
+		// ones are only taking up memory now.
+		impl_->frame_pool_->close();
+
 		impl_->wake_up_worker();
 	};
 
@@ -122,20 +127,22 @@ Impl::QueueState Impl::encode_queues()
 	};
 
 	auto encode_audio = [this](auto copy) { audio_encoder_->encode(copy); };
-	auto encode_video = [this](auto copy)
-	{
-		for (auto& p : copy)
-		{
-			auto frame = convert_staging_video_frame(*p);
 
-			video_encoder_->encode(std::move(frame));
-		}
+	check(audio_queue_, encode_audio);
 
-		update_video_frame_rate_avg();
-	};
+	if (encode_video_frames())
+	{
+		flushed = true;
+	}
 
-	check(audio_queue_, encode_audio);
-	check(video_queue_, encode_video);
+	{
+		const auto _ = queue_guard();
+
+		if (!video_queue_.finished() || !video_frames_.empty())
+		{
+			remain = true;
+		}
+	}
 
 	if (flushed)
 	{
@@ -151,6 +158,48 @@ Impl::QueueState Impl::encode_queues()
 	}
 }
 
+bool Impl::encode_video_frames()
+{
+	using clock = std::chrono::steady_clock;
+	using ms = std::chrono::duration<float, std::milli>;
+
+	auto smooth = [](std::atomic<float>& avg, ms t) { avg = (avg * 0.9f) + (t.count() * 0.1f); };
+
+	bool encoded = false;
+
+	while (std::optional<StagingVideoFrame*> p = video_frames_.steal())
+	{
+		const StagingVideoFrame::instance_t staging(*p, {frame_pool_});
+
+		const auto t0 = clock::now();
+		auto frame = convert_staging_video_frame(*staging);
+
+		const auto t1 = clock::now();
+		video_encoder_->encode(std::move(frame));
+
+		const auto t2 = clock::now();
+
+		smooth(video_latency_.queue, t0 - staging->queued_at);
+		smooth(video_latency_.convert, t1 - t0);
+		smooth(video_latency_.encode, t2 - t1);
+
+		{
+			const auto _ = queue_guard();
+
+			video_queue_.queued_frames_--;
+		}
+
+		encoded = true;
+	}
+
+	if (encoded)
+	{
+		update_video_frame_rate_avg();
+	}
+
+	return encoded;
+}
+
 void Impl::update_video_frame_rate_avg()
 {
 	constexpr auto period = std::chrono::duration<float>(1.f);
@@ -0,0 +1,32 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+
+#include <cstddef>
+#include <memory>
+
+#include "band_pool.hpp"
+
+using namespace srb2::media;
+
+BandPool::BandPool(std::size_t threads) : threads_(std::max<std::size_t>(threads, 1))
+{
+	// With one thread, bands just run on the calling thread
+	if (threads_ > 1)
+	{
+		pool_ = std::make_unique<srb2::ThreadPool>(threads_);
+	}
+}
+
+BandPool::~BandPool()
+{
+	if (pool_ != nullptr)
+	{
+		pool_->shutdown();
+	}
+}
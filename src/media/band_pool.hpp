@@ -0,0 +1,76 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+
+#ifndef __SRB2_MEDIA_BAND_POOL_HPP__
+#define __SRB2_MEDIA_BAND_POOL_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+#include "../core/thread_pool.h"
+
+namespace srb2::media
+{
+
+// Splits image processing into horizontal bands and runs
+// them on a thread pool of its own. The recorder's worker
+// thread is the only thread that may use an instance.
+class BandPool
+{
+public:
+	explicit BandPool(std::size_t threads);
+	~BandPool();
+
+	// Calls f(first_row, row_count) for bands covering rows
+	// [0, height) and returns once all of them are done.
+	// Every band but the last is a multiple of row_align
+	// rows, for chroma subsampling.
+	template <typename F>
+	void run(int height, int row_align, const F& f);
+
+	std::size_t threads() const { return threads_; }
+
+private:
+	const std::size_t threads_;
+	std::unique_ptr<srb2::ThreadPool> pool_;
+};
+
+template <typename F>
+void BandPool::run(int height, int row_align, const F& f)
+{
+	const int bands = static_cast<int>(threads_);
+
+	if (pool_ == nullptr || height < bands * row_align)
+	{
+		f(0, height);
+		return;
+	}
+
+	int rows = (height + bands - 1) / bands;
+	rows += (row_align - (rows % row_align)) % row_align;
+
+	pool_->begin_sema();
+
+	for (int y = 0; y < height; y += rows)
+	{
+		const int n = std::min(rows, height - y);
+
+		pool_->schedule([&f, y, n] { f(y, n); });
+	}
+
+	srb2::ThreadPool::Sema sema = pool_->end_sema();
+
+	pool_->notify_sema(sema);
+	pool_->wait_sema(sema);
+}
+
+}; // namespace srb2::media
+
+#endif // __SRB2_MEDIA_BAND_POOL_HPP__
@@ -0,0 +1,102 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "frame_pool.hpp"
+
+using namespace srb2::media;
+
+using FramePool = AVRecorder::FramePool;
+using StagingVideoFrame = AVRecorder::StagingVideoFrame;
+
+void StagingVideoFrame::Recycler::operator()(StagingVideoFrame* frame) const
+{
+	if (std::shared_ptr<FramePool> p = pool.lock())
+	{
+		p->release(frame);
+	}
+	else
+	{
+		delete frame;
+	}
+}
+
+FramePool::FramePool(std::size_t capacity) : capacity_(capacity)
+{
+	free_.reserve(capacity);
+}
+
+StagingVideoFrame::instance_t FramePool::acquire(uint32_t width, uint32_t height, int pts)
+{
+	const std::size_t size = width * height * 3;
+
+	std::unique_ptr<StagingVideoFrame> frame;
+
+	{
+		std::lock_guard _(mutex_);
+
+		// Prefer a frame that already has room, so changing
+		// resolution doesn't reallocate every buffer.
+		for (auto it = free_.begin(); it != free_.end(); ++it)
+		{
+			if ((*it)->screen.capacity() >= size)
+			{
+				frame = std::move(*it);
+				free_.erase(it);
+				break;
+			}
+		}
+
+		if (frame == nullptr && !free_.empty())
+		{
+			frame = std::move(free_.back());
+			free_.pop_back();
+		}
+	}
+
+	if (frame == nullptr)
+	{
+		frame = std::make_unique<StagingVideoFrame>(width, height, pts);
+	}
+	else
+	{
+		frame->screen.resize(size);
+		frame->width = width;
+		frame->height = height;
+		frame->pts = pts;
+	}
+
+	return StagingVideoFrame::instance_t(frame.release(), {weak_from_this()});
+}
+
+void FramePool::release(StagingVideoFrame* frame)
+{
+	std::unique_ptr<StagingVideoFrame> p(frame);
+
+	std::lock_guard _(mutex_);
+
+	if (!closed_ && free_.size() < capacity_)
+	{
+		free_.emplace_back(std::move(p));
+	}
+}
+
+void FramePool::close()
+{
+	std::lock_guard _(mutex_);
+
+	closed_ = true;
+	free_.clear();
+}
+
@@ -0,0 +1,55 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+
+#ifndef __SRB2_MEDIA_FRAME_POOL_HPP__
+#define __SRB2_MEDIA_FRAME_POOL_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "avrecorder.hpp"
+
+namespace srb2::media
+{
+
+// Keeps staging frames around after they are encoded, so
+// recording at a steady resolution reuses the same few
+// screen buffers instead of allocating one per frame.
+class AVRecorder::FramePool : public std::enable_shared_from_this<AVRecorder::FramePool>
+{
+public:
+	// At most capacity frames are kept for reuse.
+	explicit FramePool(std::size_t capacity);
+
+	// Returns a recycled frame if one is free, resized to
+	// width x height. The screen buffer is not cleared.
+	StagingVideoFrame::instance_t acquire(uint32_t width, uint32_t height, int pts);
+
+	// Takes a frame back for reuse, or frees it if the pool
+	// is full or closed.
+	void release(StagingVideoFrame* frame);
+
+	// Frees every kept frame and stops keeping any more,
+	// once no more frames will be recorded.
+	void close();
+
+private:
+	const std::size_t capacity_;
+
+	std::mutex mutex_;
+	std::vector<std::unique_ptr<StagingVideoFrame>> free_;
+	bool closed_ = false;
+};
+
+}; // namespace srb2::media
+
+#endif // __SRB2_MEDIA_FRAME_POOL_HPP__
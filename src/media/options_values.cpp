@@ -53,7 +53,11 @@ const Options VP8Encoder::options_("vp8", {
 		{"infinite", static_cast<int>(DeadlineOption::kInfinite)},
 	})},
 	{"sharpness", Options::values<int>("7", {0, 7})},
-	{"token_parts", Options::values<int>("0", {0, 3})},
-	{"threads", Options::values<int>("1", {1})},
+	{"token_parts", Options::values<int>("auto", {0, 3}, {
+		{"auto", static_cast<int>(TokenPartsOption::kAuto)},
+	})},
+	{"threads", Options::values<int>("auto", {1}, {
+		{"auto", static_cast<int>(ThreadsOption::kAuto)},
+	})},
 });
 // clang-format on
@@ -11,6 +11,7 @@
 #ifndef __SRB2_MEDIA_VIDEO_ENCODER_HPP__
 #define __SRB2_MEDIA_VIDEO_ENCODER_HPP__
 
+#include "band_pool.hpp"
 #include "encoder.hpp"
 #include "video_frame.hpp"
 
@@ -26,6 +27,10 @@ public:
 		int height;
 		int frame_rate;
 		VideoFrame::BufferMethod buffer_method;
+
+		// Threads for scaling and colour conversion. May be
+		// null, then all of it happens on the encoding thread.
+		BandPool* bands = nullptr;
 	};
 
 	struct FrameCount
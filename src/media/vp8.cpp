@@ -8,12 +8,14 @@
 // See the 'LICENSE' file for more details.
 //-----------------------------------------------------------------------------
 
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
+#include <thread>
 
 #include <fmt/format.h>
 #include <tcb/span.hpp>
@@ -27,12 +29,26 @@ using namespace srb2::media;
 
 vpx_codec_iface_t* VP8Encoder::kCodec = vpx_codec_vp8_cx();
 
+int VP8Encoder::configured_threads()
+{
+	const int threads = options_.get<int>("threads");
+
+	if (threads == static_cast<int>(ThreadsOption::kAuto))
+	{
+		// libvpx splits VP8 encoding by macroblock rows and
+		// doesn't gain much past a handful of threads
+		return std::clamp(static_cast<int>(std::thread::hardware_concurrency()) / 2, 1, 8);
+	}
+
+	return threads;
+}
+
 const vpx_codec_enc_cfg_t VP8Encoder::configure(const Config user)
 {
 	vpx_codec_enc_cfg_t cfg;
 	vpx_codec_enc_config_default(kCodec, &cfg, 0);
 
-	cfg.g_threads = options_.get<int>("threads");
+	cfg.g_threads = configured_threads();
 
 	cfg.g_w = user.width;
 	cfg.g_h = user.height;
@@ -68,14 +84,28 @@ const vpx_codec_enc_cfg_t VP8Encoder::configure(const Config user)
 	return cfg;
 }
 
-VP8Encoder::VP8Encoder(Config config) : ctx_(config), img_(config.width, config.height), frame_rate_(config.frame_rate)
+VP8Encoder::VP8Encoder(Config config) :
+	ctx_(config), img_(config.width, config.height), frame_rate_(config.frame_rate), bands_(config.bands)
 {
 	SRB2_ASSERT(config.buffer_method == VideoFrame::BufferMethod::kEncoderAllocatedRGBA8888);
 
 	control<int>(VP8E_SET_CPUUSED, "cpu_used");
 	control<int>(VP8E_SET_CQ_LEVEL, "cq_level");
 	control<int>(VP8E_SET_SHARPNESS, "sharpness");
-	control<int>(VP8E_SET_TOKEN_PARTITIONS, "token_parts");
+
+	int token_parts = options_.get<int>("token_parts");
+
+	if (token_parts == static_cast<int>(TokenPartsOption::kAuto))
+	{
+		// One partition per thread lets every thread pack
+		// its own rows' tokens (log2, up to 8 partitions)
+		token_parts = (thread_count_ >= 8) ? 3 : (thread_count_ >= 4) ? 2 : (thread_count_ >= 2) ? 1 : 0;
+	}
+
+	if (vpx_codec_control_(ctx_, VP8E_SET_TOKEN_PARTITIONS, token_parts) != VPX_CODEC_OK)
+	{
+		throw std::invalid_argument(fmt::format("vpx_codec_control: {}, token_parts={}", VpxError(ctx_), token_parts));
+	}
 
 	auto plane = [this](int k, int ycs = 0)
 	{
@@ -159,14 +189,14 @@ void VP8Encoder::encode(VideoFrame::instance_t frame)
 	if (frame_->width() != width() || frame_->height() != height())
 	{
 		rgba_scaled_buffer_.resize(width(), height());
-		frame_->scale(rgba_scaled_buffer_);
+		frame_->scale(rgba_scaled_buffer_, bands_);
 	}
 	else
 	{
 		rgba_scaled_buffer_.release();
 	}
 
-	frame_->convert();
+	frame_->convert(bands_);
 
 	if (vpx_codec_encode(ctx_, img_, frame_->pts(), 1, 0, deadline_) != VPX_CODEC_OK)
 	{
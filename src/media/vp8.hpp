@@ -80,17 +80,30 @@ private:
 	    kInfinite = 0,
 	};
 
+	enum class ThreadsOption : int
+	{
+	    kAuto = 0,
+	};
+
+	enum class TokenPartsOption : int
+	{
+	    kAuto = -1,
+	};
+
 	static vpx_codec_iface_t* kCodec;
 
 	static const vpx_codec_enc_cfg_t configure(const Config config);
+	static int configured_threads();
 
 	CtxWrapper ctx_;
 	ImgWrapper img_;
 
 	const int frame_rate_;
-	const int thread_count_ = options_.get<int>("threads");
+	const int thread_count_ = configured_threads();
 	const int deadline_ = options_.get<int>("deadline");
 
+	BandPool* const bands_;
+
 	mutable std::recursive_mutex frame_count_mutex_;
 
 	int duration_ = 0;
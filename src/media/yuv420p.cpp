@@ -80,24 +80,52 @@ const VideoFrame::Buffer& YUV420pFrame::rgba_buffer() const
 	return *rgba_;
 }
 
-void YUV420pFrame::convert() const
+namespace
 {
-	// ABGR = RGBA in memory
-	libyuv::ABGRToI420(
-		rgba_->plane.data(),
-		rgba_->row_stride,
-		y_.plane.data(),
-		y_.row_stride,
-		u_.plane.data(),
-		u_.row_stride,
-		v_.plane.data(),
-		v_.row_stride,
-		width(),
-		height()
+
+template <typename F>
+void run_bands(BandPool* bands, int height, int row_align, const F& f)
+{
+	if (bands != nullptr)
+	{
+		bands->run(height, row_align, f);
+	}
+	else
+	{
+		f(0, height);
+	}
+}
+
+}; // namespace
+
+void YUV420pFrame::convert(BandPool* bands) const
+{
+	// Each band covers an even number of rows, so that it
+	// owns whole rows of the half height U and V planes.
+	run_bands(
+		bands,
+		height(),
+		2,
+		[this](int y, int rows)
+		{
+			// ABGR = RGBA in memory
+			libyuv::ABGRToI420(
+				rgba_->plane.data() + (y * rgba_->row_stride),
+				rgba_->row_stride,
+				y_.plane.data() + (y * y_.row_stride),
+				y_.row_stride,
+				u_.plane.data() + ((y / 2) * u_.row_stride),
+				u_.row_stride,
+				v_.plane.data() + ((y / 2) * v_.row_stride),
+				v_.row_stride,
+				width(),
+				rows
+			);
+		}
 	);
 }
 
-void YUV420pFrame::scale(const BufferRGBA& scaled_rgba)
+void YUV420pFrame::scale(const BufferRGBA& scaled_rgba, BandPool* bands)
 {
 	int vw = scaled_rgba.width();
 	int vh = scaled_rgba.height();
@@ -121,17 +149,30 @@ void YUV420pFrame::scale(const BufferRGBA& scaled_rgba)
 		p += (scaled_rgba.height() - vh) / 2 * scaled_rgba.row_stride;
 	}
 
-	// Curiously, this function doesn't care about channel order.
-	libyuv::ARGBScale(
-		rgba_->plane.data(),
-		rgba_->row_stride,
-		width(),
-		height(),
-		p,
-		scaled_rgba.row_stride,
-		vw,
+	// Each band scales into its own rows of the destination.
+	run_bands(
+		bands,
 		vh,
-		libyuv::FilterMode::kFilterNone
+		1,
+		[&](int y, int rows)
+		{
+			// Curiously, this function doesn't care about channel order.
+			libyuv::ARGBScaleClip(
+				rgba_->plane.data(),
+				rgba_->row_stride,
+				width(),
+				height(),
+				p,
+				scaled_rgba.row_stride,
+				vw,
+				vh,
+				0,
+				y,
+				vw,
+				rows,
+				libyuv::FilterMode::kFilterNone
+			);
+		}
 	);
 
 	rgba_ = &scaled_rgba;
@@ -14,6 +14,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "band_pool.hpp"
 #include "video_frame.hpp"
 
 namespace srb2::media
@@ -51,12 +52,13 @@ public:
 	// buffers intact.
 	void reset(int pts, const BufferRGBA& rgba) { *this = YUV420pFrame(pts, y_, u_, v_, rgba); }
 
-	// Converts RGBA buffer to YUV planes.
-	void convert() const;
+	// Converts RGBA buffer to YUV planes. If bands is not
+	// null, the conversion is split across its threads.
+	void convert(BandPool* bands = nullptr) const;
 
 	// Scales the existing buffer into a new one. This new
 	// buffer replaces the existing one.
-	void scale(const BufferRGBA& rgba);
+	void scale(const BufferRGBA& rgba, BandPool* bands = nullptr);
 
 	virtual int width() const override { return rgba_->width(); }
 	virtual int height() const override { return rgba_->height(); }
@@ -45,6 +45,7 @@
 #include "lua_hook.h"
 
 #include "m_perfstats.h" // ps_checkposition_calls
+#include "m_profile.h"
 
 tm_t g_tm = {0};
 
@@ -2025,7 +2026,7 @@ static BlockItReturn_t PIT_CheckLine(line_t *ld)
 // g_tm.ceilingz
 //     the nearest ceiling or thing's bottom over g_tm.thing
 //
-boolean P_CheckPosition(mobj_t *thing, fixed_t x, fixed_t y, TryMoveResult_t *result)
+static boolean P_CheckPositionUntimed(mobj_t *thing, fixed_t x, fixed_t y, TryMoveResult_t *result)
 {
 	INT32 thingtop = thing->z + thing->height;
 	INT32 xl, xh, yl, yh, bx, by;
@@ -2354,6 +2355,21 @@ boolean P_CheckPosition(mobj_t *thing, fixed_t x, fixed_t y, TryMoveResult_t *re
 	return blockval;
 }
 
+boolean P_CheckPosition(mobj_t *thing, fixed_t x, fixed_t y, TryMoveResult_t *result)
+{
+	precise_t start;
+	boolean ret;
+
+	if (!ps_profiling)
+		return P_CheckPositionUntimed(thing, x, y, result);
+
+	start = I_GetPreciseTime();
+	ret = P_CheckPositionUntimed(thing, x, y, result);
+	PS_ProfileCall(PS_CALL_CHECKPOSITION, I_GetPreciseTime() - start);
+
+	return ret;
+}
+
 static const fixed_t hoopblockdist = 16*FRACUNIT + 8*FRACUNIT;
 static const fixed_t hoophalfheight = (56*FRACUNIT)/2;
 
@@ -2984,7 +3000,7 @@ boolean P_CheckMove(mobj_t *thing, fixed_t x, fixed_t y, boolean allowdropoff, T
 // P_TryMove
 // Attempt to move to a new position.
 //
-boolean P_TryMove(mobj_t *thing, fixed_t x, fixed_t y, boolean allowdropoff, TryMoveResult_t *result)
+static boolean P_TryMoveUntimed(mobj_t *thing, fixed_t x, fixed_t y, boolean allowdropoff, TryMoveResult_t *result)
 {
 	fixed_t oldx = thing->x;
 	fixed_t oldy = thing->y;
@@ -3189,6 +3205,21 @@ boolean P_TryMove(mobj_t *thing, fixed_t x, fixed_t y, boolean allowdropoff, Try
 	return true;
 }
 
+boolean P_TryMove(mobj_t *thing, fixed_t x, fixed_t y, boolean allowdropoff, TryMoveResult_t *result)
+{
+	precise_t start;
+	boolean ret;
+
+	if (!ps_profiling)
+		return P_TryMoveUntimed(thing, x, y, allowdropoff, result);
+
+	start = I_GetPreciseTime();
+	ret = P_TryMoveUntimed(thing, x, y, allowdropoff, result);
+	PS_ProfileCall(PS_CALL_TRYMOVE, I_GetPreciseTime() - start);
+
+	return ret;
+}
+
 boolean P_SceneryTryMove(mobj_t *thing, fixed_t x, fixed_t y, TryMoveResult_t *result)
 {
 	fixed_t tryx, tryy;
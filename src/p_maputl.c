@@ -1383,6 +1383,34 @@ boolean P_BlockThingsIterator(INT32 x, INT32 y, BlockItReturn_t (*func)(mobj_t *
 	return true;
 }
 
+//
+// P_BlockThingsSearch
+//
+// Like P_BlockThingsIterator, for callbacks that only look at objects and
+// never spawn or remove any. It doesn't take references to the objects it
+// walks over, so it's safe to call from the thread pool.
+//
+boolean P_BlockThingsSearch(INT32 x, INT32 y, BlockItReturn_t (*func)(mobj_t *))
+{
+	mobj_t *mobj;
+
+	if (x < 0 || y < 0 || x >= bmapwidth || y >= bmapheight)
+		return true;
+
+	for (mobj = blocklinks[y*bmapwidth + x]; mobj; mobj = mobj->bnext)
+	{
+		BlockItReturn_t ret = func(mobj);
+
+		if (ret == BMIT_ABORT)
+			return false; // failure
+
+		if (ret == BMIT_STOP)
+			return true; // success
+	}
+
+	return true;
+}
+
 //
 // INTERCEPT ROUTINES
 //
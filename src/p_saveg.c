@@ -4293,6 +4293,9 @@ static void P_NetUnArchiveWaypoints(savebuffer_t *save)
 		}
 	}
 
+	// The waypoint tables have to match the server's from the very next tic
+	K_UpdateWaypointTables();
+
 	TracyCZoneEnd(__zone);
 }
 
@@ -6977,12 +6980,15 @@ void P_SaveGame(savebuffer_t *save)
 	P_ArchiveLuabanksAndConsistency(save);
 }
 
+size_t netsavesections[NUMNETSAVESECTIONS];
+
 void P_SaveNetGame(savebuffer_t *save, boolean resending)
 {
 	TracyCZone(__zone, true);
 
 	current_savebuffer = save;
 
+	UINT8 *start = save->p;
 	thinker_t *th;
 	mobj_t *mobj;
 	UINT32 i = 1; // don't start from 0, it'd be confused with a blank pointer otherwise
@@ -7007,22 +7013,30 @@ void P_SaveNetGame(savebuffer_t *save, boolean resending)
 
 	K_SaveEndCamera(save);
 	WriteMobjPointer(g_endcam.panMobj);
+	netsavesections[NETSAVE_MISC] = save->p - start;
 
 	P_NetArchivePlayers(save);
 	P_NetArchiveParties(save);
 	P_NetArchiveRoundQueue(save);
 	P_NetArchiveZVote(save);
+	netsavesections[NETSAVE_PLAYERS] = save->p - start;
 
 	if (gamestate == GS_LEVEL)
 	{
 		P_NetArchiveWorld(save);
 		P_ArchivePolyObjects(save);
+	}
+	netsavesections[NETSAVE_WORLD] = save->p - start;
+
+	if (gamestate == GS_LEVEL)
+	{
 		P_NetArchiveThinkers(save);
 		P_NetArchiveSpecials(save);
 		P_NetArchiveColormaps(save);
 		P_NetArchiveTubeWaypoints(save);
 		P_NetArchiveWaypoints(save);
 	}
+	netsavesections[NETSAVE_THINKERS] = save->p - start;
 
 	ACS_Archive(save);
 	LUA_Archive(save, true);
@@ -7030,6 +7044,7 @@ void P_SaveNetGame(savebuffer_t *save, boolean resending)
 	P_NetArchiveRNG(save);
 
 	P_ArchiveLuabanksAndConsistency(save);
+	netsavesections[NETSAVE_SCRIPTS] = save->p - start;
 
 	TracyCZoneEnd(__zone);
 }
@@ -40,6 +40,20 @@ boolean P_LoadNetGame(savebuffer_t *save, boolean reloading);
 
 mobj_t *P_FindNewPosition(UINT32 oldposition);
 
+// Sections of a netgame save, so gamestate resends can hash them separately
+typedef enum
+{
+	NETSAVE_MISC,
+	NETSAVE_PLAYERS,
+	NETSAVE_WORLD,
+	NETSAVE_THINKERS,
+	NETSAVE_SCRIPTS,
+	NUMNETSAVESECTIONS
+} netsavesection_t;
+
+// End offset of each section of the last P_SaveNetGame, from where it started writing
+extern size_t netsavesections[NUMNETSAVESECTIONS];
+
 struct savedata_bot_s
 {
 	boolean valid;
@@ -14,11 +14,13 @@
 
 #include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <fmt/format.h>
 
 #include "cxxutil.hpp"
+#include "core/thread_pool.h"
 
 #include "doomdef.h"
 #include "d_main.h"
@@ -63,6 +65,7 @@
 #include "m_cond.h" // for emblems
 
 #include "m_argv.h"
+#include "command.h" // textmapbench
 
 #include "p_polyobj.h"
 
@@ -1438,74 +1441,471 @@ UINT32 sidesPos[UINT16_MAX];
 UINT32 vertexesPos[UINT16_MAX];
 UINT32 sectorsPos[UINT16_MAX];
 
-// Determine total amount of map data in TEXTMAP.
-static boolean TextmapCount(size_t size)
+// Reads TEXTMAP tokens straight out of the lump. A token is a view into the
+// lump data, which is never copied or written to; the rules are otherwise
+// those of M_TokenizerRead.
+struct textmaptokenizer_t
 {
-	TracyCZone(__zone, true);
+	const char *data;
+	size_t size;
+	size_t pos; // Just past the last token read
+	boolean string; // Was the last token in quotes?
+};
 
-	const char *tkn = M_TokenizerRead(0);
-	UINT8 brackets = 0;
+// The TEXTMAP being loaded.
+static textmaptokenizer_t textmapTokenizer;
 
-	nummapthings = 0;
-	numlines = 0;
-	numsides = 0;
-	numvertexes = 0;
-	numsectors = 0;
+static inline boolean TextmapCommentAt(const textmaptokenizer_t *tk, size_t pos)
+{
+	return tk->data[pos] == '/' && pos + 1 < tk->size
+		&& (tk->data[pos + 1] == '/' || tk->data[pos + 1] == '*');
+}
+
+// Moves pos past the comment starting at it.
+static size_t TextmapSkipComment(const textmaptokenizer_t *tk, size_t pos)
+{
+	if (tk->data[pos + 1] == '/')
+	{
+		while (pos < tk->size && tk->data[pos] != '\n')
+			pos++;
+		return pos;
+	}
+
+	for (pos += 2; pos + 1 < tk->size; pos++)
+	{
+		if (tk->data[pos] == '*' && tk->data[pos + 1] == '/')
+			return pos + 2;
+	}
+
+	return tk->size;
+}
+
+/** Reads the next token of a TEXTMAP.
+  *
+  * \param tk Tokenizer to read from.
+  * \param tkn Set to the token, without its quotes if it was a string.
+  * \return False at the end of the lump.
+  */
+static boolean TextmapRead(textmaptokenizer_t *tk, std::string_view *tkn)
+{
+	const char *data = tk->data;
+	size_t pos = tk->pos;
+	size_t start;
+
+	tk->string = false;
+
+	// Skip whitespace, comments, and UDMF's = and ;
+	while (pos < tk->size)
+	{
+		if (TextmapCommentAt(tk, pos))
+			pos = TextmapSkipComment(tk, pos);
+		else if (data[pos] == ' ' || data[pos] == '\t' || data[pos] == '\r' || data[pos] == '\n'
+			|| data[pos] == '\0' || data[pos] == '=' || data[pos] == ';')
+			pos++;
+		else
+			break;
+	}
+
+	if (pos >= tk->size)
+	{
+		tk->pos = tk->size;
+		return false;
+	}
+
+	start = pos;
+
+	if (data[pos] == ',' || data[pos] == '{' || data[pos] == '}')
+	{
+		pos++;
+	}
+	else if (data[pos] == '"')
+	{
+		const char *end = static_cast<const char *>(memchr(data + pos + 1, '"', tk->size - pos - 1));
+
+		pos = end ? (size_t)(end - data) : tk->size;
+		*tkn = std::string_view(data + start + 1, pos - start - 1);
+		tk->pos = std::min(pos + 1, tk->size);
+		tk->string = true;
+		return true;
+	}
+	else
+	{
+		for (pos++; pos < tk->size; pos++)
+		{
+			if (data[pos] == ' ' || data[pos] == '\t' || data[pos] == '\r' || data[pos] == '\n'
+				|| data[pos] == ',' || data[pos] == '{' || data[pos] == '}'
+				|| data[pos] == '=' || data[pos] == ';' || TextmapCommentAt(tk, pos))
+				break;
+		}
+	}
+
+	*tkn = std::string_view(data + start, pos - start);
+	tk->pos = pos;
+	return true;
+}
+
+// Skips to just past the } closing a block whose { was just read.
+// Nothing inside is tokenized; only strings and comments are looked at,
+// so that braces in them don't count.
+static boolean TextmapSkipBlock(textmaptokenizer_t *tk)
+{
+	const char *data = tk->data;
+	size_t pos = tk->pos;
+	UINT32 depth = 1;
+
+	while (pos < tk->size)
+	{
+		if (data[pos] == '"')
+		{
+			const char *end = static_cast<const char *>(memchr(data + pos + 1, '"', tk->size - pos - 1));
+
+			if (end == NULL)
+				break;
+
+			pos = (end - data) + 1;
+		}
+		else if (TextmapCommentAt(tk, pos))
+			pos = TextmapSkipComment(tk, pos);
+		else if (data[pos] == '{')
+		{
+			depth++;
+			pos++;
+		}
+		else if (data[pos] == '}' && --depth == 0)
+		{
+			tk->pos = pos + 1;
+			return true;
+		}
+		else
+			pos++;
+	}
+
+	tk->pos = tk->size;
+	return false;
+}
+
+// atol() for a token.
+static long TextmapInt(std::string_view val)
+{
+	unsigned long n = 0;
+	boolean negative = false;
+	size_t i = 0;
+
+	while (i < val.size() && isspace(static_cast<UINT8>(val[i])))
+		i++;
+
+	if (i < val.size() && (val[i] == '-' || val[i] == '+'))
+		negative = (val[i++] == '-');
+
+	for (; i < val.size() && val[i] >= '0' && val[i] <= '9'; i++)
+		n = n * 10 + (val[i] - '0');
+
+	return static_cast<long>(negative ? 0 - n : n);
+}
+
+// atof() for a token. The number is copied out so strtod has its terminator.
+static double TextmapFloat(std::string_view val)
+{
+	char buf[64];
+	const size_t len = std::min(val.size(), sizeof buf - 1);
+
+	M_Memcpy(buf, val.data(), len);
+	buf[len] = '\0';
+
+	return atof(buf);
+}
+
+// Copies a string value out of the lump, for the level to keep.
+static char *TextmapString(std::string_view val)
+{
+	char *str = static_cast<char*>(Z_Malloc(val.size() + 1, PU_LEVEL, NULL));
+
+	M_Memcpy(str, val.data(), val.size());
+	str[val.size()] = '\0';
+
+	return str;
+}
+
+// Matches parameters like "arg0", setting argnum to the number after prefix.
+static boolean TextmapArgParam(std::string_view param, std::string_view prefix, size_t *argnum)
+{
+	if (param.size() <= prefix.size() || param.compare(0, prefix.size(), prefix) != 0)
+		return false;
+
+	*argnum = TextmapInt(param.substr(prefix.size()));
+	return true;
+}
+
+// Adds each of the space separated tags of moreids.
+static void TextmapAddTags(taglist_t *tags, std::string_view val)
+{
+	while (true)
+	{
+		const size_t space = val.find(' ');
+
+		Tag_Add(tags, TextmapInt(val));
+
+		if (space == std::string_view::npos)
+			break;
+
+		val.remove_prefix(space + 1);
+	}
+}
+
+typedef enum
+{
+	TMB_THING,
+	TMB_LINEDEF,
+	TMB_SIDEDEF,
+	TMB_VERTEX,
+	TMB_SECTOR,
+	NUMTEXTMAPBLOCKS
+} textmapblock_t;
+
+static const char *const textmapBlockNames[NUMTEXTMAPBLOCKS] = {
+	"thing", "linedef", "sidedef", "vertex", "sector"
+};
+
+/** Finds the top-level blocks of a TEXTMAP. Only the names outside of braces
+  * are tokenized; each block's body is skipped over, to be parsed later.
+  *
+  * \param tk Tokenizer over the whole lump.
+  * \param version Set from the version field, if there is one.
+  * \param found Called with each block and the position just past its name.
+  * \return False if the lump is malformed.
+  */
+static boolean TextmapScan(textmaptokenizer_t tk, INT32 *version, void (*found)(textmapblock_t, UINT32))
+{
+	std::string_view tkn;
+
+	tk.pos = 0;
 
 	// Look for namespace at the beginning.
-	if (!fastcmp(tkn, "namespace"))
+	if (!TextmapRead(&tk, &tkn) || tkn != "namespace")
 	{
 		CONS_Alert(CONS_ERROR, "No namespace at beginning of lump!\n");
-		TracyCZoneEnd(__zone);
 		return false;
 	}
 
 	// Check if namespace is valid.
-	tkn = M_TokenizerRead(0);
-	if (!fastcmp(tkn, "ringracers"))
-		CONS_Alert(CONS_WARNING, "Invalid namespace '%s', only 'ringracers' is supported. This map may have issues loading.\n", tkn);
+	TextmapRead(&tk, &tkn);
+	if (tkn != "ringracers")
+		CONS_Alert(CONS_WARNING, "Invalid namespace '%.*s', only 'ringracers' is supported. This map may have issues loading.\n", (int)tkn.size(), tkn.data());
 
-	while ((tkn = M_TokenizerRead(0)) && M_TokenizerGetEndPos() < size)
+	while (TextmapRead(&tk, &tkn))
 	{
+		size_t b;
+
 		// Avoid anything inside bracketed stuff, only look for external keywords.
-		if (brackets)
+		if (tkn == "{")
 		{
-			if (fastcmp(tkn, "}"))
-				brackets--;
+			if (!TextmapSkipBlock(&tk))
+			{
+				CONS_Alert(CONS_ERROR, "Unclosed brackets detected in textmap lump.\n");
+				return false;
+			}
+			continue;
 		}
-		else if (fastcmp(tkn, "{"))
-			brackets++;
+
 		// Check for valid fields.
-		else if (fastcmp(tkn, "thing"))
-			mapthingsPos[nummapthings++] = M_TokenizerGetEndPos();
-		else if (fastcmp(tkn, "linedef"))
-			linesPos[numlines++] = M_TokenizerGetEndPos();
-		else if (fastcmp(tkn, "sidedef"))
-			sidesPos[numsides++] = M_TokenizerGetEndPos();
-		else if (fastcmp(tkn, "vertex"))
-			vertexesPos[numvertexes++] = M_TokenizerGetEndPos();
-		else if (fastcmp(tkn, "sector"))
-			sectorsPos[numsectors++] = M_TokenizerGetEndPos();
-		else if (fastcmp(tkn, "version"))
-		{
-			tkn = M_TokenizerRead(0);
-			udmf_version = atoi(tkn);
-			if (udmf_version > UDMF_CURRENT_VERSION)
-				CONS_Alert(CONS_WARNING, "Map is intended for future UDMF version '%d', current supported version is '%d'. This map may have issues loading.\n", udmf_version, UDMF_CURRENT_VERSION);
+		for (b = 0; b < NUMTEXTMAPBLOCKS; b++)
+		{
+			if (tkn == textmapBlockNames[b])
+			{
+				found(static_cast<textmapblock_t>(b), tk.pos);
+				break;
+			}
+		}
+
+		if (b < NUMTEXTMAPBLOCKS)
+			continue;
+
+		if (tkn == "version")
+		{
+			TextmapRead(&tk, &tkn);
+			*version = TextmapInt(tkn);
+			if (*version > UDMF_CURRENT_VERSION)
+				CONS_Alert(CONS_WARNING, "Map is intended for future UDMF version '%d', current supported version is '%d'. This map may have issues loading.\n", *version, UDMF_CURRENT_VERSION);
 		}
 		else
-			CONS_Alert(CONS_NOTICE, "Unknown field '%s'.\n", tkn);
+			CONS_Alert(CONS_NOTICE, "Unknown field '%.*s'.\n", (int)tkn.size(), tkn.data());
 	}
 
-	if (brackets)
+	return true;
+}
+
+static void TextmapCountBlock(textmapblock_t block, UINT32 pos)
+{
+	switch (block)
 	{
-		CONS_Alert(CONS_ERROR, "Unclosed brackets detected in textmap lump.\n");
-		TracyCZoneEnd(__zone);
-		return false;
+		case TMB_THING:
+			mapthingsPos[nummapthings++] = pos;
+			break;
+		case TMB_LINEDEF:
+			linesPos[numlines++] = pos;
+			break;
+		case TMB_SIDEDEF:
+			sidesPos[numsides++] = pos;
+			break;
+		case TMB_VERTEX:
+			vertexesPos[numvertexes++] = pos;
+			break;
+		case TMB_SECTOR:
+			sectorsPos[numsectors++] = pos;
+			break;
+		default:
+			break;
 	}
+}
+
+// Determine total amount of map data in TEXTMAP.
+static boolean TextmapCount(void)
+{
+	TracyCZone(__zone, true);
+
+	boolean ok;
+
+	nummapthings = 0;
+	numlines = 0;
+	numsides = 0;
+	numvertexes = 0;
+	numsectors = 0;
+
+	ok = TextmapScan(textmapTokenizer, &udmf_version, TextmapCountBlock);
 
 	TracyCZoneEnd(__zone);
-	return true;
+	return ok;
+}
+
+// Every property name the Parse*Parameter functions switch on. They are
+// hashed into a table at compile time, so each parameter read costs one
+// hash and usually one string compare, instead of a walk down a chain of
+// compares that only ends at the right name or at user properties.
+#define TEXTMAP_KEYWORDS(KW) \
+	KW(X, "x") KW(Y, "y") KW(ZFLOOR, "zfloor") KW(ZCEILING, "zceiling") KW(HEIGHTFLOOR, "heightfloor") \
+	KW(HEIGHTCEILING, "heightceiling") KW(TEXTUREFLOOR, "texturefloor") \
+	KW(TEXTURECEILING, "textureceiling") KW(LIGHTLEVEL, "lightlevel") KW(LIGHTFLOOR, "lightfloor") \
+	KW(LIGHTFLOORABSOLUTE, "lightfloorabsolute") KW(LIGHTCEILING, "lightceiling") \
+	KW(LIGHTCEILINGABSOLUTE, "lightceilingabsolute") KW(ID, "id") KW(MOREIDS, "moreids") \
+	KW(XPANNINGFLOOR, "xpanningfloor") KW(YPANNINGFLOOR, "ypanningfloor") \
+	KW(XPANNINGCEILING, "xpanningceiling") KW(YPANNINGCEILING, "ypanningceiling") \
+	KW(ROTATIONFLOOR, "rotationfloor") KW(ROTATIONCEILING, "rotationceiling") \
+	KW(FLOORPLANE_A, "floorplane_a") KW(FLOORPLANE_B, "floorplane_b") KW(FLOORPLANE_C, "floorplane_c") \
+	KW(FLOORPLANE_D, "floorplane_d") KW(CEILINGPLANE_A, "ceilingplane_a") \
+	KW(CEILINGPLANE_B, "ceilingplane_b") KW(CEILINGPLANE_C, "ceilingplane_c") \
+	KW(CEILINGPLANE_D, "ceilingplane_d") KW(LIGHTCOLOR, "lightcolor") KW(LIGHTALPHA, "lightalpha") \
+	KW(FADECOLOR, "fadecolor") KW(FADEALPHA, "fadealpha") KW(FADESTART, "fadestart") \
+	KW(FADEEND, "fadeend") KW(COLORMAPFOG, "colormapfog") KW(COLORMAPFADESPRITES, "colormapfadesprites") \
+	KW(COLORMAPPROTECTED, "colormapprotected") KW(FLIPSPECIAL_NOFLOOR, "flipspecial_nofloor") \
+	KW(FLIPSPECIAL_CEILING, "flipspecial_ceiling") KW(TRIGGERSPECIAL_TOUCH, "triggerspecial_touch") \
+	KW(TRIGGERSPECIAL_HEADBUMP, "triggerspecial_headbump") KW(INVERTPRECIP, "invertprecip") \
+	KW(GRAVITYFLIP, "gravityflip") KW(HEATWAVE, "heatwave") KW(NOCLIPCAMERA, "noclipcamera") \
+	KW(RIPPLE_FLOOR, "ripple_floor") KW(RIPPLE_CEILING, "ripple_ceiling") \
+	KW(INVERTENCORE, "invertencore") KW(FLATLIGHTING, "flatlighting") \
+	KW(FORCEDIRECTIONALLIGHTING, "forcedirectionallighting") KW(NOSTEPUP, "nostepup") \
+	KW(DOUBLESTEPUP, "doublestepup") KW(NOSTEPDOWN, "nostepdown") \
+	KW(CHEATCHECKACTIVATOR, "cheatcheckactivator") KW(STARPOSTACTIVATOR, "starpostactivator") \
+	KW(EXIT, "exit") KW(DELETEITEMS, "deleteitems") KW(FAN, "fan") KW(ZOOMTUBESTART, "zoomtubestart") \
+	KW(ZOOMTUBEEND, "zoomtubeend") KW(FRICTION, "friction") KW(GRAVITY, "gravity") \
+	KW(DAMAGETYPE, "damagetype") KW(ACTION, "action") KW(REPEATSPECIAL, "repeatspecial") \
+	KW(CONTINUOUSSPECIAL, "continuousspecial") KW(PLAYERENTER, "playerenter") \
+	KW(PLAYERFLOOR, "playerfloor") KW(PLAYERCEILING, "playerceiling") KW(MONSTERENTER, "monsterenter") \
+	KW(MONSTERFLOOR, "monsterfloor") KW(MONSTERCEILING, "monsterceiling") \
+	KW(MISSILEENTER, "missileenter") KW(MISSILEFLOOR, "missilefloor") \
+	KW(MISSILECEILING, "missileceiling") KW(OFFSETX, "offsetx") KW(OFFSETY, "offsety") \
+	KW(TEXTURETOP, "texturetop") KW(TEXTUREBOTTOM, "texturebottom") KW(TEXTUREMIDDLE, "texturemiddle") \
+	KW(SECTOR, "sector") KW(REPEATCNT, "repeatcnt") KW(SPECIAL, "special") KW(V1, "v1") KW(V2, "v2") \
+	KW(SIDEFRONT, "sidefront") KW(SIDEBACK, "sideback") KW(ALPHA, "alpha") KW(BLENDMODE, "blendmode") \
+	KW(RENDERSTYLE, "renderstyle") KW(BLOCKING, "blocking") KW(BLOCKPLAYERS, "blockplayers") \
+	KW(TWOSIDED, "twosided") KW(DONTPEGTOP, "dontpegtop") KW(DONTPEGBOTTOM, "dontpegbottom") \
+	KW(SKEWTD, "skewtd") KW(NOCLIMB, "noclimb") KW(NOSKEW, "noskew") KW(MIDPEG, "midpeg") \
+	KW(MIDSOLID, "midsolid") KW(WRAPMIDTEX, "wrapmidtex") KW(BLOCKMONSTERS, "blockmonsters") \
+	KW(NONET, "nonet") KW(NETONLY, "netonly") KW(NOTBOUNCY, "notbouncy") KW(TRANSFER, "transfer") \
+	KW(PLAYERCROSS, "playercross") KW(MONSTERCROSS, "monstercross") KW(MISSILECROSS, "missilecross") \
+	KW(PLAYERPUSH, "playerpush") KW(MONSTERPUSH, "monsterpush") KW(IMPACT, "impact") KW(HEIGHT, "height") \
+	KW(ANGLE, "angle") KW(PITCH, "pitch") KW(ROLL, "roll") KW(TYPE, "type") KW(SCALE, "scale") \
+	KW(SCALEX, "scalex") KW(SCALEY, "scaley") KW(MOBJSCALE, "mobjscale") KW(FLIP, "flip") \
+	KW(FOFLAYER, "foflayer")
+
+typedef enum
+{
+	TMK_NONE,
+#define TEXTMAP_KEYWORD_ENUM(id, name) TMK_##id,
+	TEXTMAP_KEYWORDS(TEXTMAP_KEYWORD_ENUM)
+#undef TEXTMAP_KEYWORD_ENUM
+	NUMTEXTMAPKEYWORDS
+} textmapkeyword_t;
+
+static constexpr const char *textmapKeywords[NUMTEXTMAPKEYWORDS] = {
+	NULL,
+#define TEXTMAP_KEYWORD_NAME(id, name) name,
+	TEXTMAP_KEYWORDS(TEXTMAP_KEYWORD_NAME)
+#undef TEXTMAP_KEYWORD_NAME
+};
+
+static constexpr UINT32 TextmapHash(std::string_view s)
+{
+	UINT32 hash = 2166136261u; // FNV-1a
+
+	for (char c : s)
+		hash = (hash ^ static_cast<UINT8>(c)) * 16777619u;
+
+	return hash;
+}
+
+// Linear probing, at least four times as many slots as keywords.
+#define TEXTMAPKEYSLOTS 512
+
+struct textmapkeytable_t
+{
+	UINT8 slots[TEXTMAPKEYSLOTS]; // textmapkeyword_t, TMK_NONE if empty
+	size_t maxprobe;
+};
+
+static constexpr textmapkeytable_t TextmapBuildKeyTable(void)
+{
+	textmapkeytable_t table = {};
+
+	for (size_t k = 1; k < NUMTEXTMAPKEYWORDS; k++)
+	{
+		size_t slot = TextmapHash(textmapKeywords[k]) & (TEXTMAPKEYSLOTS - 1);
+		size_t probe = 0;
+
+		while (table.slots[slot] != TMK_NONE)
+		{
+			slot = (slot + 1) & (TEXTMAPKEYSLOTS - 1);
+			probe++;
+		}
+
+		table.slots[slot] = static_cast<UINT8>(k);
+
+		if (probe > table.maxprobe)
+			table.maxprobe = probe;
+	}
+
+	return table;
+}
+
+static constexpr textmapkeytable_t textmapKeyTable = TextmapBuildKeyTable();
+
+static_assert(NUMTEXTMAPKEYWORDS <= UINT8_MAX, "textmap keyword table slots are UINT8");
+static_assert(NUMTEXTMAPKEYWORDS * 4 <= TEXTMAPKEYSLOTS, "textmap keyword table is too full");
+static_assert(textmapKeyTable.maxprobe <= 4, "textmap keywords collide too much, grow the table");
+
+static textmapkeyword_t TextmapKeyword(std::string_view param)
+{
+	size_t slot = TextmapHash(param) & (TEXTMAPKEYSLOTS - 1);
+	UINT8 k;
+
+	while ((k = textmapKeyTable.slots[slot]) != TMK_NONE)
+	{
+		if (param == textmapKeywords[k])
+			return static_cast<textmapkeyword_t>(k);
+
+		slot = (slot + 1) & (TEXTMAPKEYSLOTS - 1);
+	}
+
+	return TMK_NONE;
 }
 
 enum
@@ -1515,20 +1915,23 @@ enum
 	PROP_NUM_TYPE_FLOAT
 };
 
-static void ParseUserProperty(mapUserProperties_t *user, const char *param, const char *val)
+static void ParseUserProperty(mapUserProperties_t *user, std::string_view param, std::string_view val)
 {
-	if (fastncmp(param, "user_", 5) && strlen(param) > 5)
+	if (param.size() > 5 && param.compare(0, 5, "user_") == 0)
 	{
-		const boolean valIsString = M_TokenizerJustReadString();
-		const char *key = param + 5;
-		const size_t valLen = strlen(val);
+		const boolean valIsString = textmapTokenizer.string;
+		const std::string keyStr(param.substr(5));
+		const char *key = keyStr.c_str();
+		const size_t valLen = val.size();
 		UINT8 numberType = PROP_NUM_TYPE_INT;
 		size_t i = 0;
 
 		if (valIsString == true)
 		{
 			// Value is a string. Upload directly!
-			K_UserPropertyPush(user, key, USER_PROP_STR, &val);
+			const std::string valStr(val);
+			const char *str = valStr.c_str();
+			K_UserPropertyPush(user, key, USER_PROP_STR, &str);
 			return;
 		}
 
@@ -1550,14 +1953,14 @@ static void ParseUserProperty(mapUserProperties_t *user, const char *param, cons
 			case PROP_NUM_TYPE_INT:
 			{
 				// Value is an integer.
-				INT32 vInt = atol(val);
+				INT32 vInt = TextmapInt(val);
 				K_UserPropertyPush(user, key, USER_PROP_INT, &vInt);
 				break;
 			}
 			case PROP_NUM_TYPE_FLOAT:
 			{
 				// Value is a float. Convert to fixed.
-				fixed_t vFixed = FLOAT_TO_FIXED(atof(val));
+				fixed_t vFixed = FLOAT_TO_FIXED(TextmapFloat(val));
 				K_UserPropertyPush(user, key, USER_PROP_FIXED, &vFixed);
 				break;
 			}
@@ -1567,8 +1970,8 @@ static void ParseUserProperty(mapUserProperties_t *user, const char *param, cons
 				// Value is some other kind of type.
 				// Currently we just support bool.
 
-				boolean vBool = fastcmp("true", val);
-				if (vBool == true || fastcmp("false", val))
+				boolean vBool = val == "true";
+				if (vBool == true || val == "false")
 				{
 					// Value is a boolean.
 					K_UserPropertyPush(user, key, USER_PROP_BOOL, &vBool);
@@ -1576,7 +1979,8 @@ static void ParseUserProperty(mapUserProperties_t *user, const char *param, cons
 				else
 				{
 					// Value is invalid.
-					CONS_Alert(CONS_WARNING, "Could not interpret user property \"%s\" value (%s)\n", param, val);
+					CONS_Alert(CONS_WARNING, "Could not interpret user property \"%.*s\" value (%.*s)\n",
+						(int)param.size(), param.data(), (int)val.size(), val.data());
 				}
 				break;
 			}
@@ -1584,21 +1988,26 @@ static void ParseUserProperty(mapUserProperties_t *user, const char *param, cons
 	}
 }
 
-static void ParseTextmapVertexParameter(UINT32 i, const char *param, const char *val)
+static void ParseTextmapVertexParameter(UINT32 i, std::string_view param, std::string_view val)
 {
-	if (fastcmp(param, "x"))
-		vertexes[i].x = FLOAT_TO_FIXED(atof(val));
-	else if (fastcmp(param, "y"))
-		vertexes[i].y = FLOAT_TO_FIXED(atof(val));
-	else if (fastcmp(param, "zfloor"))
-	{
-		vertexes[i].floorz = FLOAT_TO_FIXED(atof(val));
-		vertexes[i].floorzset = true;
-	}
-	else if (fastcmp(param, "zceiling"))
+	switch (TextmapKeyword(param))
 	{
-		vertexes[i].ceilingz = FLOAT_TO_FIXED(atof(val));
-		vertexes[i].ceilingzset = true;
+		case TMK_X:
+			vertexes[i].x = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_Y:
+			vertexes[i].y = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_ZFLOOR:
+			vertexes[i].floorz = FLOAT_TO_FIXED(TextmapFloat(val));
+			vertexes[i].floorzset = true;
+			break;
+		case TMK_ZCEILING:
+			vertexes[i].ceilingz = FLOAT_TO_FIXED(TextmapFloat(val));
+			vertexes[i].ceilingzset = true;
+			break;
+		default:
+			break;
 	}
 }
 
@@ -1631,485 +2040,626 @@ typedef struct textmap_plane_s {
 textmap_plane_t textmap_planefloor = {0, 0, 0, 0, 0};
 textmap_plane_t textmap_planeceiling = {0, 0, 0, 0, 0};
 
-static void ParseTextmapSectorParameter(UINT32 i, const char *param, const char *val)
+static void ParseTextmapSectorParameter(UINT32 i, std::string_view param, std::string_view val)
 {
-	if (fastcmp(param, "heightfloor"))
-		sectors[i].floorheight = atol(val) << FRACBITS;
-	else if (fastcmp(param, "heightceiling"))
-		sectors[i].ceilingheight = atol(val) << FRACBITS;
-	if (fastcmp(param, "texturefloor"))
-		sectors[i].floorpic = P_AddLevelFlat(val, foundflats);
-	else if (fastcmp(param, "textureceiling"))
-		sectors[i].ceilingpic = P_AddLevelFlat(val, foundflats);
-	else if (fastcmp(param, "lightlevel"))
-		sectors[i].lightlevel = atol(val);
-	else if (fastcmp(param, "lightfloor"))
-		sectors[i].floorlightlevel = atol(val);
-	else if (fastcmp(param, "lightfloorabsolute") && fastcmp("true", val))
-		sectors[i].floorlightabsolute = true;
-	else if (fastcmp(param, "lightceiling"))
-		sectors[i].ceilinglightlevel = atol(val);
-	else if (fastcmp(param, "lightceilingabsolute") && fastcmp("true", val))
-		sectors[i].ceilinglightabsolute = true;
-	else if (fastcmp(param, "id"))
-		Tag_FSet(&sectors[i].tags, atol(val));
-	else if (fastcmp(param, "moreids"))
-	{
-		const char* id = val;
-		while (id)
-		{
-			Tag_Add(&sectors[i].tags, atol(id));
-			if ((id = strchr(id, ' ')))
-				id++;
-		}
-	}
-	else if (fastcmp(param, "xpanningfloor"))
-		sectors[i].floor_xoffs = FLOAT_TO_FIXED(atof(val));
-	else if (fastcmp(param, "ypanningfloor"))
-		sectors[i].floor_yoffs = FLOAT_TO_FIXED(atof(val));
-	else if (fastcmp(param, "xpanningceiling"))
-		sectors[i].ceiling_xoffs = FLOAT_TO_FIXED(atof(val));
-	else if (fastcmp(param, "ypanningceiling"))
-		sectors[i].ceiling_yoffs = FLOAT_TO_FIXED(atof(val));
-	else if (fastcmp(param, "rotationfloor"))
-		sectors[i].floorpic_angle = FixedAngle(FLOAT_TO_FIXED(atof(val)));
-	else if (fastcmp(param, "rotationceiling"))
-		sectors[i].ceilingpic_angle = FixedAngle(FLOAT_TO_FIXED(atof(val)));
-	else if (fastcmp(param, "floorplane_a"))
-	{
-		textmap_planefloor.defined |= PD_A;
-		textmap_planefloor.a = FLOAT_TO_FIXED(atof(val));
-	}
-	else if (fastcmp(param, "floorplane_b"))
+	size_t argnum;
+
+	switch (TextmapKeyword(param))
 	{
-		textmap_planefloor.defined |= PD_B;
-		textmap_planefloor.b = FLOAT_TO_FIXED(atof(val));
-	}
-	else if (fastcmp(param, "floorplane_c"))
-	{
-		textmap_planefloor.defined |= PD_C;
-		textmap_planefloor.c = FLOAT_TO_FIXED(atof(val));
-	}
-	else if (fastcmp(param, "floorplane_d"))
-	{
-		textmap_planefloor.defined |= PD_D;
-		textmap_planefloor.d = FLOAT_TO_FIXED(atof(val));
-	}
-	else if (fastcmp(param, "ceilingplane_a"))
-	{
-		textmap_planeceiling.defined |= PD_A;
-		textmap_planeceiling.a = FLOAT_TO_FIXED(atof(val));
-	}
-	else if (fastcmp(param, "ceilingplane_b"))
-	{
-		textmap_planeceiling.defined |= PD_B;
-		textmap_planeceiling.b = FLOAT_TO_FIXED(atof(val));
-	}
-	else if (fastcmp(param, "ceilingplane_c"))
-	{
-		textmap_planeceiling.defined |= PD_C;
-		textmap_planeceiling.c = FLOAT_TO_FIXED(atof(val));
-	}
-	else if (fastcmp(param, "ceilingplane_d"))
-	{
-		textmap_planeceiling.defined |= PD_D;
-		textmap_planeceiling.d = FLOAT_TO_FIXED(atof(val));
-	}
-	else if (fastcmp(param, "lightcolor"))
-	{
-		textmap_colormap.used = true;
-		textmap_colormap.lightcolor = atol(val);
-	}
-	else if (fastcmp(param, "lightalpha"))
-	{
-		textmap_colormap.used = true;
-		textmap_colormap.lightalpha = atol(val);
-	}
-	else if (fastcmp(param, "fadecolor"))
-	{
-		textmap_colormap.used = true;
-		textmap_colormap.fadecolor = atol(val);
-	}
-	else if (fastcmp(param, "fadealpha"))
-	{
-		textmap_colormap.used = true;
-		textmap_colormap.fadealpha = atol(val);
-	}
-	else if (fastcmp(param, "fadestart"))
-	{
-		textmap_colormap.used = true;
-		textmap_colormap.fadestart = atol(val);
-	}
-	else if (fastcmp(param, "fadeend"))
-	{
-		textmap_colormap.used = true;
-		textmap_colormap.fadeend = atol(val);
-	}
-	else if (fastcmp(param, "colormapfog") && fastcmp("true", val))
-	{
-		textmap_colormap.used = true;
-		textmap_colormap.flags |= CMF_FOG;
-	}
-	else if (fastcmp(param, "colormapfadesprites") && fastcmp("true", val))
-	{
-		textmap_colormap.used = true;
-		textmap_colormap.flags |= CMF_FADEFULLBRIGHTSPRITES;
-	}
-	else if (fastcmp(param, "colormapprotected") && fastcmp("true", val))
-		sectors[i].colormap_protected = true;
-	else if (fastcmp(param, "flipspecial_nofloor") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags & ~MSF_FLIPSPECIAL_FLOOR);
-	else if (fastcmp(param, "flipspecial_ceiling") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_FLIPSPECIAL_CEILING);
-	else if (fastcmp(param, "triggerspecial_touch") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_TRIGGERSPECIAL_TOUCH);
-	else if (fastcmp(param, "triggerspecial_headbump") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_TRIGGERSPECIAL_HEADBUMP);
-	else if (fastcmp(param, "invertprecip") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_INVERTPRECIP);
-	else if (fastcmp(param, "gravityflip") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_GRAVITYFLIP);
-	else if (fastcmp(param, "heatwave") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_HEATWAVE);
-	else if (fastcmp(param, "noclipcamera") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_NOCLIPCAMERA);
-	else if (fastcmp(param, "ripple_floor") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_RIPPLE_FLOOR);
-	else if (fastcmp(param, "ripple_ceiling") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_RIPPLE_CEILING);
-	else if (fastcmp(param, "invertencore") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_INVERTENCORE);
-	else if (fastcmp(param, "flatlighting") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_FLATLIGHTING);
-	else if (fastcmp(param, "forcedirectionallighting") && fastcmp("true", val))
-		sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_DIRECTIONLIGHTING);
-	else if (fastcmp(param, "nostepup") && fastcmp("true", val))
-		sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_NOSTEPUP);
-	else if (fastcmp(param, "doublestepup") && fastcmp("true", val))
-		sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_DOUBLESTEPUP);
-	else if (fastcmp(param, "nostepdown") && fastcmp("true", val))
-		sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_NOSTEPDOWN);
-	else if ((fastcmp(param, "cheatcheckactivator") || fastcmp(param, "starpostactivator")) && fastcmp("true", val))
-		sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_CHEATCHECKACTIVATOR);
-	else if (fastcmp(param, "exit") && fastcmp("true", val))
-		sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_EXIT);
-	else if (fastcmp(param, "deleteitems") && fastcmp("true", val))
-		sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_DELETEITEMS);
-	else if (fastcmp(param, "fan") && fastcmp("true", val))
-		sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_FAN);
-	else if (fastcmp(param, "zoomtubestart") && fastcmp("true", val))
-		sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_ZOOMTUBESTART);
-	else if (fastcmp(param, "zoomtubeend") && fastcmp("true", val))
-		sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_ZOOMTUBEEND);
-	else if (fastcmp(param, "friction"))
-		sectors[i].friction = FLOAT_TO_FIXED(atof(val));
-	else if (fastcmp(param, "gravity"))
-		sectors[i].gravity = FLOAT_TO_FIXED(atof(val));
-	else if (fastcmp(param, "damagetype"))
-	{
-		if (fastcmp(val, "Generic"))
-			sectors[i].damagetype = SD_GENERIC;
-		if (fastcmp(val, "Lava"))
-			sectors[i].damagetype = SD_LAVA;
-		if (fastcmp(val, "DeathPit"))
-			sectors[i].damagetype = SD_DEATHPIT;
-		if (fastcmp(val, "Instakill"))
-			sectors[i].damagetype = SD_INSTAKILL;
-		if (fastcmp(val, "Stumble"))
-			sectors[i].damagetype = SD_STUMBLE;
-	}
-	else if (fastcmp(param, "action"))
-		sectors[i].action = atol(val);
-	else if (fastncmp(param, "stringarg", 9) && strlen(param) > 9)
-	{
-		size_t argnum = atol(param + 9);
-		if (argnum >= NUM_SCRIPT_STRINGARGS)
-			return;
-		sectors[i].stringargs[argnum] = static_cast<char*>(Z_Malloc(strlen(val) + 1, PU_LEVEL, NULL));
-		M_Memcpy(sectors[i].stringargs[argnum], val, strlen(val) + 1);
+		case TMK_HEIGHTFLOOR:
+			sectors[i].floorheight = TextmapInt(val) << FRACBITS;
+			break;
+		case TMK_HEIGHTCEILING:
+			sectors[i].ceilingheight = TextmapInt(val) << FRACBITS;
+			break;
+		case TMK_TEXTUREFLOOR:
+			sectors[i].floorpic = P_AddLevelFlat(std::string(val).c_str(), foundflats);
+			break;
+		case TMK_TEXTURECEILING:
+			sectors[i].ceilingpic = P_AddLevelFlat(std::string(val).c_str(), foundflats);
+			break;
+		case TMK_LIGHTLEVEL:
+			sectors[i].lightlevel = TextmapInt(val);
+			break;
+		case TMK_LIGHTFLOOR:
+			sectors[i].floorlightlevel = TextmapInt(val);
+			break;
+		case TMK_LIGHTFLOORABSOLUTE:
+			if (val == "true")
+				sectors[i].floorlightabsolute = true;
+			break;
+		case TMK_LIGHTCEILING:
+			sectors[i].ceilinglightlevel = TextmapInt(val);
+			break;
+		case TMK_LIGHTCEILINGABSOLUTE:
+			if (val == "true")
+				sectors[i].ceilinglightabsolute = true;
+			break;
+		case TMK_ID:
+			Tag_FSet(&sectors[i].tags, TextmapInt(val));
+			break;
+		case TMK_MOREIDS:
+			{
+				TextmapAddTags(&sectors[i].tags, val);
+				break;
+			}
+		case TMK_XPANNINGFLOOR:
+			sectors[i].floor_xoffs = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_YPANNINGFLOOR:
+			sectors[i].floor_yoffs = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_XPANNINGCEILING:
+			sectors[i].ceiling_xoffs = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_YPANNINGCEILING:
+			sectors[i].ceiling_yoffs = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_ROTATIONFLOOR:
+			sectors[i].floorpic_angle = FixedAngle(FLOAT_TO_FIXED(TextmapFloat(val)));
+			break;
+		case TMK_ROTATIONCEILING:
+			sectors[i].ceilingpic_angle = FixedAngle(FLOAT_TO_FIXED(TextmapFloat(val)));
+			break;
+		case TMK_FLOORPLANE_A:
+			textmap_planefloor.defined |= PD_A;
+			textmap_planefloor.a = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_FLOORPLANE_B:
+			textmap_planefloor.defined |= PD_B;
+			textmap_planefloor.b = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_FLOORPLANE_C:
+			textmap_planefloor.defined |= PD_C;
+			textmap_planefloor.c = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_FLOORPLANE_D:
+			textmap_planefloor.defined |= PD_D;
+			textmap_planefloor.d = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_CEILINGPLANE_A:
+			textmap_planeceiling.defined |= PD_A;
+			textmap_planeceiling.a = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_CEILINGPLANE_B:
+			textmap_planeceiling.defined |= PD_B;
+			textmap_planeceiling.b = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_CEILINGPLANE_C:
+			textmap_planeceiling.defined |= PD_C;
+			textmap_planeceiling.c = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_CEILINGPLANE_D:
+			textmap_planeceiling.defined |= PD_D;
+			textmap_planeceiling.d = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_LIGHTCOLOR:
+			textmap_colormap.used = true;
+			textmap_colormap.lightcolor = TextmapInt(val);
+			break;
+		case TMK_LIGHTALPHA:
+			textmap_colormap.used = true;
+			textmap_colormap.lightalpha = TextmapInt(val);
+			break;
+		case TMK_FADECOLOR:
+			textmap_colormap.used = true;
+			textmap_colormap.fadecolor = TextmapInt(val);
+			break;
+		case TMK_FADEALPHA:
+			textmap_colormap.used = true;
+			textmap_colormap.fadealpha = TextmapInt(val);
+			break;
+		case TMK_FADESTART:
+			textmap_colormap.used = true;
+			textmap_colormap.fadestart = TextmapInt(val);
+			break;
+		case TMK_FADEEND:
+			textmap_colormap.used = true;
+			textmap_colormap.fadeend = TextmapInt(val);
+			break;
+		case TMK_COLORMAPFOG:
+			if (val == "true")
+			{
+				textmap_colormap.used = true;
+				textmap_colormap.flags |= CMF_FOG;
+			}
+			break;
+		case TMK_COLORMAPFADESPRITES:
+			if (val == "true")
+			{
+				textmap_colormap.used = true;
+				textmap_colormap.flags |= CMF_FADEFULLBRIGHTSPRITES;
+			}
+			break;
+		case TMK_COLORMAPPROTECTED:
+			if (val == "true")
+				sectors[i].colormap_protected = true;
+			break;
+		case TMK_FLIPSPECIAL_NOFLOOR:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags & ~MSF_FLIPSPECIAL_FLOOR);
+			break;
+		case TMK_FLIPSPECIAL_CEILING:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_FLIPSPECIAL_CEILING);
+			break;
+		case TMK_TRIGGERSPECIAL_TOUCH:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_TRIGGERSPECIAL_TOUCH);
+			break;
+		case TMK_TRIGGERSPECIAL_HEADBUMP:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_TRIGGERSPECIAL_HEADBUMP);
+			break;
+		case TMK_INVERTPRECIP:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_INVERTPRECIP);
+			break;
+		case TMK_GRAVITYFLIP:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_GRAVITYFLIP);
+			break;
+		case TMK_HEATWAVE:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_HEATWAVE);
+			break;
+		case TMK_NOCLIPCAMERA:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_NOCLIPCAMERA);
+			break;
+		case TMK_RIPPLE_FLOOR:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_RIPPLE_FLOOR);
+			break;
+		case TMK_RIPPLE_CEILING:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_RIPPLE_CEILING);
+			break;
+		case TMK_INVERTENCORE:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_INVERTENCORE);
+			break;
+		case TMK_FLATLIGHTING:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_FLATLIGHTING);
+			break;
+		case TMK_FORCEDIRECTIONALLIGHTING:
+			if (val == "true")
+				sectors[i].flags = static_cast<sectorflags_t>(sectors[i].flags | MSF_DIRECTIONLIGHTING);
+			break;
+		case TMK_NOSTEPUP:
+			if (val == "true")
+				sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_NOSTEPUP);
+			break;
+		case TMK_DOUBLESTEPUP:
+			if (val == "true")
+				sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_DOUBLESTEPUP);
+			break;
+		case TMK_NOSTEPDOWN:
+			if (val == "true")
+				sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_NOSTEPDOWN);
+			break;
+		case TMK_CHEATCHECKACTIVATOR:
+		case TMK_STARPOSTACTIVATOR:
+			if (val == "true")
+				sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_CHEATCHECKACTIVATOR);
+			break;
+		case TMK_EXIT:
+			if (val == "true")
+				sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_EXIT);
+			break;
+		case TMK_DELETEITEMS:
+			if (val == "true")
+				sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_DELETEITEMS);
+			break;
+		case TMK_FAN:
+			if (val == "true")
+				sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_FAN);
+			break;
+		case TMK_ZOOMTUBESTART:
+			if (val == "true")
+				sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_ZOOMTUBESTART);
+			break;
+		case TMK_ZOOMTUBEEND:
+			if (val == "true")
+				sectors[i].specialflags = static_cast<sectorspecialflags_t>(sectors[i].specialflags | SSF_ZOOMTUBEEND);
+			break;
+		case TMK_FRICTION:
+			sectors[i].friction = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_GRAVITY:
+			sectors[i].gravity = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_DAMAGETYPE:
+			if (val == "Generic")
+				sectors[i].damagetype = SD_GENERIC;
+			if (val == "Lava")
+				sectors[i].damagetype = SD_LAVA;
+			if (val == "DeathPit")
+				sectors[i].damagetype = SD_DEATHPIT;
+			if (val == "Instakill")
+				sectors[i].damagetype = SD_INSTAKILL;
+			if (val == "Stumble")
+				sectors[i].damagetype = SD_STUMBLE;
+			break;
+		case TMK_ACTION:
+			sectors[i].action = TextmapInt(val);
+			break;
+		case TMK_REPEATSPECIAL:
+			if (val == "true")
+				sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | ((sectors[i].activation & ~SECSPAC_TRIGGERMASK) | SECSPAC_REPEATSPECIAL));
+			break;
+		case TMK_CONTINUOUSSPECIAL:
+			if (val == "true")
+				sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | ((sectors[i].activation & ~SECSPAC_TRIGGERMASK) | SECSPAC_CONTINUOUSSPECIAL));
+			break;
+		case TMK_PLAYERENTER:
+			if (val == "true")
+				sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_ENTER);
+			break;
+		case TMK_PLAYERFLOOR:
+			if (val == "true")
+				sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_FLOOR);
+			break;
+		case TMK_PLAYERCEILING:
+			if (val == "true")
+				sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_CEILING);
+			break;
+		case TMK_MONSTERENTER:
+			if (val == "true")
+				sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_ENTERMONSTER);
+			break;
+		case TMK_MONSTERFLOOR:
+			if (val == "true")
+				sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_FLOORMONSTER);
+			break;
+		case TMK_MONSTERCEILING:
+			if (val == "true")
+				sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_CEILINGMONSTER);
+			break;
+		case TMK_MISSILEENTER:
+			if (val == "true")
+				sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_ENTERMISSILE);
+			break;
+		case TMK_MISSILEFLOOR:
+			if (val == "true")
+				sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_FLOORMISSILE);
+			break;
+		case TMK_MISSILECEILING:
+			if (val == "true")
+				sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_CEILINGMISSILE);
+			break;
+		default:
+			if (TextmapArgParam(param, "stringarg", &argnum))
+			{
+				if (argnum >= NUM_SCRIPT_STRINGARGS)
+					return;
+				sectors[i].stringargs[argnum] = TextmapString(val);
+			}
+			else if (TextmapArgParam(param, "arg", &argnum))
+			{
+				if (argnum >= NUM_SCRIPT_ARGS)
+					return;
+				sectors[i].args[argnum] = TextmapInt(val);
+			}
+			else
+				ParseUserProperty(&sectors[i].user, param, val);
+			break;
 	}
-	else if (fastncmp(param, "arg", 3) && strlen(param) > 3)
-	{
-		size_t argnum = atol(param + 3);
-		if (argnum >= NUM_SCRIPT_ARGS)
-			return;
-		sectors[i].args[argnum] = atol(val);
-	}
-	else if (fastcmp(param, "repeatspecial") && fastcmp("true", val))
-		sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | ((sectors[i].activation & ~SECSPAC_TRIGGERMASK) | SECSPAC_REPEATSPECIAL));
-	else if (fastcmp(param, "continuousspecial") && fastcmp("true", val))
-		sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | ((sectors[i].activation & ~SECSPAC_TRIGGERMASK) | SECSPAC_CONTINUOUSSPECIAL));
-	else if (fastcmp(param, "playerenter") && fastcmp("true", val))
-		sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_ENTER);
-	else if (fastcmp(param, "playerfloor") && fastcmp("true", val))
-		sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_FLOOR);
-	else if (fastcmp(param, "playerceiling") && fastcmp("true", val))
-		sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_CEILING);
-	else if (fastcmp(param, "monsterenter") && fastcmp("true", val))
-		sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_ENTERMONSTER);
-	else if (fastcmp(param, "monsterfloor") && fastcmp("true", val))
-		sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_FLOORMONSTER);
-	else if (fastcmp(param, "monsterceiling") && fastcmp("true", val))
-		sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_CEILINGMONSTER);
-	else if (fastcmp(param, "missileenter") && fastcmp("true", val))
-		sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_ENTERMISSILE);
-	else if (fastcmp(param, "missilefloor") && fastcmp("true", val))
-		sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_FLOORMISSILE);
-	else if (fastcmp(param, "missileceiling") && fastcmp("true", val))
-		sectors[i].activation = static_cast<sectoractionflags_t>(sectors[i].activation | SECSPAC_CEILINGMISSILE);
-	else
-		ParseUserProperty(&sectors[i].user, param, val);
-}
-
-static void ParseTextmapSidedefParameter(UINT32 i, const char *param, const char *val)
-{
-	if (fastcmp(param, "offsetx"))
-		sides[i].textureoffset = atol(val)<<FRACBITS;
-	else if (fastcmp(param, "offsety"))
-		sides[i].rowoffset = atol(val)<<FRACBITS;
-	else if (fastcmp(param, "texturetop"))
-		sides[i].toptexture = R_TextureNumForName(val);
-	else if (fastcmp(param, "texturebottom"))
-		sides[i].bottomtexture = R_TextureNumForName(val);
-	else if (fastcmp(param, "texturemiddle"))
-		sides[i].midtexture = R_TextureNumForName(val);
-	else if (fastcmp(param, "sector"))
-		P_SetSidedefSector(i, atol(val));
-	else if (fastcmp(param, "repeatcnt"))
-		sides[i].repeatcnt = atol(val);
-	else
-		ParseUserProperty(&sides[i].user, param, val);
 }
 
-static void ParseTextmapLinedefParameter(UINT32 i, const char *param, const char *val)
+static void ParseTextmapSidedefParameter(UINT32 i, std::string_view param, std::string_view val)
 {
-	if (fastcmp(param, "id"))
-		Tag_FSet(&lines[i].tags, atol(val));
-	else if (fastcmp(param, "moreids"))
-	{
-		const char* id = val;
-		while (id)
-		{
-			Tag_Add(&lines[i].tags, atol(id));
-			if ((id = strchr(id, ' ')))
-				id++;
-		}
-	}
-	else if (fastcmp(param, "special"))
-		lines[i].special = atol(val);
-	else if (fastcmp(param, "v1"))
-		P_SetLinedefV1(i, atol(val));
-	else if (fastcmp(param, "v2"))
-		P_SetLinedefV2(i, atol(val));
-	else if (fastncmp(param, "stringarg", 9) && strlen(param) > 9)
-	{
-		size_t argnum = atol(param + 9);
-		if (argnum >= NUM_SCRIPT_STRINGARGS)
-			return;
-		lines[i].stringargs[argnum] = static_cast<char*>(Z_Malloc(strlen(val) + 1, PU_LEVEL, NULL));
-		M_Memcpy(lines[i].stringargs[argnum], val, strlen(val) + 1);
-	}
-	else if (fastncmp(param, "arg", 3) && strlen(param) > 3)
+	switch (TextmapKeyword(param))
 	{
-		size_t argnum = atol(param + 3);
-		if (argnum >= NUM_SCRIPT_ARGS)
-			return;
-		lines[i].args[argnum] = atol(val);
-	}
-	else if (fastcmp(param, "sidefront"))
-		lines[i].sidenum[0] = atol(val);
-	else if (fastcmp(param, "sideback"))
-		lines[i].sidenum[1] = atol(val);
-	else if (fastcmp(param, "alpha"))
-		lines[i].alpha = FLOAT_TO_FIXED(atof(val));
-	else if (fastcmp(param, "blendmode") || fastcmp(param, "renderstyle"))
-	{
-		if (fastcmp(val, "translucent"))
-			lines[i].blendmode = AST_COPY;
-		else if (fastcmp(val, "add"))
-			lines[i].blendmode = AST_ADD;
-		else if (fastcmp(val, "subtract"))
-			lines[i].blendmode = AST_SUBTRACT;
-		else if (fastcmp(val, "reversesubtract"))
-			lines[i].blendmode = AST_REVERSESUBTRACT;
-		else if (fastcmp(val, "modulate"))
-			lines[i].blendmode = AST_MODULATE;
-		if (fastcmp(val, "fog"))
-			lines[i].blendmode = AST_FOG;
+		case TMK_OFFSETX:
+			sides[i].textureoffset = TextmapInt(val)<<FRACBITS;
+			break;
+		case TMK_OFFSETY:
+			sides[i].rowoffset = TextmapInt(val)<<FRACBITS;
+			break;
+		case TMK_TEXTURETOP:
+			sides[i].toptexture = R_TextureNumForName(std::string(val).c_str());
+			break;
+		case TMK_TEXTUREBOTTOM:
+			sides[i].bottomtexture = R_TextureNumForName(std::string(val).c_str());
+			break;
+		case TMK_TEXTUREMIDDLE:
+			sides[i].midtexture = R_TextureNumForName(std::string(val).c_str());
+			break;
+		case TMK_SECTOR:
+			P_SetSidedefSector(i, TextmapInt(val));
+			break;
+		case TMK_REPEATCNT:
+			sides[i].repeatcnt = TextmapInt(val);
+			break;
+		default:
+			ParseUserProperty(&sides[i].user, param, val);
+			break;
 	}
-
-	// Flags
-	else if (fastcmp(param, "blocking") && fastcmp("true", val))
-		lines[i].flags |= ML_IMPASSABLE;
-	else if (fastcmp(param, "blockplayers") && fastcmp("true", val))
-		lines[i].flags |= ML_BLOCKPLAYERS;
-	else if (fastcmp(param, "twosided") && fastcmp("true", val))
-		lines[i].flags |= ML_TWOSIDED;
-	else if (fastcmp(param, "dontpegtop") && fastcmp("true", val))
-		lines[i].flags |= ML_DONTPEGTOP;
-	else if (fastcmp(param, "dontpegbottom") && fastcmp("true", val))
-		lines[i].flags |= ML_DONTPEGBOTTOM;
-	else if (fastcmp(param, "skewtd") && fastcmp("true", val))
-		lines[i].flags |= ML_SKEWTD;
-	else if (fastcmp(param, "noclimb") && fastcmp("true", val))
-		lines[i].flags |= ML_NOCLIMB;
-	else if (fastcmp(param, "noskew") && fastcmp("true", val))
-		lines[i].flags |= ML_NOSKEW;
-	else if (fastcmp(param, "midpeg") && fastcmp("true", val))
-		lines[i].flags |= ML_MIDPEG;
-	else if (fastcmp(param, "midsolid") && fastcmp("true", val))
-		lines[i].flags |= ML_MIDSOLID;
-	else if (fastcmp(param, "wrapmidtex") && fastcmp("true", val))
-		lines[i].flags |= ML_WRAPMIDTEX;
-	else if (fastcmp(param, "blockmonsters") && fastcmp("true", val))
-		lines[i].flags |= ML_BLOCKMONSTERS;
-	else if (fastcmp(param, "nonet") && fastcmp("true", val))
-		lines[i].flags |= ML_NONET;
-	else if (fastcmp(param, "netonly") && fastcmp("true", val))
-		lines[i].flags |= ML_NETONLY;
-	else if (fastcmp(param, "notbouncy") && fastcmp("true", val))
-		lines[i].flags |= ML_NOTBOUNCY;
-	else if (fastcmp(param, "transfer") && fastcmp("true", val))
-		lines[i].flags |= ML_TFERLINE;
-	// Activation flags
-	else if (fastcmp(param, "repeatspecial") && fastcmp("true", val))
-		lines[i].activation |= SPAC_REPEATSPECIAL;
-	else if (fastcmp(param, "playercross") && fastcmp("true", val))
-		lines[i].activation |= SPAC_CROSS;
-	else if (fastcmp(param, "monstercross") && fastcmp("true", val))
-		lines[i].activation |= SPAC_CROSSMONSTER;
-	else if (fastcmp(param, "missilecross") && fastcmp("true", val))
-		lines[i].activation |= SPAC_CROSSMISSILE;
-	else if (fastcmp(param, "playerpush") && fastcmp("true", val))
-		lines[i].activation |= SPAC_PUSH;
-	else if (fastcmp(param, "monsterpush") && fastcmp("true", val))
-		lines[i].activation |= SPAC_PUSHMONSTER;
-	else if (fastcmp(param, "impact") && fastcmp("true", val))
-		lines[i].activation |= SPAC_IMPACT;
-	else
-		ParseUserProperty(&lines[i].user, param, val);
 }
 
-static void ParseTextmapThingParameter(UINT32 i, const char *param, const char *val)
+static void ParseTextmapLinedefParameter(UINT32 i, std::string_view param, std::string_view val)
 {
-	if (fastcmp(param, "id"))
-		mapthings[i].tid = atol(val);
-	else if (fastcmp(param, "x"))
-		mapthings[i].x = atol(val);
-	else if (fastcmp(param, "y"))
-		mapthings[i].y = atol(val);
-	else if (fastcmp(param, "height"))
-		mapthings[i].z = atol(val);
-	else if (fastcmp(param, "angle"))
-		mapthings[i].angle = atol(val);
-	else if (fastcmp(param, "pitch"))
-		mapthings[i].pitch = atol(val);
-	else if (fastcmp(param, "roll"))
-		mapthings[i].roll = atol(val);
-	else if (fastcmp(param, "type"))
-		mapthings[i].type = atol(val);
-	else if (fastcmp(param, "scale"))
-	{
-		if (udmf_version < 1)
-		{
-			mapthings[i].scale = FLOAT_TO_FIXED(atof(val));
-		}
-		else
-		{
-			mapthings[i].spritexscale = mapthings[i].spriteyscale = FLOAT_TO_FIXED(atof(val));
-		}
-	}
-	else if (fastcmp(param, "scalex"))
-	{
-		if (udmf_version < 1)
-		{
-			mapthings[i].scale = FLOAT_TO_FIXED(atof(val));
-		}
-		else
-		{
-			mapthings[i].spritexscale = FLOAT_TO_FIXED(atof(val));
-		}
-	}
-	else if (fastcmp(param, "scaley"))
-	{
-		if (udmf_version < 1)
-		{
-			mapthings[i].scale = FLOAT_TO_FIXED(atof(val));
-		}
-		else
-		{
-			mapthings[i].spriteyscale = FLOAT_TO_FIXED(atof(val));
-		}
-	}
-	else if (fastcmp(param, "mobjscale"))
-		mapthings[i].scale = FLOAT_TO_FIXED(atof(val));
-	// Flags
-	else if (fastcmp(param, "flip") && fastcmp("true", val))
-		mapthings[i].options |= MTF_OBJECTFLIP;
+	size_t argnum;
 
-	else if (fastcmp(param, "special"))
-		mapthings[i].special = atol(val);
-	else if (fastcmp(param, "foflayer"))
-		mapthings[i].layer = atol(val);
-	else if (fastncmp(param, "stringarg", 9) && strlen(param) > 9)
-	{
-		if (udmf_version < 1)
-		{
-			size_t argnum = atol(param + 9);
-			if (argnum >= NUM_MAPTHING_STRINGARGS)
-				return;
-			size_t len = strlen(val);
-			mapthings[i].thing_stringargs[argnum] = static_cast<char*>(Z_Malloc(len + 1, PU_LEVEL, NULL));
-			M_Memcpy(mapthings[i].thing_stringargs[argnum], val, len);
-			mapthings[i].thing_stringargs[argnum][len] = '\0';
-		}
-		else
-		{
-			size_t argnum = atol(param + 9);
-			if (argnum >= NUM_SCRIPT_STRINGARGS)
-				return;
-			size_t len = strlen(val);
-			mapthings[i].script_stringargs[argnum] = static_cast<char*>(Z_Malloc(len + 1, PU_LEVEL, NULL));
-			M_Memcpy(mapthings[i].script_stringargs[argnum], val, len);
-			mapthings[i].script_stringargs[argnum][len] = '\0';
-		}
-	}
-	else if (fastncmp(param, "arg", 3) && strlen(param) > 3)
-	{
-		if (udmf_version < 1)
-		{
-			size_t argnum = atol(param + 3);
-			if (argnum >= NUM_MAPTHING_ARGS)
-				return;
-			mapthings[i].thing_args[argnum] = atol(val);
-		}
-		else
-		{
-			size_t argnum = atol(param + 3);
-			if (argnum >= NUM_SCRIPT_ARGS)
-				return;
-			mapthings[i].script_args[argnum] = atol(val);
-		}
-	}
-	else if (fastncmp(param, "thingstringarg", 14) && strlen(param) > 14)
+	switch (TextmapKeyword(param))
 	{
-		size_t argnum = atol(param + 14);
-		if (argnum >= NUM_MAPTHING_STRINGARGS)
-			return;
-		size_t len = strlen(val);
-		mapthings[i].thing_stringargs[argnum] = static_cast<char*>(Z_Malloc(len + 1, PU_LEVEL, NULL));
-		M_Memcpy(mapthings[i].thing_stringargs[argnum], val, len);
-		mapthings[i].thing_stringargs[argnum][len] = '\0';
+		case TMK_ID:
+			Tag_FSet(&lines[i].tags, TextmapInt(val));
+			break;
+		case TMK_MOREIDS:
+			{
+				TextmapAddTags(&lines[i].tags, val);
+				break;
+			}
+		case TMK_SPECIAL:
+			lines[i].special = TextmapInt(val);
+			break;
+		case TMK_V1:
+			P_SetLinedefV1(i, TextmapInt(val));
+			break;
+		case TMK_V2:
+			P_SetLinedefV2(i, TextmapInt(val));
+			break;
+		case TMK_SIDEFRONT:
+			lines[i].sidenum[0] = TextmapInt(val);
+			break;
+		case TMK_SIDEBACK:
+			lines[i].sidenum[1] = TextmapInt(val);
+			break;
+		case TMK_ALPHA:
+			lines[i].alpha = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		case TMK_BLENDMODE:
+		case TMK_RENDERSTYLE:
+			if (val == "translucent")
+				lines[i].blendmode = AST_COPY;
+			else if (val == "add")
+				lines[i].blendmode = AST_ADD;
+			else if (val == "subtract")
+				lines[i].blendmode = AST_SUBTRACT;
+			else if (val == "reversesubtract")
+				lines[i].blendmode = AST_REVERSESUBTRACT;
+			else if (val == "modulate")
+				lines[i].blendmode = AST_MODULATE;
+			if (val == "fog")
+				lines[i].blendmode = AST_FOG;
+			break;
+		// Flags
+		case TMK_BLOCKING:
+			if (val == "true")
+				lines[i].flags |= ML_IMPASSABLE;
+			break;
+		case TMK_BLOCKPLAYERS:
+			if (val == "true")
+				lines[i].flags |= ML_BLOCKPLAYERS;
+			break;
+		case TMK_TWOSIDED:
+			if (val == "true")
+				lines[i].flags |= ML_TWOSIDED;
+			break;
+		case TMK_DONTPEGTOP:
+			if (val == "true")
+				lines[i].flags |= ML_DONTPEGTOP;
+			break;
+		case TMK_DONTPEGBOTTOM:
+			if (val == "true")
+				lines[i].flags |= ML_DONTPEGBOTTOM;
+			break;
+		case TMK_SKEWTD:
+			if (val == "true")
+				lines[i].flags |= ML_SKEWTD;
+			break;
+		case TMK_NOCLIMB:
+			if (val == "true")
+				lines[i].flags |= ML_NOCLIMB;
+			break;
+		case TMK_NOSKEW:
+			if (val == "true")
+				lines[i].flags |= ML_NOSKEW;
+			break;
+		case TMK_MIDPEG:
+			if (val == "true")
+				lines[i].flags |= ML_MIDPEG;
+			break;
+		case TMK_MIDSOLID:
+			if (val == "true")
+				lines[i].flags |= ML_MIDSOLID;
+			break;
+		case TMK_WRAPMIDTEX:
+			if (val == "true")
+				lines[i].flags |= ML_WRAPMIDTEX;
+			break;
+		case TMK_BLOCKMONSTERS:
+			if (val == "true")
+				lines[i].flags |= ML_BLOCKMONSTERS;
+			break;
+		case TMK_NONET:
+			if (val == "true")
+				lines[i].flags |= ML_NONET;
+			break;
+		case TMK_NETONLY:
+			if (val == "true")
+				lines[i].flags |= ML_NETONLY;
+			break;
+		case TMK_NOTBOUNCY:
+			if (val == "true")
+				lines[i].flags |= ML_NOTBOUNCY;
+			break;
+		case TMK_TRANSFER:
+			if (val == "true")
+				lines[i].flags |= ML_TFERLINE;
+			break;
+		// Activation flags
+		case TMK_REPEATSPECIAL:
+			if (val == "true")
+				lines[i].activation |= SPAC_REPEATSPECIAL;
+			break;
+		case TMK_PLAYERCROSS:
+			if (val == "true")
+				lines[i].activation |= SPAC_CROSS;
+			break;
+		case TMK_MONSTERCROSS:
+			if (val == "true")
+				lines[i].activation |= SPAC_CROSSMONSTER;
+			break;
+		case TMK_MISSILECROSS:
+			if (val == "true")
+				lines[i].activation |= SPAC_CROSSMISSILE;
+			break;
+		case TMK_PLAYERPUSH:
+			if (val == "true")
+				lines[i].activation |= SPAC_PUSH;
+			break;
+		case TMK_MONSTERPUSH:
+			if (val == "true")
+				lines[i].activation |= SPAC_PUSHMONSTER;
+			break;
+		case TMK_IMPACT:
+			if (val == "true")
+				lines[i].activation |= SPAC_IMPACT;
+			break;
+		default:
+			if (TextmapArgParam(param, "stringarg", &argnum))
+			{
+				if (argnum >= NUM_SCRIPT_STRINGARGS)
+					return;
+				lines[i].stringargs[argnum] = TextmapString(val);
+			}
+			else if (TextmapArgParam(param, "arg", &argnum))
+			{
+				if (argnum >= NUM_SCRIPT_ARGS)
+					return;
+				lines[i].args[argnum] = TextmapInt(val);
+			}
+			else
+				ParseUserProperty(&lines[i].user, param, val);
+			break;
 	}
-	else if (fastncmp(param, "thingarg", 8) && strlen(param) > 8)
+}
+
+static void ParseTextmapThingParameter(UINT32 i, std::string_view param, std::string_view val)
+{
+	size_t argnum;
+
+	switch (TextmapKeyword(param))
 	{
-		size_t argnum = atol(param + 8);
-		if (argnum >= NUM_MAPTHING_ARGS)
-			return;
-		mapthings[i].thing_args[argnum] = atol(val);
+		case TMK_ID:
+			mapthings[i].tid = TextmapInt(val);
+			break;
+		case TMK_X:
+			mapthings[i].x = TextmapInt(val);
+			break;
+		case TMK_Y:
+			mapthings[i].y = TextmapInt(val);
+			break;
+		case TMK_HEIGHT:
+			mapthings[i].z = TextmapInt(val);
+			break;
+		case TMK_ANGLE:
+			mapthings[i].angle = TextmapInt(val);
+			break;
+		case TMK_PITCH:
+			mapthings[i].pitch = TextmapInt(val);
+			break;
+		case TMK_ROLL:
+			mapthings[i].roll = TextmapInt(val);
+			break;
+		case TMK_TYPE:
+			mapthings[i].type = TextmapInt(val);
+			break;
+		case TMK_SCALE:
+			if (udmf_version < 1)
+			{
+				mapthings[i].scale = FLOAT_TO_FIXED(TextmapFloat(val));
+			}
+			else
+			{
+				mapthings[i].spritexscale = mapthings[i].spriteyscale = FLOAT_TO_FIXED(TextmapFloat(val));
+			}
+			break;
+		case TMK_SCALEX:
+			if (udmf_version < 1)
+			{
+				mapthings[i].scale = FLOAT_TO_FIXED(TextmapFloat(val));
+			}
+			else
+			{
+				mapthings[i].spritexscale = FLOAT_TO_FIXED(TextmapFloat(val));
+			}
+			break;
+		case TMK_SCALEY:
+			if (udmf_version < 1)
+			{
+				mapthings[i].scale = FLOAT_TO_FIXED(TextmapFloat(val));
+			}
+			else
+			{
+				mapthings[i].spriteyscale = FLOAT_TO_FIXED(TextmapFloat(val));
+			}
+			break;
+		case TMK_MOBJSCALE:
+			mapthings[i].scale = FLOAT_TO_FIXED(TextmapFloat(val));
+			break;
+		// Flags
+		case TMK_FLIP:
+			if (val == "true")
+				mapthings[i].options |= MTF_OBJECTFLIP;
+			break;
+		case TMK_SPECIAL:
+			mapthings[i].special = TextmapInt(val);
+			break;
+		case TMK_FOFLAYER:
+			mapthings[i].layer = TextmapInt(val);
+			break;
+		default:
+			if (TextmapArgParam(param, "stringarg", &argnum))
+			{
+				if (udmf_version < 1)
+				{
+					if (argnum >= NUM_MAPTHING_STRINGARGS)
+						return;
+					mapthings[i].thing_stringargs[argnum] = TextmapString(val);
+				}
+				else
+				{
+					if (argnum >= NUM_SCRIPT_STRINGARGS)
+						return;
+					mapthings[i].script_stringargs[argnum] = TextmapString(val);
+				}
+			}
+			else if (TextmapArgParam(param, "arg", &argnum))
+			{
+				if (udmf_version < 1)
+				{
+					if (argnum >= NUM_MAPTHING_ARGS)
+						return;
+					mapthings[i].thing_args[argnum] = TextmapInt(val);
+				}
+				else
+				{
+					if (argnum >= NUM_SCRIPT_ARGS)
+						return;
+					mapthings[i].script_args[argnum] = TextmapInt(val);
+				}
+			}
+			else if (TextmapArgParam(param, "thingstringarg", &argnum))
+			{
+				if (argnum >= NUM_MAPTHING_STRINGARGS)
+					return;
+				mapthings[i].thing_stringargs[argnum] = TextmapString(val);
+			}
+			else if (TextmapArgParam(param, "thingarg", &argnum))
+			{
+				if (argnum >= NUM_MAPTHING_ARGS)
+					return;
+				mapthings[i].thing_args[argnum] = TextmapInt(val);
+			}
+			else
+				ParseUserProperty(&mapthings[i].user, param, val);
+			break;
 	}
-	else
-		ParseUserProperty(&mapthings[i].user, param, val);
 }
 
 /** From a given position table, run a specified parser function through a {}-encapsuled text.
@@ -2118,28 +2668,133 @@ static void ParseTextmapThingParameter(UINT32 i, const char *param, const char *
   * \param Structure number (mapthings, sectors, ...).
   * \param Parser function pointer.
   */
-static void TextmapParse(UINT32 dataPos, size_t num, void (*parser)(UINT32, const char *, const char *))
+static void TextmapParse(UINT32 dataPos, size_t num, void (*parser)(UINT32, std::string_view, std::string_view))
 {
-	const char *param, *val;
+	std::string_view param, val;
 
-	M_TokenizerSetEndPos(dataPos);
-	param = M_TokenizerRead(0);
-	if (!fastcmp(param, "{"))
+	textmapTokenizer.pos = dataPos;
+	if (!TextmapRead(&textmapTokenizer, &param) || param != "{")
 	{
 		CONS_Alert(CONS_WARNING, "Invalid UDMF data capsule!\n");
 		return;
 	}
 
-	while (true)
+	while (TextmapRead(&textmapTokenizer, &param) && param != "}")
 	{
-		param = M_TokenizerRead(0);
-		if (fastcmp(param, "}"))
+		if (!TextmapRead(&textmapTokenizer, &val))
 			break;
-		val = M_TokenizerRead(1);
 		parser(num, param, val);
 	}
 }
 
+static textmapkeyword_t (*textmapBenchLookup)(std::string_view);
+static size_t textmapBenchKeys;
+
+static void TextmapBenchParameter(UINT32 i, std::string_view param, std::string_view val)
+{
+	(void)i;
+	(void)val;
+
+	if (textmapBenchLookup != NULL)
+		textmapBenchKeys += (textmapBenchLookup(param) != TMK_NONE);
+}
+
+static void TextmapBenchBlock(textmapblock_t block, UINT32 pos)
+{
+	(void)block;
+	TextmapParse(pos, 0, TextmapBenchParameter);
+}
+
+// Runs a whole TEXTMAP through the loader's scan and parse, looking up each
+// property name with lookup
+static size_t TextmapBenchPass(const virtlump_t *textmap, textmapkeyword_t (*lookup)(std::string_view))
+{
+	INT32 version = 0;
+
+	textmapTokenizer = {reinterpret_cast<const char *>(textmap->data), textmap->size, 0, false};
+	textmapBenchLookup = lookup;
+	textmapBenchKeys = 0;
+
+	TextmapScan(textmapTokenizer, &version, TextmapBenchBlock);
+
+	textmapTokenizer = {};
+
+	return textmapBenchKeys;
+}
+
+// What the fastcmp chains cost, give or take their order
+static textmapkeyword_t TextmapKeywordLinear(std::string_view param)
+{
+	for (size_t k = 1; k < NUMTEXTMAPKEYWORDS; k++)
+	{
+		if (param == textmapKeywords[k])
+			return static_cast<textmapkeyword_t>(k);
+	}
+
+	return TMK_NONE;
+}
+
+// textmapbench: run the TEXTMAP of every loaded map through the scan, parse and
+// property lookup, which is all of the text handling P_LoadMapData does.
+void Command_TextmapBench_f(void)
+{
+	size_t maps = 0, bytes = 0, keys = 0;
+	precise_t tokenize = 0, hashed = 0, linear = 0;
+
+	// The tokenizer has only one state
+	if (levelloading)
+		return;
+
+	for (INT32 i = 0; i < nummapheaders; i++)
+	{
+		virtres_t *virt;
+		virtlump_t *textmap;
+		precise_t t;
+
+		if (!mapheaderinfo[i] || mapheaderinfo[i]->lumpnum == LUMPERROR)
+			continue;
+
+		virt = vres_GetMap(mapheaderinfo[i]->lumpnum);
+		textmap = vres_Find(virt, "TEXTMAP");
+
+		if (textmap != NULL)
+		{
+			maps++;
+			bytes += textmap->size;
+
+			t = I_GetPreciseTime();
+			TextmapBenchPass(textmap, NULL);
+			tokenize += I_GetPreciseTime() - t;
+
+			t = I_GetPreciseTime();
+			keys += TextmapBenchPass(textmap, TextmapKeyword);
+			hashed += I_GetPreciseTime() - t;
+
+			t = I_GetPreciseTime();
+			TextmapBenchPass(textmap, TextmapKeywordLinear);
+			linear += I_GetPreciseTime() - t;
+		}
+
+		vres_Free(virt);
+	}
+
+	if (maps == 0)
+	{
+		CONS_Printf("No UDMF maps are loaded.\n");
+		return;
+	}
+
+	auto mbps = [bytes](precise_t time)
+	{
+		return time ? (bytes / 1048576.0) / (time / (double)I_GetPrecisePrecision()) : 0.0;
+	};
+
+	CONS_Printf("%s maps, %.2f MB, %s known properties\n", sizeu1(maps), bytes / 1048576.0, sizeu2(keys));
+	CONS_Printf("Scan and parse only:   %7.1f MB/s\n", mbps(tokenize));
+	CONS_Printf("With hashed keywords:  %7.1f MB/s\n", mbps(hashed));
+	CONS_Printf("With compare chain:    %7.1f MB/s\n", mbps(linear));
+}
+
 /** Provides a fix to the flat alignment coordinate transform from standard Textmaps.
  */
 static void TextmapFixFlatOffsets(sector_t *sec)
@@ -3486,10 +4141,10 @@ static boolean P_LoadMapData(const virtres_t *virt)
 	if (udmf) // Count how many entries for each type we got in textmap.
 	{
 		virtlump_t *textmap = vres_Find(virt, "TEXTMAP");
-		M_TokenizerOpen((char *)textmap->data, textmap->size);
-		if (!TextmapCount(textmap->size))
+		textmapTokenizer = {reinterpret_cast<const char *>(textmap->data), textmap->size, 0, false};
+		if (!TextmapCount())
 		{
-			M_TokenizerClose();
+			textmapTokenizer = {};
 			TracyCZoneEnd(__zone);
 			return false;
 		}
@@ -3552,7 +4207,7 @@ static boolean P_LoadMapData(const virtres_t *virt)
 	if (udmf)
 	{
 		P_LoadTextmap();
-		M_TokenizerClose();
+		textmapTokenizer = {};
 	}
 	else
 	{
@@ -4137,6 +4792,23 @@ static void P_ReadBlockMapLump(INT16 *wadblockmaplump, size_t count)
 	}
 }
 
+// Allocates the per-block thing chains for the blockmap in blockmaplump
+static void P_ClearBlockLinks(void)
+{
+	size_t count = sizeof (*blocklinks) * bmapwidth * bmapheight;
+
+	// clear out mobj chains
+	blocklinks = static_cast<mobj_t**>(Z_Calloc(count, PU_LEVEL, NULL));
+	blockmap = blockmaplump + 4;
+
+	// haleyjd 2/22/06: setup polyobject blockmap
+	count = sizeof(*polyblocklinks) * bmapwidth * bmapheight;
+	polyblocklinks = static_cast<polymaplink_t**>(Z_Calloc(count, PU_LEVEL, NULL));
+
+	count = sizeof (*precipblocklinks)* bmapwidth*bmapheight;
+	precipblocklinks = static_cast<precipmobj_t**>(Z_Calloc(count, PU_LEVEL, NULL));
+}
+
 // This needs to be a separate function
 // because making both the WAD and PK3 loading code use
 // the same functions is trickier than it looks for blockmap
@@ -4157,17 +4829,7 @@ static boolean P_LoadBlockMap(UINT8 *data, size_t count)
 	bmapwidth = blockmaplump[2];
 	bmapheight = blockmaplump[3];
 
-	// clear out mobj chains
-	count = sizeof (*blocklinks)* bmapwidth*bmapheight;
-	blocklinks = static_cast<mobj_t**>(Z_Calloc(count, PU_LEVEL, NULL));
-	blockmap = blockmaplump+4;
-
-	// haleyjd 2/22/06: setup polyobject blockmap
-	count = sizeof(*polyblocklinks) * bmapwidth * bmapheight;
-	polyblocklinks = static_cast<polymaplink_t**>(Z_Calloc(count, PU_LEVEL, NULL));
-
-	count = sizeof (*precipblocklinks)* bmapwidth*bmapheight;
-	precipblocklinks = static_cast<precipmobj_t**>(Z_Calloc(count, PU_LEVEL, NULL));
+	P_ClearBlockLinks();
 
 	return true;
 }
@@ -4223,6 +4885,35 @@ static boolean LineInBlock(fixed_t cx1, fixed_t cy1, fixed_t cx2, fixed_t cy2, f
 	return P_BoxOnLineSide(bbox, &testline) == -1;
 }
 
+typedef struct
+{
+	fixed_t orgx, orgy;
+	INT32 width, height;
+	std::vector<INT32> lump; // layout of blockmaplump
+} blockmapbuild_t;
+
+static void P_BlockMapLimits(const vertex_t *verts, size_t numverts, INT32 *minx, INT32 *miny, INT32 *maxx, INT32 *maxy)
+{
+	size_t i;
+
+	*minx = INT32_MAX;
+	*miny = INT32_MAX;
+	*maxx = INT32_MIN;
+	*maxy = INT32_MIN;
+
+	for (i = 0; i < numverts; i++)
+	{
+		if (verts[i].x>>FRACBITS < *minx)
+			*minx = verts[i].x>>FRACBITS;
+		else if (verts[i].x>>FRACBITS > *maxx)
+			*maxx = verts[i].x>>FRACBITS;
+		if (verts[i].y>>FRACBITS < *miny)
+			*miny = verts[i].y>>FRACBITS;
+		else if (verts[i].y>>FRACBITS > *maxy)
+			*maxy = verts[i].y>>FRACBITS;
+	}
+}
+
 //
 // killough 10/98:
 //
@@ -4234,29 +4925,24 @@ static boolean LineInBlock(fixed_t cx1, fixed_t cy1, fixed_t cx2, fixed_t cy2, f
 //
 // Please note: This section of code is not interchangable with TeamTNT's
 // code which attempts to fix the same problem.
-static void P_CreateBlockMap(void)
+//
+// No longer used to load levels; blockmapbench and PARANOIA
+// builds check P_BuildBlockMap against it.
+static blockmapbuild_t P_BuildBlockMapReference(const vertex_t *verts, size_t numverts, const line_t *lns, size_t numlns)
 {
+	blockmapbuild_t out;
 	size_t i;
-	fixed_t minx = INT32_MAX, miny = INT32_MAX, maxx = INT32_MIN, maxy = INT32_MIN;
+	INT32 bmapwidth, bmapheight;
+	fixed_t minx, miny, maxx, maxy;
 	// First find limits of map
 
-	for (i = 0; i < numvertexes; i++)
-	{
-		if (vertexes[i].x>>FRACBITS < minx)
-			minx = vertexes[i].x>>FRACBITS;
-		else if (vertexes[i].x>>FRACBITS > maxx)
-			maxx = vertexes[i].x>>FRACBITS;
-		if (vertexes[i].y>>FRACBITS < miny)
-			miny = vertexes[i].y>>FRACBITS;
-		else if (vertexes[i].y>>FRACBITS > maxy)
-			maxy = vertexes[i].y>>FRACBITS;
-	}
+	P_BlockMapLimits(verts, numverts, &minx, &miny, &maxx, &maxy);
 
 	// Save blockmap parameters
-	bmaporgx = minx << FRACBITS;
-	bmaporgy = miny << FRACBITS;
-	bmapwidth = ((maxx-minx) >> MAPBTOFRAC) + 1;
-	bmapheight = ((maxy-miny) >> MAPBTOFRAC)+ 1;
+	out.orgx = minx << FRACBITS;
+	out.orgy = miny << FRACBITS;
+	out.width = bmapwidth = ((maxx-minx) >> MAPBTOFRAC) + 1;
+	out.height = bmapheight = ((maxy-miny) >> MAPBTOFRAC)+ 1;
 
 	// Compute blockmap, which is stored as a 2d array of variable-sized lists.
 	//
@@ -4286,17 +4972,17 @@ static void P_CreateBlockMap(void)
 		bmap_t *bmap = static_cast<bmap_t*>(calloc(tot, sizeof (*bmap))); // array of blocklists
 		boolean straight;
 
-		if (bmap == NULL) I_Error("%s: Out of memory making blockmap", "P_CreateBlockMap");
+		if (bmap == NULL) I_Error("%s: Out of memory making blockmap", "P_BuildBlockMapReference");
 
-		for (i = 0; i < numlines; i++)
+		for (i = 0; i < numlns; i++)
 		{
 			// starting coordinates
-			INT32 x = (lines[i].v1->x>>FRACBITS) - minx;
-			INT32 y = (lines[i].v1->y>>FRACBITS) - miny;
+			INT32 x = (lns[i].v1->x>>FRACBITS) - minx;
+			INT32 y = (lns[i].v1->y>>FRACBITS) - miny;
 			INT32 bxstart, bxend, bystart, byend, v2x, v2y, curblockx, curblocky;
 
-			v2x = lines[i].v2->x>>FRACBITS;
-			v2y = lines[i].v2->y>>FRACBITS;
+			v2x = lns[i].v2->x>>FRACBITS;
+			v2y = lns[i].v2->y>>FRACBITS;
 
 			// Draw a "box" around the line.
 			bxstart = (x >> MAPBTOFRAC);
@@ -4326,13 +5012,13 @@ static void P_CreateBlockMap(void)
 			// This fixes the error where straight lines
 			// directly on a blockmap boundary would not
 			// be included in the proper blocks.
-			if (lines[i].v1->y == lines[i].v2->y)
+			if (lns[i].v1->y == lns[i].v2->y)
 			{
 				straight = true;
 				bystart--;
 				byend++;
 			}
-			else if (lines[i].v1->x == lines[i].v2->x)
+			else if (lns[i].v1->x == lns[i].v2->x)
 			{
 				straight = true;
 				bxstart--;
@@ -4364,7 +5050,7 @@ static void P_CreateBlockMap(void)
 						bmap[b].nalloc *= 2;
 					bmap[b].list = static_cast<INT32*>(Z_Realloc(bmap[b].list, bmap[b].nalloc * sizeof (*bmap->list), PU_CACHE, &bmap[b].list));
 					if (!bmap[b].list)
-						I_Error("Out of Memory in P_CreateBlockMap");
+						I_Error("Out of Memory in P_BuildBlockMapReference");
 				}
 
 				// Add linedef to end of list
@@ -4386,11 +5072,12 @@ static void P_CreateBlockMap(void)
 					count += bmap[i].n + 2; // 1 header word + 1 trailer word + blocklist
 
 			// Allocate blockmap lump with computed count
-			blockmaplump = static_cast<INT32*>(Z_Calloc(sizeof (*blockmaplump) * count, PU_LEVEL, NULL));
+			out.lump.assign(count, 0);
 		}
 
 		// Now compress the blockmap.
 		{
+			INT32 *blockmaplump = out.lump.data();
 			size_t ndx = tot += 4; // Advance index to start of linedef lists
 			bmap_t *bp = bmap; // Start of uncompressed blockmap
 
@@ -4413,19 +5100,439 @@ static void P_CreateBlockMap(void)
 			free(bmap); // Free uncompressed blockmap
 		}
 	}
+
+	return out;
+}
+
+// Calls f with every block P_BuildBlockMapReference would put the line in,
+// in no particular order. Rather than testing every block in the line's box,
+// each column of the box only tests the rows the line can pass through, so
+// the work follows the line's length instead of its box's area. Every
+// block still gets LineInBlock's test, so the result is the same, block
+// for block.
+template <typename F>
+static void P_ForEachLineBlock(const line_t *ld, INT32 minx, INT32 miny, INT32 bmapwidth, size_t tot, F&& f)
+{
+	INT32 x = (ld->v1->x>>FRACBITS) - minx;
+	INT32 y = (ld->v1->y>>FRACBITS) - miny;
+	INT32 v2x = (ld->v2->x>>FRACBITS) - minx;
+	INT32 v2y = (ld->v2->y>>FRACBITS) - miny;
+	INT32 bxstart = std::min(x, v2x) >> MAPBTOFRAC;
+	INT32 bxend = std::max(x, v2x) >> MAPBTOFRAC;
+	INT32 bystart = std::min(y, v2y) >> MAPBTOFRAC;
+	INT32 byend = std::max(y, v2y) >> MAPBTOFRAC;
+	boolean straight = false;
+	boolean exact, walk;
+	INT32 curblockx, curblocky;
+
+	// Catch straight lines, same as the reference
+	if (ld->v1->y == ld->v2->y)
+	{
+		straight = true;
+		bystart--;
+		byend++;
+	}
+	else if (ld->v1->x == ld->v2->x)
+	{
+		straight = true;
+		bxstart--;
+		bxend++;
+	}
+
+	// LineInBlock works in fixed point, so beyond 32767 units its
+	// answers overflow and only LineInBlock itself reproduces them.
+	// Below that, it's the same test as inblock, just scaled.
+	exact = !straight && x != v2x
+		&& bxstart >= 0 && bystart >= 0
+		&& ((bxend + 1) << MAPBTOFRAC) <= INT16_MAX
+		&& ((byend + 1) << MAPBTOFRAC) <= INT16_MAX;
+
+	// Short boxes have nothing to skip.
+	walk = exact && byend - bystart > 2;
+
+	const INT64 dx = v2x - x;
+	const INT64 dy = v2y - y;
+	const boolean negative = (dx > 0) ^ (dy > 0);
+
+	// P_PointOnLineSide, for a line with dx != 0
+	auto side = [&](INT64 px, INT64 py) -> boolean
+	{
+		if (!dy)
+			return py <= y ? dx < 0 : dx > 0;
+
+		return (py - y) * dx >= dy * (px - x);
+	};
+
+	auto inblock = [&](INT32 bx1, INT32 by1) -> boolean
+	{
+		const INT32 bx2 = bx1 + MAPBLOCKUNITS;
+		const INT32 by2 = by1 + MAPBLOCKUNITS;
+
+		// Trivial rejection
+		if ((x < bx1 && v2x < bx1) || (x > bx2 && v2x > bx2)
+			|| (y < by1 && v2y < by1) || (y > by2 && v2y > by2))
+			return false;
+
+		if (negative)
+			return side(bx1, by1) != side(bx2, by2);
+
+		return side(bx2, by1) != side(bx1, by2);
+	};
+
+	// Where the infinite line crosses the left edge of the column
+	INT64 yleft = walk ? y + dy * ((INT64)(bxstart << MAPBTOFRAC) - x) / dx : 0;
+
+	for (curblockx = bxstart; curblockx <= bxend; curblockx++)
+	{
+		INT32 rowstart = bystart;
+		INT32 rowend = byend;
+
+		if (walk)
+		{
+			// The rows between where the line enters and leaves the
+			// column, rounded outwards. LineInBlock needs the line to
+			// cross the block, so blocks outside them can't pass.
+			const INT64 yright = y + dy * ((INT64)((curblockx + 1) << MAPBTOFRAC) - x) / dx;
+			const INT64 lo = std::min(yleft, yright) - 1;
+			const INT64 hi = std::max(yleft, yright) + 1;
+
+			rowstart = std::max<INT64>(rowstart, (lo >> MAPBTOFRAC) - 1);
+			rowend = std::min<INT64>(rowend, hi >> MAPBTOFRAC);
+			yleft = yright;
+		}
+
+		for (curblocky = rowstart; curblocky <= rowend; curblocky++)
+		{
+			size_t b = curblocky * bmapwidth + curblockx;
+
+			if (b >= tot)
+				continue;
+
+			if (exact)
+			{
+				if (!inblock(curblockx << MAPBTOFRAC, curblocky << MAPBTOFRAC))
+					continue;
+			}
+			else if (!straight && !(LineInBlock((fixed_t)x, (fixed_t)y, (fixed_t)v2x, (fixed_t)v2y, (fixed_t)(curblockx << MAPBTOFRAC), (fixed_t)(curblocky << MAPBTOFRAC))))
+				continue;
+
+			f(b);
+		}
+	}
+}
+
+// Lines per thread pool task, below which threading costs more than it saves
+#define BLOCKMAPTASKLINES 2048
+
+// Builds the same blockmap as P_BuildBlockMapReference.
+//
+// The lines are split into chunks which are binned in parallel. Each
+// chunk records (block, line) pairs and counts lines per block. Blocks
+// then get their offset in the lump from those counts, CSR style, and
+// each chunk gets its own slice of every block's list, so the chunks
+// scatter their lines in parallel without sharing anything. Lists hold
+// their lines in descending order, as the reference's do.
+static blockmapbuild_t P_BuildBlockMap(const vertex_t *verts, size_t numverts, const line_t *lns, size_t numlns)
+{
+	typedef std::pair<UINT32, INT32> blockline_t;
+
+	blockmapbuild_t out;
+	INT32 minx, miny, maxx, maxy;
+	size_t tot, chunks, numpairs, ndx, b, c;
+
+	P_BlockMapLimits(verts, numverts, &minx, &miny, &maxx, &maxy);
+
+	out.orgx = minx << FRACBITS;
+	out.orgy = miny << FRACBITS;
+	out.width = ((maxx-minx) >> MAPBTOFRAC) + 1;
+	out.height = ((maxy-miny) >> MAPBTOFRAC) + 1;
+
+	tot = out.width * out.height;
+
+	chunks = 1;
+	if (srb2::g_main_threadpool)
+		chunks = std::clamp<size_t>(numlns / BLOCKMAPTASKLINES, 1, srb2::g_main_threadpool->threads() + 1);
+
+	std::vector<std::vector<UINT32>> counts(chunks, std::vector<UINT32>(tot));
+	std::vector<std::vector<blockline_t>> pairs(chunks);
+
+	auto forchunks = [chunks](auto&& fn)
+	{
+		if (chunks == 1)
+		{
+			fn(0);
+			return;
+		}
+
+		srb2::g_main_threadpool->begin_sema();
+		for (size_t i = 0; i < chunks; i++)
+			srb2::g_main_threadpool->schedule([&fn, i]() { fn(i); });
+		srb2::ThreadPool::Sema sema = srb2::g_main_threadpool->end_sema();
+		srb2::g_main_threadpool->notify_sema(sema);
+		srb2::g_main_threadpool->wait_sema(sema);
+	};
+
+	// Bin each chunk's lines, last line first
+	forchunks([&](size_t chunk)
+	{
+		const size_t start = numlns * chunk / chunks;
+		const size_t end = numlns * (chunk + 1) / chunks;
+		std::vector<UINT32>& n = counts[chunk];
+		std::vector<blockline_t>& found = pairs[chunk];
+
+		found.reserve((end - start) * 2);
+
+		for (size_t i = end; i-- > start;)
+		{
+			P_ForEachLineBlock(&lns[i], minx, miny, out.width, tot, [&](size_t block)
+			{
+				n[block]++;
+				found.emplace_back((UINT32)block, (INT32)i);
+			});
+		}
+	});
+
+	numpairs = 0;
+	for (c = 0; c < chunks; c++)
+		numpairs += pairs[c].size();
+
+	// Lay out the lump like the reference: 4 unused words, the block
+	// offsets, a shared empty list, then a header, lines and trailer
+	// for each non-empty block. Turn each chunk's counts into where
+	// its lines go, later chunks first since they hold higher lines.
+	out.lump.assign(tot + 6 + numpairs + 2 * std::min(tot, numpairs), 0);
+	out.lump[tot + 5] = -1;
+	ndx = tot + 6;
+
+	for (b = 0; b < tot; b++)
+	{
+		size_t cursor = ndx + 1;
+
+		for (c = chunks; c-- > 0;)
+		{
+			UINT32 n = counts[c][b];
+			counts[c][b] = (UINT32)cursor;
+			cursor += n;
+		}
+
+		if (cursor == ndx + 1)
+		{
+			out.lump[b + 4] = (INT32)(tot + 4);
+			continue;
+		}
+
+		out.lump[b + 4] = (INT32)ndx;
+		out.lump[cursor] = -1;
+		ndx = cursor + 1;
+	}
+
+	out.lump.resize(ndx);
+
+	// Scatter
+	forchunks([&](size_t chunk)
+	{
+		std::vector<UINT32>& cursor = counts[chunk];
+		INT32 *lump = out.lump.data();
+
+		for (const blockline_t& p : pairs[chunk])
+			lump[cursor[p.first]++] = p.second;
+	});
+
+	return out;
+}
+
+static boolean P_BlockMapsMatch(const blockmapbuild_t& a, const blockmapbuild_t& b)
+{
+	return a.orgx == b.orgx && a.orgy == b.orgy && a.width == b.width && a.height == b.height && a.lump == b.lump;
+}
+
+// Builds a blockmap for maps without a usable BLOCKMAP lump.
+//
+// Returns the size of blockmaplump, in INT32s.
+static size_t P_CreateBlockMap(void)
+{
+	blockmapbuild_t build = P_BuildBlockMap(vertexes, numvertexes, lines, numlines);
+
+#ifdef PARANOIA
+	// The blockmap decides collision, so development builds check every
+	// map they generate one for against the old builder.
+	if (!P_BlockMapsMatch(build, P_BuildBlockMapReference(vertexes, numvertexes, lines, numlines)))
+		I_Error("P_CreateBlockMap: %s's blockmap differs from P_BuildBlockMapReference's", G_BuildMapName(gamemap));
+#endif
+
+	bmaporgx = build.orgx;
+	bmaporgy = build.orgy;
+	bmapwidth = build.width;
+	bmapheight = build.height;
+
+	blockmaplump = static_cast<INT32*>(Z_Malloc(build.lump.size() * sizeof (*blockmaplump), PU_LEVEL, NULL));
+	M_Memcpy(blockmaplump, build.lump.data(), build.lump.size() * sizeof (*blockmaplump));
+
+	P_ClearBlockLinks();
+
+	return build.lump.size();
+}
+
+// Reads just the vertices and line ends of a map, for blockmapbench.
+// Only v1 and v2 of the lines are set.
+static boolean P_BlockMapBenchGeometry(const virtres_t *virt, std::vector<vertex_t>& verts, std::vector<line_t>& lns)
+{
+	virtlump_t *textmap = vres_Find(virt, "TEXTMAP");
+	std::vector<std::pair<size_t, size_t>> ends;
+	size_t i;
+
+	verts.clear();
+	lns.clear();
+
+	if (textmap)
+	{
+		enum { BLOCK_OTHER, BLOCK_VERTEX, BLOCK_LINEDEF } block = BLOCK_OTHER;
+		textmaptokenizer_t tk = {reinterpret_cast<const char *>(textmap->data), textmap->size, 0, false};
+		std::string_view tkn, val;
+		INT32 depth = 0;
+
+		while (TextmapRead(&tk, &tkn))
+		{
+			if (tkn == "{")
+				depth++;
+			else if (tkn == "}")
+				depth--;
+			else if (depth == 0)
+			{
+				block = BLOCK_OTHER;
+
+				if (tkn == "vertex")
+				{
+					block = BLOCK_VERTEX;
+					verts.push_back({});
+				}
+				else if (tkn == "linedef")
+				{
+					block = BLOCK_LINEDEF;
+					ends.emplace_back(0, 0);
+				}
+			}
+			else if (TextmapRead(&tk, &val))
+			{
+				switch (block == BLOCK_OTHER ? TMK_NONE : TextmapKeyword(tkn))
+				{
+					case TMK_X:
+						if (block == BLOCK_VERTEX)
+							verts.back().x = FLOAT_TO_FIXED(TextmapFloat(val));
+						break;
+					case TMK_Y:
+						if (block == BLOCK_VERTEX)
+							verts.back().y = FLOAT_TO_FIXED(TextmapFloat(val));
+						break;
+					case TMK_V1:
+						if (block == BLOCK_LINEDEF)
+							ends.back().first = TextmapInt(val);
+						break;
+					case TMK_V2:
+						if (block == BLOCK_LINEDEF)
+							ends.back().second = TextmapInt(val);
+						break;
+					default:
+						break;
+				}
+			}
+		}
+	}
+	else
+	{
+		virtlump_t *virtvertexes = vres_Find(virt, "VERTEXES");
+		virtlump_t *virtlines = vres_Find(virt, "LINEDEFS");
+
+		if (!virtvertexes || !virtlines)
+			return false;
+
+		const mapvertex_t *mv = (const mapvertex_t *)virtvertexes->data;
+		const maplinedef_t *mld = (const maplinedef_t *)virtlines->data;
+
+		verts.resize(virtvertexes->size / sizeof (*mv));
+		for (i = 0; i < verts.size(); i++)
+		{
+			verts[i].x = SHORT(mv[i].x)<<FRACBITS;
+			verts[i].y = SHORT(mv[i].y)<<FRACBITS;
+		}
+
+		for (i = 0; i < virtlines->size / sizeof (*mld); i++)
+			ends.emplace_back((UINT16)SHORT(mld[i].v1), (UINT16)SHORT(mld[i].v2));
+	}
+
+	lns.resize(ends.size());
+	for (i = 0; i < ends.size(); i++)
+	{
+		if (ends[i].first >= verts.size() || ends[i].second >= verts.size())
+			return false;
+
+		lns[i].v1 = &verts[ends[i].first];
+		lns[i].v2 = &verts[ends[i].second];
+	}
+
+	return !verts.empty();
+}
+
+// blockmapbench: build the blockmap of every loaded map with both builders,
+// timing them and checking that they agree.
+void Command_BlockMapBench_f(void)
+{
+	std::vector<vertex_t> verts;
+	std::vector<line_t> lns;
+	size_t maps = 0, mismatches = 0, totlines = 0;
+	precise_t reference = 0, fast = 0;
+
+	// The tokenizer has only one state
+	if (levelloading)
+		return;
+
+	for (INT32 i = 0; i < nummapheaders; i++)
 	{
-		size_t count = sizeof (*blocklinks) * bmapwidth * bmapheight;
-		// clear out mobj chains (copied from from P_LoadBlockMap)
-		blocklinks = static_cast<mobj_t**>(Z_Calloc(count, PU_LEVEL, NULL));
-		blockmap = blockmaplump + 4;
+		virtres_t *virt;
+		boolean ok;
+
+		if (!mapheaderinfo[i] || mapheaderinfo[i]->lumpnum == LUMPERROR)
+			continue;
 
-		// haleyjd 2/22/06: setup polyobject blockmap
-		count = sizeof(*polyblocklinks) * bmapwidth * bmapheight;
-		polyblocklinks = static_cast<polymaplink_t**>(Z_Calloc(count, PU_LEVEL, NULL));
+		virt = vres_GetMap(mapheaderinfo[i]->lumpnum);
+		ok = P_BlockMapBenchGeometry(virt, verts, lns);
+		vres_Free(virt);
+
+		if (!ok)
+			continue;
+
+		precise_t t = I_GetPreciseTime();
+		blockmapbuild_t a = P_BuildBlockMapReference(verts.data(), verts.size(), lns.data(), lns.size());
+		reference += I_GetPreciseTime() - t;
+
+		t = I_GetPreciseTime();
+		blockmapbuild_t b = P_BuildBlockMap(verts.data(), verts.size(), lns.data(), lns.size());
+		fast += I_GetPreciseTime() - t;
+
+		maps++;
+		totlines += lns.size();
+
+		if (!P_BlockMapsMatch(a, b))
+		{
+			CONS_Printf("%s: blockmaps differ\n", mapheaderinfo[i]->lumpname);
+			mismatches++;
+		}
+	}
 
-		count = sizeof (*precipblocklinks)* bmapwidth*bmapheight;
-		precipblocklinks = static_cast<precipmobj_t**>(Z_Calloc(count, PU_LEVEL, NULL));
+	if (maps == 0)
+	{
+		CONS_Printf("No maps are loaded.\n");
+		return;
 	}
+
+	auto ms = [](precise_t time)
+	{
+		return time * 1000.0 / I_GetPrecisePrecision();
+	};
+
+	CONS_Printf("%s maps, %s lines, %s mismatched\n", sizeu1(maps), sizeu2(totlines), sizeu3(mismatches));
+	CONS_Printf("Reference builder: %8.2f ms\n", ms(reference));
+	CONS_Printf("Fast builder:      %8.2f ms\n", ms(fast));
 }
 
 // PK3 version
@@ -4444,6 +5551,158 @@ static void P_LoadReject(UINT8 *data, size_t count)
 	}
 }
 
+//
+// Blockmap cache
+//
+// UDMF maps have no BLOCKMAP lump, so their blockmap is built on
+// every load. The result only depends on the vertices and lines,
+// so it's saved under srb2home, named after the map MD5, and read
+// back the next time the same map is loaded.
+//
+
+#define BLOCKMAPCACHEVERSION 1
+
+typedef struct
+{
+	char magic[4]; // "BMAP"
+	UINT32 version; // BLOCKMAPCACHEVERSION
+	char revision[32]; // comprevision of the build that wrote it
+	UINT64 geometry; // P_BlockMapGeometryHash
+	fixed_t orgx, orgy;
+	INT32 width, height;
+	UINT32 lumpsize; // INT32s of blockmaplump following the header
+} blockmapcache_t;
+
+static std::string P_BlockMapCachePath(void)
+{
+	std::string name;
+
+	for (size_t i = 0; i < sizeof mapmd5; i++)
+		name += fmt::format("{:02x}", mapmd5[i]);
+
+	return fmt::format("{}" PATHSEP "cache" PATHSEP "blockmap" PATHSEP "{}.bmap", srb2home, name);
+}
+
+// The MD5 of a binary map doesn't cover its vertices, and collisions
+// shouldn't make for broken collision, so the geometry the blockmap
+// was built from is checked as well.
+static UINT64 P_BlockMapGeometryHash(void)
+{
+	UINT64 hash = 14695981039346656037ULL;
+	size_t i;
+
+	auto mix = [&hash](INT32 v)
+	{
+		for (int b = 0; b < 32; b += 8)
+		{
+			hash ^= (UINT8)(v >> b);
+			hash *= 1099511628211ULL;
+		}
+	};
+
+	mix((INT32)numvertexes);
+	mix((INT32)numlines);
+
+	for (i = 0; i < numvertexes; i++)
+	{
+		mix(vertexes[i].x);
+		mix(vertexes[i].y);
+	}
+
+	for (i = 0; i < numlines; i++)
+	{
+		mix((INT32)(lines[i].v1 - vertexes));
+		mix((INT32)(lines[i].v2 - vertexes));
+	}
+
+	return hash;
+}
+
+static void P_FillBlockMapCacheHeader(blockmapcache_t *header, UINT64 geometry)
+{
+	memset(header, 0, sizeof *header);
+	memcpy(header->magic, "BMAP", 4);
+	header->version = BLOCKMAPCACHEVERSION;
+	strlcpy(header->revision, comprevision, sizeof header->revision);
+	header->geometry = geometry;
+}
+
+static boolean P_LoadCachedBlockMap(UINT64 geometry)
+{
+	std::string path = P_BlockMapCachePath();
+	blockmapcache_t expect;
+	blockmapcache_t header;
+	UINT8 *data = NULL;
+	size_t size;
+
+	if (!FIL_ReadFileOK(path.c_str()))
+		return false;
+
+	size = FIL_ReadFile(path.c_str(), &data);
+
+	if (data == NULL)
+		return false;
+
+	P_FillBlockMapCacheHeader(&expect, geometry);
+
+	if (size < sizeof header)
+	{
+		Z_Free(data);
+		return false;
+	}
+
+	memcpy(&header, data, sizeof header);
+
+	if (memcmp(header.magic, expect.magic, sizeof header.magic)
+		|| header.version != expect.version
+		|| strncmp(header.revision, expect.revision, sizeof header.revision)
+		|| header.geometry != expect.geometry
+		|| header.width <= 0 || header.height <= 0
+		|| header.lumpsize < 4 + (UINT32)header.width * header.height
+		|| size != sizeof header + header.lumpsize * sizeof (*blockmaplump))
+	{
+		CONS_Debug(DBG_SETUP, "P_LoadCachedBlockMap: %s is stale, rebuilding\n", path.c_str());
+		Z_Free(data);
+		return false;
+	}
+
+	blockmaplump = static_cast<INT32*>(Z_Malloc(header.lumpsize * sizeof (*blockmaplump), PU_LEVEL, NULL));
+	M_Memcpy(blockmaplump, data + sizeof header, header.lumpsize * sizeof (*blockmaplump));
+	Z_Free(data);
+
+	bmaporgx = header.orgx;
+	bmaporgy = header.orgy;
+	bmapwidth = header.width;
+	bmapheight = header.height;
+
+	P_ClearBlockLinks();
+
+	return true;
+}
+
+static void P_SaveCachedBlockMap(UINT64 geometry, size_t lumpsize)
+{
+	std::string path = P_BlockMapCachePath();
+	std::vector<UINT8> data(sizeof (blockmapcache_t) + lumpsize * sizeof (*blockmaplump));
+	blockmapcache_t header;
+	int parts = M_PathParts(path.c_str());
+
+	P_FillBlockMapCacheHeader(&header, geometry);
+	header.orgx = bmaporgx;
+	header.orgy = bmaporgy;
+	header.width = bmapwidth;
+	header.height = bmapheight;
+	header.lumpsize = (UINT32)lumpsize;
+
+	memcpy(data.data(), &header, sizeof header);
+	memcpy(data.data() + sizeof header, blockmaplump, lumpsize * sizeof (*blockmaplump));
+
+	M_MkdirEachUntil(path.c_str(), parts - 3, parts - 1, 0755);
+
+	if (!FIL_WriteFile(path.c_str(), data.data(), data.size()))
+		CONS_Debug(DBG_SETUP, "P_SaveCachedBlockMap: couldn't write %s\n", path.c_str());
+}
+
 static void P_LoadMapLUT(const virtres_t *virt)
 {
 	virtlump_t* virtblockmap = vres_Find(virt, "BLOCKMAP");
@@ -4456,7 +5715,12 @@ static void P_LoadMapLUT(const virtres_t *virt)
 		rejectmatrix = NULL;
 
 	if (!(virtblockmap && P_LoadBlockMap(virtblockmap->data, virtblockmap->size)))
-		P_CreateBlockMap();
+	{
+		UINT64 geometry = P_BlockMapGeometryHash();
+
+		if (!P_LoadCachedBlockMap(geometry))
+			P_SaveCachedBlockMap(geometry, P_CreateBlockMap());
+	}
 }
 
 //
@@ -7549,6 +8813,10 @@ static boolean P_LoadMapFromFile(void)
 	}
 
 	P_LoadMapBSP(curmapvirt);
+
+	// Names the blockmap cache
+	P_MakeMapMD5(curmapvirt, &mapmd5);
+
 	P_LoadMapLUT(curmapvirt);
 
 	P_LinkMapData();
@@ -7577,8 +8845,6 @@ static boolean P_LoadMapFromFile(void)
 		if (sectors[i].tags.count)
 			spawnsectors[i].tags.tags = static_cast<mtag_t*>(memcpy(Z_Malloc(sectors[i].tags.count*sizeof(mtag_t), PU_LEVEL, NULL), sectors[i].tags.tags, sectors[i].tags.count*sizeof(mtag_t)));
 
-	P_MakeMapMD5(curmapvirt, &mapmd5);
-
 	TracyCZoneEnd(__zone);
 	return true;
 }
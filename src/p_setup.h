@@ -111,6 +111,8 @@ void P_ResetLevelMusic(void);
 boolean P_UseContinuousLevelMusic(void);
 void P_LoadLevelMusic(void);
 boolean P_LoadLevel(boolean fromnetsave, boolean reloadinggamestate);
+void Command_TextmapBench_f(void);
+void Command_BlockMapBench_f(void);
 void P_PostLoadLevel(void);
 #ifdef HWRENDER
 void HWR_LoadLevel(void);
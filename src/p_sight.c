@@ -22,6 +22,8 @@
 
 #include "k_bot.h" // K_BotHatesThisSector
 #include "k_kart.h" // K_TripwirePass
+#include "m_profile.h"
+#include "i_system.h" // I_GetPreciseTime
 
 //
 // P_CheckSight
@@ -52,7 +54,17 @@ typedef struct
 	los_valid_poly_t validatePolyobj;	// If not NULL, then we will also check polyobject lines using this func.
 } los_funcs_t;
 
-static INT32 sightcounts[2];
+// Lines and polyobjects already crossed by the current trace, for threads
+// that can't use validcount (see P_SetThreadSight).
+static _Thread_local struct
+{
+	boolean enabled;
+	UINT32 stamp;
+	UINT32 *lines;
+	size_t numlines;
+	UINT32 *polys;
+	size_t numpolys;
+} threadsight;
 
 #ifdef DEVELOP
 extern consvar_t cv_debugtraversemax;
@@ -60,6 +72,95 @@ extern consvar_t cv_debugtraversemax;
 #define TRAVERSE_MAX (cv_debugtraversemax.value)
 #endif
 
+//
+// P_SetThreadSight
+//
+// Sight traces normally mark the lines they've crossed with validcount,
+// which only the main thread may touch. Code running on the thread pool
+// turns this on for the duration so its traces keep that bookkeeping to
+// themselves instead. The results are the same either way.
+//
+void P_SetThreadSight(boolean enable)
+{
+	threadsight.enabled = enable;
+}
+
+static void P_StartSightTrace(void)
+{
+	if (threadsight.enabled == false)
+	{
+		validcount++;
+		return;
+	}
+
+	// These are plain allocations because the zone isn't thread-safe.
+	if (threadsight.numlines < numlines)
+	{
+		threadsight.lines = realloc(threadsight.lines, numlines * sizeof (UINT32));
+		memset(threadsight.lines + threadsight.numlines, 0, (numlines - threadsight.numlines) * sizeof (UINT32));
+		threadsight.numlines = numlines;
+	}
+
+	if (threadsight.numpolys < (size_t)numPolyObjects)
+	{
+		threadsight.polys = realloc(threadsight.polys, numPolyObjects * sizeof (UINT32));
+		memset(threadsight.polys + threadsight.numpolys, 0, (numPolyObjects - threadsight.numpolys) * sizeof (UINT32));
+		threadsight.numpolys = numPolyObjects;
+	}
+
+	if (threadsight.lines == NULL || (numPolyObjects > 0 && threadsight.polys == NULL))
+		I_Error("P_StartSightTrace: out of memory");
+
+	if (++threadsight.stamp == 0)
+	{
+		memset(threadsight.lines, 0, threadsight.numlines * sizeof (UINT32));
+		if (threadsight.polys)
+			memset(threadsight.polys, 0, threadsight.numpolys * sizeof (UINT32));
+		threadsight.stamp = 1;
+	}
+}
+
+// Returns true if this trace has already crossed the line, and marks it
+static boolean P_SightLineChecked(line_t *line)
+{
+	if (threadsight.enabled)
+	{
+		UINT32 *stamp = &threadsight.lines[line - lines];
+
+		if (*stamp == threadsight.stamp)
+			return true;
+
+		*stamp = threadsight.stamp;
+		return false;
+	}
+
+	if (line->validcount == validcount)
+		return true;
+
+	line->validcount = validcount;
+	return false;
+}
+
+static boolean P_SightPolyObjChecked(polyobj_t *po)
+{
+	if (threadsight.enabled)
+	{
+		UINT32 *stamp = &threadsight.polys[po - PolyObjects];
+
+		if (*stamp == threadsight.stamp)
+			return true;
+
+		*stamp = threadsight.stamp;
+		return false;
+	}
+
+	if (po->validcount == validcount)
+		return true;
+
+	po->validcount = validcount;
+	return false;
+}
+
 //
 // P_DivlineSide
 //
@@ -137,11 +238,9 @@ static boolean P_CrossSubsecPolyObj(polyobj_t *po, register los_t *los, register
 		const vertex_t *v1,*v2;
 
 		// already checked other side?
-		if (line->validcount == validcount)
+		if (P_SightLineChecked(line))
 			continue;
 
-		line->validcount = validcount;
-
 		// OPTIMIZE: killough 4/20/98: Added quick bounding-box rejection test
 		if (line->bbox[BOXLEFT  ] > los->bbox[BOXRIGHT ] ||
 			line->bbox[BOXRIGHT ] < los->bbox[BOXLEFT  ] ||
@@ -493,9 +592,8 @@ static boolean P_CrossSubsector(size_t num, register los_t *los, register los_fu
 		{
 			while (po)
 			{
-				if (po->validcount != validcount)
+				if (!P_SightPolyObjChecked(po))
 				{
-					po->validcount = validcount;
 					if (!P_CrossSubsecPolyObj(po, los, funcs))
 						return false;
 				}
@@ -514,11 +612,9 @@ static boolean P_CrossSubsector(size_t num, register los_t *los, register los_fu
 			continue;
 
 		// already checked other side?
-		if (line->validcount == validcount)
+		if (P_SightLineChecked(line))
 			continue;
 
-		line->validcount = validcount;
-
 		// OPTIMIZE: killough 4/20/98: Added quick bounding-box rejection test
 		if (line->bbox[BOXLEFT  ] > los->bbox[BOXRIGHT ] ||
 			line->bbox[BOXRIGHT ] < los->bbox[BOXLEFT  ] ||
@@ -596,7 +692,6 @@ static boolean P_InitCheckSight(mobj_t *t1, mobj_t *t2, register los_t *los)
 
 	// An unobstructed LOS is possible.
 	// Now look from eyes of t1 to any part of t2.
-	sightcounts[1]++;
 
 	// Prevent SOME cases of looking through 3dfloors
 	//
@@ -721,7 +816,7 @@ static boolean P_CompareMobjsAcrossLines(mobj_t *t1, mobj_t *t2, register los_fu
 		return true;
 	}
 
-	validcount++;
+	P_StartSightTrace();
 
 	los.t1 = t1;
 	los.t2 = t2;
@@ -769,12 +864,22 @@ static boolean P_CompareMobjsAcrossLines(mobj_t *t1, mobj_t *t2, register los_fu
 boolean P_CheckSight(mobj_t *t1, mobj_t *t2)
 {
 	los_funcs_t funcs = {0};
+	precise_t start;
+	boolean ret;
 
 	funcs.init = &P_InitCheckSight;
 	funcs.validate = &P_IsVisible;
 	funcs.validatePolyobj = &P_IsVisiblePolyObj;
 
-	return P_CompareMobjsAcrossLines(t1, t2, &funcs);
+	// The profiler only keeps count for the main thread
+	if (!ps_profiling || threadsight.enabled)
+		return P_CompareMobjsAcrossLines(t1, t2, &funcs);
+
+	start = I_GetPreciseTime();
+	ret = P_CompareMobjsAcrossLines(t1, t2, &funcs);
+	PS_ProfileCall(PS_CALL_CHECKSIGHT, I_GetPreciseTime() - start);
+
+	return ret;
 }
 
 boolean P_TraceBlockingLines(mobj_t *t1, mobj_t *t2)
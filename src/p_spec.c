@@ -4506,6 +4506,8 @@ boolean P_ProcessSpecial(activator_t *activator, INT16 special, INT32 *args, cha
 						}
 					}
 				}
+
+				K_InvalidateWaypointTables();
 			}
 			break;
 
@@ -26,6 +26,8 @@
 #include "lua_script.h"
 #include "lua_hook.h"
 #include "m_perfstats.h"
+#include "m_profile.h"
+#include "core/trace.h"
 #include "i_system.h" // I_GetPreciseTime
 #include "i_video.h" // rendermode
 #include "r_main.h"
@@ -554,6 +556,18 @@ mobj_t *P_SetTarget2(mobj_t **mop, mobj_t *targ
 // Rewritten to delete nodes implicitly, by making currentthinker
 // external and using P_RemoveThinkerDelayed() implicitly.
 //
+static void P_RunProfiledThinker(thinker_t *thinker)
+{
+	actionf_p1 func = thinker->function.acp1;
+	// The mobj may be removed while it thinks, so get its type first
+	INT32 type = (func == (actionf_p1)P_MobjThinker) ? (INT32)((mobj_t *)thinker)->type : -1;
+	precise_t start = I_GetPreciseTime();
+
+	func(thinker);
+
+	PS_ProfileThinker(func, type, I_GetPreciseTime() - start);
+}
+
 static void P_RunThinkers(void)
 {
 	size_t i;
@@ -566,7 +580,10 @@ static void P_RunThinkers(void)
 #ifdef PARANOIA
 			I_Assert(currentthinker->function.acp1 != NULL);
 #endif
-			currentthinker->function.acp1(currentthinker);
+			if (ps_profiling)
+				P_RunProfiledThinker(currentthinker);
+			else
+				currentthinker->function.acp1(currentthinker);
 		}
 		ps_thlist_times[i] = I_GetPreciseTime() - ps_thlist_times[i];
 	}
@@ -918,6 +935,7 @@ void P_Ticker(boolean run)
 		}
 
 		LUA_ResetTicTimers();
+		PS_ResetProfileTic();
 
 		ps_lua_mobjhooks = 0;
 		ps_checkposition_calls = 0;
@@ -925,6 +943,7 @@ void P_Ticker(boolean run)
 		LUA_HOOK(PreThinkFrame);
 
 		ps_playerthink_time = I_GetPreciseTime();
+		Trace_Begin("Player Think");
 
 		K_UpdateAllPlayerPositions();
 
@@ -937,6 +956,7 @@ void P_Ticker(boolean run)
 			K_KartPlayerHUDUpdate(&players[i]);
 		}
 
+		Trace_End();
 		ps_playerthink_time = I_GetPreciseTime() - ps_playerthink_time;
 
 		if (gamedata && gamestate == GS_LEVEL && !demo.playback)
@@ -1065,7 +1085,9 @@ void P_Ticker(boolean run)
 	if (run)
 	{
 		ps_thinkertime = I_GetPreciseTime();
+		Trace_Begin("Thinkers");
 		P_RunThinkers();
+		Trace_End();
 		ps_thinkertime = I_GetPreciseTime() - ps_thinkertime;
 		thinkersCompleted = true;
 
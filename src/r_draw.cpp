@@ -31,6 +31,18 @@
 #include "k_color.h" // SRB2kart
 #include "i_threads.h"
 #include "libdivide.h" // used by NPO2 tilted span functions
+#include "m_argv.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define R_DRAW_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define R_DRAW_SIMD_NEON
+#include <arm_neon.h>
+#endif
 
 #ifdef HWRENDER
 #include "hardware/hw_main.h"
@@ -660,5 +672,6 @@ void R_DrawViewBorder(void)
 //                   INCLUDE MAIN DRAWERS CODE HERE
 // ==========================================================================
 
+#include "r_draw_simd.cpp"
 #include "r_draw_column.cpp"
 #include "r_draw_span.cpp"
@@ -180,6 +180,9 @@ UINT8 *R_GetBlendTable(int style, INT32 alphalevel);
 // Color ramp modification should force a recache
 extern UINT8 skincolor_modified[];
 
+// Picks the texel addressing kernels for this CPU, returns their name
+const char *R_InitTexelFuncs(void);
+
 void R_InitViewBuffer(INT32 width, INT32 height);
 void R_InitViewBorder(void);
 void R_VideoErase(size_t ofs, INT32 count);
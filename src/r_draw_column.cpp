@@ -287,6 +287,22 @@ static void R_DrawColumnTemplate(drawcolumndata_t *dc)
 		}
 		else
 		{
+			while (count >= TEXELBATCH)
+			{
+				INT32 texels[TEXELBATCH];
+
+				R_ColumnTexels(texels, frac, fracstep, heightmask);
+
+				for (INT32 i = 0; i < TEXELBATCH; i++)
+				{
+					*dest = R_DrawColumnPixel<Type>(dc, dest, texels[i]);
+					dest += vid.width;
+				}
+
+				frac = (fixed_t)((UINT32)frac + (UINT32)fracstep * TEXELBATCH);
+				count -= TEXELBATCH;
+			}
+
 			while ((count -= 2) >= 0) // texture height is a power of 2
 			{
 				*dest = R_DrawColumnPixel<Type>(dc, dest, (frac>>FRACBITS) & heightmask);
@@ -0,0 +1,251 @@
+// DR. ROBOTNIK'S RING RACERS
+//-----------------------------------------------------------------------------
+// Copyright (C) 2024 by Kart Krew.
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+/// \file  r_draw_simd.cpp
+/// \brief vectorised texel addressing for the column and span drawers
+/// \note  no includes because this is included as part of r_draw.cpp
+
+// ==========================================================================
+// TEXEL ADDRESSING
+// ==========================================================================
+
+// The drawers spend a large part of every pixel stepping the texture
+// coordinates and turning them into a texel offset. These kernels produce
+// the offsets for a whole run of pixels at once, so the drawers only have
+// to do the texel fetch and the colormap/transmap lookups per pixel.
+//
+// Everything here is wrapping 32-bit integer math, exactly like the
+// scalar drawers, so the output is bit-identical on every code path.
+// The lookups themselves stay scalar: SSE4.1 and NEON have no byte
+// gathers, and AVX2's dword gathers would read past the end of the
+// texture and colormap buffers.
+
+#define TEXELBATCH 16
+
+// Span: out[i] = (((ypos + i*ystep) >> yshift) & mask) | ((xpos + i*xstep) >> xshift)
+typedef void (spantexelfunc_t)(UINT32 *out, UINT32 xpos, UINT32 ypos, UINT32 xstep, UINT32 ystep, UINT32 xshift, UINT32 yshift, UINT32 mask);
+
+// Column: out[i] = ((frac + i*fracstep) >> FRACBITS) & heightmask
+typedef void (columntexelfunc_t)(INT32 *out, INT32 frac, INT32 fracstep, INT32 heightmask);
+
+static void R_SpanTexels_Scalar(UINT32 *out, UINT32 xpos, UINT32 ypos, UINT32 xstep, UINT32 ystep, UINT32 xshift, UINT32 yshift, UINT32 mask)
+{
+	for (INT32 i = 0; i < TEXELBATCH; i++)
+	{
+		out[i] = ((ypos >> yshift) & mask) | (xpos >> xshift);
+		xpos += xstep;
+		ypos += ystep;
+	}
+}
+
+static void R_ColumnTexels_Scalar(INT32 *out, INT32 frac, INT32 fracstep, INT32 heightmask)
+{
+	UINT32 ufrac = (UINT32)frac;
+
+	for (INT32 i = 0; i < TEXELBATCH; i++)
+	{
+		out[i] = ((INT32)ufrac >> FRACBITS) & heightmask;
+		ufrac += (UINT32)fracstep;
+	}
+}
+
+#if defined(R_DRAW_SIMD_X86)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define R_TARGET(x) __attribute__((target(x)))
+#else
+#define R_TARGET(x)
+#endif
+
+R_TARGET("sse4.1")
+static void R_SpanTexels_SSE41(UINT32 *out, UINT32 xpos, UINT32 ypos, UINT32 xstep, UINT32 ystep, UINT32 xshift, UINT32 yshift, UINT32 mask)
+{
+	const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128i xs = _mm_cvtsi32_si128((int)xshift);
+	const __m128i ys = _mm_cvtsi32_si128((int)yshift);
+	const __m128i m = _mm_set1_epi32((int)mask);
+	const __m128i x4 = _mm_set1_epi32((int)(xstep * 4));
+	const __m128i y4 = _mm_set1_epi32((int)(ystep * 4));
+
+	__m128i x = _mm_add_epi32(_mm_set1_epi32((int)xpos), _mm_mullo_epi32(lanes, _mm_set1_epi32((int)xstep)));
+	__m128i y = _mm_add_epi32(_mm_set1_epi32((int)ypos), _mm_mullo_epi32(lanes, _mm_set1_epi32((int)ystep)));
+
+	for (INT32 i = 0; i < TEXELBATCH; i += 4)
+	{
+		__m128i bit = _mm_or_si128(_mm_and_si128(_mm_srl_epi32(y, ys), m), _mm_srl_epi32(x, xs));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(&out[i]), bit);
+		x = _mm_add_epi32(x, x4);
+		y = _mm_add_epi32(y, y4);
+	}
+}
+
+R_TARGET("sse4.1")
+static void R_ColumnTexels_SSE41(INT32 *out, INT32 frac, INT32 fracstep, INT32 heightmask)
+{
+	const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128i m = _mm_set1_epi32(heightmask);
+	const __m128i f4 = _mm_set1_epi32((int)((UINT32)fracstep * 4));
+
+	__m128i f = _mm_add_epi32(_mm_set1_epi32(frac), _mm_mullo_epi32(lanes, _mm_set1_epi32(fracstep)));
+
+	for (INT32 i = 0; i < TEXELBATCH; i += 4)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(&out[i]), _mm_and_si128(_mm_srai_epi32(f, FRACBITS), m));
+		f = _mm_add_epi32(f, f4);
+	}
+}
+
+R_TARGET("avx2")
+static void R_SpanTexels_AVX2(UINT32 *out, UINT32 xpos, UINT32 ypos, UINT32 xstep, UINT32 ystep, UINT32 xshift, UINT32 yshift, UINT32 mask)
+{
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m128i xs = _mm_cvtsi32_si128((int)xshift);
+	const __m128i ys = _mm_cvtsi32_si128((int)yshift);
+	const __m256i m = _mm256_set1_epi32((int)mask);
+	const __m256i x8 = _mm256_set1_epi32((int)(xstep * 8));
+	const __m256i y8 = _mm256_set1_epi32((int)(ystep * 8));
+
+	__m256i x = _mm256_add_epi32(_mm256_set1_epi32((int)xpos), _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)xstep)));
+	__m256i y = _mm256_add_epi32(_mm256_set1_epi32((int)ypos), _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)ystep)));
+
+	for (INT32 i = 0; i < TEXELBATCH; i += 8)
+	{
+		__m256i bit = _mm256_or_si256(_mm256_and_si256(_mm256_srl_epi32(y, ys), m), _mm256_srl_epi32(x, xs));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(&out[i]), bit);
+		x = _mm256_add_epi32(x, x8);
+		y = _mm256_add_epi32(y, y8);
+	}
+}
+
+R_TARGET("avx2")
+static void R_ColumnTexels_AVX2(INT32 *out, INT32 frac, INT32 fracstep, INT32 heightmask)
+{
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i m = _mm256_set1_epi32(heightmask);
+	const __m256i f8 = _mm256_set1_epi32((int)((UINT32)fracstep * 8));
+
+	__m256i f = _mm256_add_epi32(_mm256_set1_epi32(frac), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(fracstep)));
+
+	for (INT32 i = 0; i < TEXELBATCH; i += 8)
+	{
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(&out[i]), _mm256_and_si256(_mm256_srai_epi32(f, FRACBITS), m));
+		f = _mm256_add_epi32(f, f8);
+	}
+}
+
+#undef R_TARGET
+
+static boolean R_CPUHasSSE41(void)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_cpu_supports("sse4.1");
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 19)) != 0;
+#else
+	return false;
+#endif
+}
+
+static boolean R_CPUHasAVX2(void)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	// OSXSAVE and AVX, then make sure the OS saves the YMM registers
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+		return false;
+	if ((_xgetbv(0) & 6) != 6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+#elif defined(R_DRAW_SIMD_NEON)
+
+static void R_SpanTexels_NEON(UINT32 *out, UINT32 xpos, UINT32 ypos, UINT32 xstep, UINT32 ystep, UINT32 xshift, UINT32 yshift, UINT32 mask)
+{
+	static const uint32_t lanevals[4] = {0, 1, 2, 3};
+	const uint32x4_t lanes = vld1q_u32(lanevals);
+	// NEON only shifts left by a vector; a negative count shifts right
+	const int32x4_t xs = vdupq_n_s32(-(int32_t)xshift);
+	const int32x4_t ys = vdupq_n_s32(-(int32_t)yshift);
+	const uint32x4_t m = vdupq_n_u32(mask);
+	const uint32x4_t x4 = vdupq_n_u32(xstep * 4);
+	const uint32x4_t y4 = vdupq_n_u32(ystep * 4);
+
+	uint32x4_t x = vmlaq_n_u32(vdupq_n_u32(xpos), lanes, xstep);
+	uint32x4_t y = vmlaq_n_u32(vdupq_n_u32(ypos), lanes, ystep);
+
+	for (INT32 i = 0; i < TEXELBATCH; i += 4)
+	{
+		uint32x4_t bit = vorrq_u32(vandq_u32(vshlq_u32(y, ys), m), vshlq_u32(x, xs));
+		vst1q_u32(&out[i], bit);
+		x = vaddq_u32(x, x4);
+		y = vaddq_u32(y, y4);
+	}
+}
+
+static void R_ColumnTexels_NEON(INT32 *out, INT32 frac, INT32 fracstep, INT32 heightmask)
+{
+	static const uint32_t lanevals[4] = {0, 1, 2, 3};
+	const uint32x4_t lanes = vld1q_u32(lanevals);
+	const int32x4_t m = vdupq_n_s32(heightmask);
+	const uint32x4_t f4 = vdupq_n_u32((UINT32)fracstep * 4);
+
+	uint32x4_t f = vmlaq_n_u32(vdupq_n_u32((UINT32)frac), lanes, (UINT32)fracstep);
+
+	for (INT32 i = 0; i < TEXELBATCH; i += 4)
+	{
+		vst1q_s32(&out[i], vandq_s32(vshrq_n_s32(vreinterpretq_s32_u32(f), FRACBITS), m));
+		f = vaddq_u32(f, f4);
+	}
+}
+
+#endif
+
+static spantexelfunc_t *R_SpanTexels = R_SpanTexels_Scalar;
+static columntexelfunc_t *R_ColumnTexels = R_ColumnTexels_Scalar;
+
+const char *R_InitTexelFuncs(void)
+{
+	R_SpanTexels = R_SpanTexels_Scalar;
+	R_ColumnTexels = R_ColumnTexels_Scalar;
+
+	// For checking the vectorised drawers against the reference ones
+	if (M_CheckParm("-nosimd"))
+		return "scalar";
+
+#if defined(R_DRAW_SIMD_X86)
+	if (R_CPUHasAVX2())
+	{
+		R_SpanTexels = R_SpanTexels_AVX2;
+		R_ColumnTexels = R_ColumnTexels_AVX2;
+		return "AVX2";
+	}
+
+	if (R_CPUHasSSE41())
+	{
+		R_SpanTexels = R_SpanTexels_SSE41;
+		R_ColumnTexels = R_ColumnTexels_SSE41;
+		return "SSE4.1";
+	}
+#elif defined(R_DRAW_SIMD_NEON)
+	R_SpanTexels = R_SpanTexels_NEON;
+	R_ColumnTexels = R_ColumnTexels_NEON;
+	return "NEON";
+#endif
+
+	return "scalar";
+}
@@ -186,6 +186,26 @@ static void R_DrawSpanTemplate(drawspandata_t* ds)
 		return;
 	}
 
+	while (count >= TEXELBATCH)
+	{
+		UINT32 bits[TEXELBATCH];
+
+		R_SpanTexels(bits, xposition, yposition, xstep, ystep, ds->nflatxshift, ds->nflatyshift, ds->nflatmask);
+
+		for (i = 0; i < TEXELBATCH; i++)
+		{
+			dest[i] = R_DrawSpanPixel<Type>(ds, &dsrc[i], ds->colormap, bits[i]);
+		}
+
+		xposition = (fixed_t)((UINT32)xposition + (UINT32)xstep * TEXELBATCH);
+		yposition = (fixed_t)((UINT32)yposition + (UINT32)ystep * TEXELBATCH);
+
+		dest += TEXELBATCH;
+		dsrc += TEXELBATCH;
+
+		count -= TEXELBATCH;
+	}
+
 	while (count >= 8)
 	{
 		// SoM: Why didn't I see this earlier? the spot variable is a waste now because we don't
@@ -354,16 +374,18 @@ static void R_DrawTiltedSpanTemplate(drawspandata_t* ds)
 
 		x1 = ds->x1;
 
+		static_assert(SPANSIZE == TEXELBATCH);
+		UINT32 bits[TEXELBATCH];
+		R_SpanTexels(bits, u, v, stepu, stepv, nflatxshift, nflatyshift, nflatmask);
+
 		for (i = 0; i < SPANSIZE; i++)
 		{
-			bit = (((v + stepv * i) >> nflatyshift) & nflatmask) | ((u + stepu * i) >> nflatxshift);
-
 			if constexpr (!(Type & DS_SPRITE))
 			{
 				colormap = ds->planezlight[tiltlighting[x1 + i]] + (ds->colormap - colormaps);
 			}
 
-			dest[i] = R_DrawSpanPixel<Type>(ds, &dsrc[i], colormap, bit);
+			dest[i] = R_DrawSpanPixel<Type>(ds, &dsrc[i], colormap, bits[i]);
 		}
 
 		ds->x1 += SPANSIZE;
@@ -24,6 +24,7 @@
 #include "z_zone.h"
 #include "console.h" // con_startup_loadprogress
 #include "i_time.h"
+#include "i_system.h" // I_GetPreciseTime
 
 UINT32 R_GetFramerateCap(void)
 {
@@ -67,9 +68,28 @@ viewvars_t *newview = &pview_new[0];
 
 enum viewcontext_e viewcontext = VIEWCONTEXT_PLAYER1;
 
-static levelinterpolator_t **levelinterpolators;
+// Interpolators are stored side by side, and each thinker's are chained
+// together through levelinterpolator_t::next, so destroying them doesn't
+// have to look at anyone else's. Destroyed ones are only marked, and get
+// squeezed out before the next pass over the array.
+static levelinterpolator_t *levelinterpolators;
 static size_t levelinterpolators_len;
 static size_t levelinterpolators_size;
+static size_t levelinterpolators_dead;
+
+#define NOINTERP ((size_t)-1)
+
+// Thinker to the index of its newest interpolator.
+// Open addressing with linear probing; a NULL thinker is an empty slot.
+typedef struct
+{
+	thinker_t *thinker;
+	size_t head;
+} interpthinker_t;
+
+static interpthinker_t *interpthinkers;
+static size_t interpthinkers_len;
+static size_t interpthinkers_size; // always a power of two
 
 
 static fixed_t R_LerpFixed(fixed_t from, fixed_t to, fixed_t frac)
@@ -324,8 +344,144 @@ void R_InterpolatePrecipMobjState(precipmobj_t *mobj, fixed_t frac, interpmobjst
 	out->angle = R_LerpAngle(mobj->old_angle, mobj->angle, frac);
 }
 
-static void AddInterpolator(levelinterpolator_t* interpolator)
+static size_t InterpThinkerSlot(const thinker_t *thinker)
+{
+	uintptr_t h = (uintptr_t)thinker;
+
+	h ^= h >> 17;
+	h *= (uintptr_t)0x9E3779B97F4A7C15ull;
+	h ^= h >> 29;
+
+	return (size_t)h & (interpthinkers_size - 1);
+}
+
+static interpthinker_t *FindInterpThinker(const thinker_t *thinker)
+{
+	size_t i;
+
+	if (interpthinkers_len == 0)
+	{
+		return NULL;
+	}
+
+	for (i = InterpThinkerSlot(thinker); interpthinkers[i].thinker != NULL; i = (i + 1) & (interpthinkers_size - 1))
+	{
+		if (interpthinkers[i].thinker == thinker)
+		{
+			return &interpthinkers[i];
+		}
+	}
+
+	return NULL;
+}
+
+// Finds the thinker's entry, making an empty one if it has none yet
+static interpthinker_t *AddInterpThinker(thinker_t *thinker)
+{
+	size_t i;
+
+	if ((interpthinkers_len + 1) * 4 > interpthinkers_size * 3)
+	{
+		interpthinker_t *old = interpthinkers;
+		size_t oldsize = interpthinkers_size;
+
+		interpthinkers_size = oldsize ? oldsize * 2 : 256;
+		interpthinkers = Z_Calloc(sizeof(interpthinker_t) * interpthinkers_size, PU_LEVEL, NULL);
+		interpthinkers_len = 0;
+
+		for (i = 0; i < oldsize; i++)
+		{
+			if (old[i].thinker != NULL)
+			{
+				*AddInterpThinker(old[i].thinker) = old[i];
+			}
+		}
+
+		Z_Free(old);
+	}
+
+	for (i = InterpThinkerSlot(thinker); interpthinkers[i].thinker != NULL; i = (i + 1) & (interpthinkers_size - 1))
+	{
+		if (interpthinkers[i].thinker == thinker)
+		{
+			return &interpthinkers[i];
+		}
+	}
+
+	interpthinkers[i].thinker = thinker;
+	interpthinkers[i].head = NOINTERP;
+	interpthinkers_len += 1;
+
+	return &interpthinkers[i];
+}
+
+static void RemoveInterpThinker(interpthinker_t *entry)
+{
+	size_t i = entry - interpthinkers;
+	size_t j;
+
+	// Shift the rest of the cluster back instead of leaving a tombstone
+	for (j = (i + 1) & (interpthinkers_size - 1); interpthinkers[j].thinker != NULL; j = (j + 1) & (interpthinkers_size - 1))
+	{
+		size_t home = InterpThinkerSlot(interpthinkers[j].thinker);
+
+		if (((j - home) & (interpthinkers_size - 1)) >= ((j - i) & (interpthinkers_size - 1)))
+		{
+			interpthinkers[i] = interpthinkers[j];
+			i = j;
+		}
+	}
+
+	interpthinkers[i].thinker = NULL;
+	interpthinkers_len -= 1;
+}
+
+static void LinkInterpolator(size_t index)
+{
+	interpthinker_t *entry = AddInterpThinker(levelinterpolators[index].thinker);
+
+	levelinterpolators[index].next = entry->head;
+	entry->head = index;
+}
+
+// Squeeze out destroyed interpolators, keeping the rest in order
+static void CompactLevelInterpolators(void)
+{
+	size_t i, len = 0;
+
+	if (levelinterpolators_dead == 0)
+	{
+		return;
+	}
+
+	// Every index is about to move, so relink from scratch
+	memset(interpthinkers, 0, sizeof(interpthinker_t) * interpthinkers_size);
+	interpthinkers_len = 0;
+
+	for (i = 0; i < levelinterpolators_len; i++)
+	{
+		if (levelinterpolators[i].thinker == NULL)
+		{
+			continue;
+		}
+
+		if (i != len)
+		{
+			levelinterpolators[len] = levelinterpolators[i];
+		}
+
+		LinkInterpolator(len);
+		len += 1;
+	}
+
+	levelinterpolators_len = len;
+	levelinterpolators_dead = 0;
+}
+
+static levelinterpolator_t *CreateInterpolator(levelinterpolator_type_e type, thinker_t *thinker)
 {
+	levelinterpolator_t *ret;
+
 	if (levelinterpolators_len >= levelinterpolators_size)
 	{
 		if (levelinterpolators_size == 0)
@@ -339,26 +495,20 @@ static void AddInterpolator(levelinterpolator_t* interpolator)
 
 		levelinterpolators = Z_Realloc(
 			(void*) levelinterpolators,
-			sizeof(levelinterpolator_t*) * levelinterpolators_size,
+			sizeof(levelinterpolator_t) * levelinterpolators_size,
 			PU_LEVEL,
 			NULL
 		);
 	}
 
-	levelinterpolators[levelinterpolators_len] = interpolator;
-	levelinterpolators_len += 1;
-}
-
-static levelinterpolator_t *CreateInterpolator(levelinterpolator_type_e type, thinker_t *thinker)
-{
-	levelinterpolator_t *ret = (levelinterpolator_t*) Z_Calloc(
-		sizeof(levelinterpolator_t), PU_LEVEL, NULL
-	);
+	ret = &levelinterpolators[levelinterpolators_len];
+	memset(ret, 0, sizeof(levelinterpolator_t));
 
 	ret->type = type;
 	ret->thinker = thinker;
 
-	AddInterpolator(ret);
+	LinkInterpolator(levelinterpolators_len);
+	levelinterpolators_len += 1;
 
 	return ret;
 }
@@ -439,7 +589,12 @@ void R_InitializeLevelInterpolators(void)
 {
 	levelinterpolators_len = 0;
 	levelinterpolators_size = 0;
+	levelinterpolators_dead = 0;
 	levelinterpolators = NULL;
+
+	interpthinkers_len = 0;
+	interpthinkers_size = 0;
+	interpthinkers = NULL;
 }
 
 static void UpdateLevelInterpolatorState(levelinterpolator_t *interp)
@@ -493,28 +648,29 @@ void R_UpdateLevelInterpolators(void)
 {
 	size_t i;
 
+	CompactLevelInterpolators();
+
 	for (i = 0; i < levelinterpolators_len; i++)
 	{
-		levelinterpolator_t *interp = levelinterpolators[i];
-
-		UpdateLevelInterpolatorState(interp);
+		UpdateLevelInterpolatorState(&levelinterpolators[i]);
 	}
 }
 
 void R_ClearLevelInterpolatorState(thinker_t *thinker)
 {
+	interpthinker_t *entry = FindInterpThinker(thinker);
 	size_t i;
 
-	for (i = 0; i < levelinterpolators_len; i++)
+	if (entry == NULL)
 	{
-		levelinterpolator_t *interp = levelinterpolators[i];
+		return;
+	}
 
-		if (interp->thinker == thinker)
-		{
-			// Do it twice to make the old state match the new
-			UpdateLevelInterpolatorState(interp);
-			UpdateLevelInterpolatorState(interp);
-		}
+	for (i = entry->head; i != NOINTERP; i = levelinterpolators[i].next)
+	{
+		// Do it twice to make the old state match the new
+		UpdateLevelInterpolatorState(&levelinterpolators[i]);
+		UpdateLevelInterpolatorState(&levelinterpolators[i]);
 	}
 }
 
@@ -522,9 +678,11 @@ void R_ApplyLevelInterpolators(fixed_t frac)
 {
 	size_t i, ii;
 
+	CompactLevelInterpolators();
+
 	for (i = 0; i < levelinterpolators_len; i++)
 	{
-		levelinterpolator_t *interp = levelinterpolators[i];
+		levelinterpolator_t *interp = &levelinterpolators[i];
 
 		switch (interp->type)
 		{
@@ -577,9 +735,11 @@ void R_RestoreLevelInterpolators(void)
 {
 	size_t i, ii;
 
+	CompactLevelInterpolators();
+
 	for (i = 0; i < levelinterpolators_len; i++)
 	{
-		levelinterpolator_t *interp = levelinterpolators[i];
+		levelinterpolator_t *interp = &levelinterpolators[i];
 
 		switch (interp->type)
 		{
@@ -630,22 +790,96 @@ void R_RestoreLevelInterpolators(void)
 
 void R_DestroyLevelInterpolators(thinker_t *thinker)
 {
+	interpthinker_t *entry = FindInterpThinker(thinker);
 	size_t i;
 
-	for (i = 0; i < levelinterpolators_len; i++)
+	if (entry == NULL)
 	{
-		levelinterpolator_t *interp = levelinterpolators[i];
+		return;
+	}
 
-		if (interp->thinker == thinker)
-		{
-			// Swap the tail of the level interpolators to this spot
-			levelinterpolators[i] = levelinterpolators[levelinterpolators_len - 1];
-			levelinterpolators_len -= 1;
+	for (i = entry->head; i != NOINTERP; i = levelinterpolators[i].next)
+	{
+		levelinterpolator_t *interp = &levelinterpolators[i];
 
-			Z_Free(interp);
-			i -= 1;
+		if (interp->type == LVLINTERP_Polyobj)
+		{
+			Z_Free(interp->polyobj.oldvertices);
+			Z_Free(interp->polyobj.bakvertices);
 		}
+
+		interp->thinker = NULL;
+		levelinterpolators_dead += 1;
 	}
+
+	RemoveInterpThinker(entry);
+}
+
+void Command_InterpBench_f(void)
+{
+	size_t count = 10000;
+	size_t i;
+	thinker_t *thinkers;
+	sector_t *sector;
+	precise_t t0, t1, t2, t3, t4;
+
+	if (COM_Argc() > 1)
+	{
+		count = max(atoi(COM_Argv(1)), 1);
+	}
+
+	if (gamestate != GS_LEVEL)
+	{
+		CONS_Printf("interpbench: you must be in a level to use this.\n");
+		return;
+	}
+
+	thinkers = Z_Calloc(sizeof(thinker_t) * count, PU_STATIC, NULL);
+	sector = Z_Calloc(sizeof(sector_t), PU_STATIC, NULL);
+
+	t0 = I_GetPreciseTime();
+
+	for (i = 0; i < count; i++)
+	{
+		R_CreateInterpolator_SectorPlane(&thinkers[i], sector, (i & 1));
+	}
+
+	t1 = I_GetPreciseTime();
+
+	// The level's own interpolators lose a frame of smoothing
+	// from this, but end up back at the real game state.
+	R_UpdateLevelInterpolators();
+	R_ApplyLevelInterpolators(FRACUNIT);
+	R_RestoreLevelInterpolators();
+
+	t2 = I_GetPreciseTime();
+
+	// Every other one from the front, then the rest from the
+	// back, like a mass despawn in no particular order
+	for (i = 0; i < count; i += 2)
+	{
+		R_DestroyLevelInterpolators(&thinkers[i]);
+	}
+	for (i = count - 1 - (count & 1); i < count; i -= 2)
+	{
+		R_DestroyLevelInterpolators(&thinkers[i]);
+	}
+
+	t3 = I_GetPreciseTime();
+
+	CompactLevelInterpolators();
+
+	t4 = I_GetPreciseTime();
+
+	CONS_Printf("%s interpolators: create %.2f ms, update/apply/restore %.2f ms, destroy %.2f ms, compact %.2f ms\n",
+		sizeu1(count),
+		(t1 - t0) * 1000.0 / I_GetPrecisePrecision(),
+		(t2 - t1) * 1000.0 / I_GetPrecisePrecision(),
+		(t3 - t2) * 1000.0 / I_GetPrecisePrecision(),
+		(t4 - t3) * 1000.0 / I_GetPrecisePrecision());
+
+	Z_Free(thinkers);
+	Z_Free(sector);
 }
 
 static mobj_t **interpolated_mobjs = NULL;
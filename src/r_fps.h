@@ -90,7 +90,8 @@ typedef enum {
 // Tagged union of a level interpolator
 struct levelinterpolator_t {
 	levelinterpolator_type_e type;
-	thinker_t *thinker;
+	thinker_t *thinker; // NULL once destroyed
+	size_t next; // index of the thinker's previous interpolator
 	union {
 		struct {
 			sector_t *sector;
@@ -162,6 +163,8 @@ void R_ApplyLevelInterpolators(fixed_t frac);
 void R_RestoreLevelInterpolators(void);
 // Destroy interpolators associated with a thinker
 void R_DestroyLevelInterpolators(thinker_t *thinker);
+// Time creating and destroying lots of level interpolators
+void Command_InterpBench_f(void);
 
 // Initialize internal mobj interpolator list (e.g. during level loading)
 void R_InitMobjInterpolators(void);
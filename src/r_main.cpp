@@ -41,6 +41,7 @@
 #include "doomstat.h" // MAXSPLITSCREENPLAYERS
 #include "r_fps.h" // Frame interpolation/uncapped
 #include "core/thread_pool.h"
+#include "core/trace.h"
 
 #ifdef HWRENDER
 #include "hardware/hw_main.h"
@@ -129,6 +130,9 @@ precise_t ps_sw_portaltime = 0;
 precise_t ps_sw_planetime = 0;
 precise_t ps_sw_maskedtime = 0;
 
+portalstats_t ps_sw_portals[MAXPORTALSTATS];
+int ps_sw_numportals = 0;
+
 int ps_numbspcalls = 0;
 int ps_numsprites = 0;
 int ps_numdrawnodes = 0;
@@ -1540,11 +1544,14 @@ void R_RenderPlayerView(void)
 #endif
 	ps_numbspcalls = ps_numpolyobjects = ps_numdrawnodes = 0;
 	ps_bsptime = I_GetPreciseTime();
+	Trace_Begin("BSP");
 
 	srb2::ThreadPool::Sema tp_sema;
 	srb2::g_main_threadpool->begin_sema();
+	R_ClearWallColumns();
 	R_RenderViewpoint(&masks[nummasks - 1], nummasks - 1);
 
+	Trace_End();
 	ps_bsptime = I_GetPreciseTime() - ps_bsptime;
 #ifdef TIMING
 	RDMSR(0x10, &mycount);
@@ -1555,7 +1562,9 @@ void R_RenderPlayerView(void)
 //profile stuff ---------------------------------------------------------
 
 	ps_sw_spritecliptime = I_GetPreciseTime();
+	Trace_Begin("Sprite Clip");
 	R_ClipSprites(drawsegs, NULL);
+	Trace_End();
 	ps_sw_spritecliptime = I_GetPreciseTime() - ps_sw_spritecliptime;
 
 
@@ -1565,17 +1574,22 @@ void R_RenderPlayerView(void)
 
 	// Portal rendering. Hijacks the BSP traversal.
 	ps_sw_portaltime = I_GetPreciseTime();
+	ps_sw_numportals = 0;
+	Trace_Begin("Portals");
 	if (portal_base && !cv_debugrender_portal.value)
 	{
-		// tp_sema = srb2::g_main_threadpool->end_sema();
-		// srb2::g_main_threadpool->notify_sema(tp_sema);
-		// srb2::g_main_threadpool->wait_sema(tp_sema);
-		// srb2::g_main_threadpool->begin_sema();
-
 		portal_t *portal;
 
+		// Every viewpoint owns a disjoint area of the screen, so the
+		// walls and planes of a finished viewpoint can be drawn by the
+		// thread pool while the next portal is traversed on this thread.
+		R_FlushWallColumns();
+		R_FlushPlanes();
+
 		for(portal = portal_base; portal; portal = portal_base)
 		{
+			precise_t portaltime = I_GetPreciseTime();
+
 			portalrender = portal->pass; // Recursiveness depth.
 
 			R_ClearFFloorClips();
@@ -1607,27 +1621,40 @@ void R_RenderPlayerView(void)
 
 			R_ClipSprites(ds_p - (masks[nummasks - 1].drawsegs[1] - masks[nummasks - 1].drawsegs[0]), portal);
 
+			R_FlushWallColumns();
+			R_FlushPlanes();
+
+			if (ps_sw_numportals < MAXPORTALSTATS)
+			{
+				portalstats_t *stats = &ps_sw_portals[ps_sw_numportals++];
+				stats->time = I_GetPreciseTime() - portaltime;
+				stats->pass = portal->pass;
+				stats->isskybox = portal->isskybox;
+				stats->drawsegs = masks[nummasks - 1].drawsegs[1] - masks[nummasks - 1].drawsegs[0];
+			}
+
 			Portal_Remove(portal);
 		}
-
-		// tp_sema = srb2::g_main_threadpool->end_sema();
-		// srb2::g_main_threadpool->notify_sema(tp_sema);
-		// srb2::g_main_threadpool->wait_sema(tp_sema);
-		// srb2::g_main_threadpool->begin_sema();
 	}
+	Trace_End();
 	ps_sw_portaltime = I_GetPreciseTime() - ps_sw_portaltime;
 
 	ps_sw_planetime = I_GetPreciseTime();
+	Trace_Begin("Planes");
+	R_FlushWallColumns();
 	R_DrawPlanes();
 	tp_sema = srb2::g_main_threadpool->end_sema();
 	srb2::g_main_threadpool->notify_sema(tp_sema);
 	srb2::g_main_threadpool->wait_sema(tp_sema);
+	Trace_End();
 	ps_sw_planetime = I_GetPreciseTime() - ps_sw_planetime;
 
 	// draw mid texture and sprite
 	// And now 3D floors/sides!
 	ps_sw_maskedtime = I_GetPreciseTime();
+	Trace_Begin("Masked");
 	R_DrawMasked(masks, nummasks);
+	Trace_End();
 	ps_sw_maskedtime = I_GetPreciseTime() - ps_sw_maskedtime;
 
 	if (cv_debugrender_visplanes.value)
@@ -1728,4 +1755,5 @@ void R_RegisterEngineStuff(void)
 	// debugging
 
 	COM_AddDebugCommand("debugrender_highlight", Command_Debugrender_highlight);
+	COM_AddDebugCommand("interpbench", Command_InterpBench_f);
 }
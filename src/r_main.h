@@ -107,6 +107,20 @@ extern precise_t ps_sw_portaltime;
 extern precise_t ps_sw_planetime;
 extern precise_t ps_sw_maskedtime;
 
+// Per-portal breakdown of ps_sw_portaltime
+#define MAXPORTALSTATS 16
+
+struct portalstats_t
+{
+	precise_t time; // BSP, walls and plane setup for this viewpoint
+	size_t drawsegs;
+	UINT8 pass;
+	boolean isskybox;
+};
+
+extern portalstats_t ps_sw_portals[MAXPORTALSTATS];
+extern int ps_sw_numportals;
+
 extern int ps_numbspcalls;
 extern int ps_numsprites;
 extern int ps_numdrawnodes;
@@ -332,6 +332,7 @@ static visplane_t *new_visplane(unsigned hash)
 			freehead = &freetail;
 	}
 	check->next = visplanes[hash];
+	check->drawn = false;
 	visplanes[hash] = check;
 
 	g_renderstats.visplanes++;
@@ -437,7 +438,8 @@ visplane_t *R_FindPlane(fixed_t height, INT32 picnum, INT32 lightlevel,
 				&& check->slope == slope
 				&& check->noencore == noencore
 				&& check->ripple == ripple
-				&& check->damage == damage)
+				&& check->damage == damage
+				&& !check->drawn)
 			{
 				return check;
 			}
@@ -657,7 +659,7 @@ static void R_MakeSpans(void (*mapfunc)(drawspandata_t* ds, void(*spanfunc)(draw
 		spanstart[b2--] = x;
 }
 
-void R_DrawPlanes(void)
+static void R_DrawPendingPlanes(void)
 {
 	visplane_t *pl;
 	INT32 i;
@@ -671,14 +673,38 @@ void R_DrawPlanes(void)
 	{
 		for (pl = visplanes[i]; pl; pl = pl->next)
 		{
-			if (pl->ffloor != NULL || pl->polyobj != NULL)
+			if (pl->drawn || pl->ffloor != NULL || pl->polyobj != NULL)
 				continue;
 
 			R_DrawSinglePlane(&ds, pl, cv_parallelsoftware.value);
+			pl->drawn = true;
 		}
 	}
 }
 
+//
+// R_FlushPlanes
+// Draws the visplanes of a finished viewpoint, so their spans can be
+// drawn by the thread pool while the next portal is being traversed.
+// Flushed planes are sealed and never handed out by R_FindPlane again.
+//
+void R_FlushPlanes(void)
+{
+	// R_DrawSinglePlane rotates viewangle, but the caller is
+	// still in the middle of setting up its viewpoint.
+	const angle_t oldviewangle = viewangle;
+
+	R_DrawPendingPlanes();
+	srb2::g_main_threadpool->notify();
+
+	viewangle = oldviewangle;
+}
+
+void R_DrawPlanes(void)
+{
+	R_DrawPendingPlanes();
+}
+
 // R_DrawSkyPlane
 //
 // Draws the sky within the plane's top/bottom bounds
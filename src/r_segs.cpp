@@ -13,6 +13,8 @@
 /// \brief All the clipping: columns, horizontal spans, sky columns
 
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include <tracy/tracy/Tracy.hpp>
 
@@ -1372,6 +1374,69 @@ UINT32 nombre = 100000;
 #endif
 //profile stuff ---------------------------------------------------------
 
+// Solid wall columns never overlap each other, nor the planes and portals
+// around them, so they can be drawn on the thread pool while the BSP
+// traversal continues. Columns are grouped to keep the task count down;
+// batches are recycled every frame, after the render semaphore is waited on.
+namespace
+{
+
+constexpr const size_t kWallColumnTaskGranularity = 16;
+
+struct WallColumnBatch
+{
+	size_t count;
+	coldrawfunc_t* funcs[kWallColumnTaskGranularity];
+	drawcolumndata_t columns[kWallColumnTaskGranularity];
+};
+
+std::vector<std::unique_ptr<WallColumnBatch>> g_wallbatches;
+size_t g_wallbatches_used = 0;
+WallColumnBatch* g_wallbatch = nullptr;
+
+} // namespace
+
+void R_ClearWallColumns(void)
+{
+	g_wallbatches_used = 0;
+	g_wallbatch = nullptr;
+}
+
+void R_FlushWallColumns(void)
+{
+	WallColumnBatch* batch = g_wallbatch;
+
+	if (batch == nullptr)
+		return;
+
+	g_wallbatch = nullptr;
+
+	srb2::g_main_threadpool->schedule([batch]() {
+		for (size_t i = 0; i < batch->count; i++)
+		{
+			batch->funcs[i](&batch->columns[i]);
+		}
+	});
+}
+
+static void R_QueueWallColumn(coldrawfunc_t* func, const drawcolumndata_t& dc)
+{
+	if (g_wallbatch == nullptr)
+	{
+		if (g_wallbatches_used >= g_wallbatches.size())
+			g_wallbatches.push_back(std::make_unique<WallColumnBatch>());
+
+		g_wallbatch = g_wallbatches[g_wallbatches_used++].get();
+		g_wallbatch->count = 0;
+	}
+
+	g_wallbatch->funcs[g_wallbatch->count] = func;
+	g_wallbatch->columns[g_wallbatch->count] = dc;
+
+	if (++g_wallbatch->count >= kWallColumnTaskGranularity)
+		R_FlushWallColumns();
+}
+
 static void R_DrawWallColumn(drawcolumndata_t* dc, INT32 yl, INT32 yh, fixed_t mid, fixed_t texturecolumn, INT32 texture, boolean brightmapped, boolean remap)
 {
 	dc->yl = yl;
@@ -1389,6 +1454,14 @@ static void R_DrawWallColumn(drawcolumndata_t* dc, INT32 yl, INT32 yh, fixed_t m
 		dc_copy.colormap += COLORMAP_REMAPOFFSET;
 		dc_copy.fullbright += COLORMAP_REMAPOFFSET;
 	}
+
+	// Shadowed columns read dc->lightlist, which is rewritten every column.
+	if (cv_parallelsoftware.value && dc_copy.numlights == 0)
+	{
+		R_QueueWallColumn(colfunccopy, dc_copy);
+		return;
+	}
+
 	colfunccopy(const_cast<drawcolumndata_t*>(&dc_copy));
 }
 
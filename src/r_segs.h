@@ -24,6 +24,10 @@ void R_RenderMaskedSegRange(drawseg_t *ds, INT32 x1, INT32 x2);
 void R_RenderThickSideRange(drawseg_t *ds, INT32 x1, INT32 x2, ffloor_t *pffloor);
 void R_StoreWallRange(INT32 start, INT32 stop);
 
+// Parallel wall column drawing, see R_RenderPlayerView.
+void R_ClearWallColumns(void);
+void R_FlushWallColumns(void);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -22,6 +22,7 @@
 #include "../audio/resample.hpp"
 #include "../audio/sound_chunk.hpp"
 #include "../audio/sound_effect_player.hpp"
+#include "../core/trace.h"
 #include "../cxxutil.hpp"
 #include "../io/streams.hpp"
 
@@ -134,6 +135,14 @@ void audio_callback(void* userdata, Uint8* buffer, int len)
 	FrameMarkStart(kAudio);
 	ZoneScoped;
 
+	static thread_local bool trace_named = false;
+	if (!trace_named)
+	{
+		Trace_SetThreadName("SDL Audio Thread");
+		trace_named = true;
+	}
+	TraceScoped("Audio Mix");
+
 	// The SDL Audio lock is implied to be held during callback.
 
 	try
@@ -406,6 +406,9 @@ TYPEDEF (viewvars_t);
 TYPEDEF (interpmobjstate_t);
 TYPEDEF (levelinterpolator_t);
 
+// r_main.h
+TYPEDEF (portalstats_t);
+
 // r_picformats.h
 TYPEDEF (spriteframepivot_t);
 TYPEDEF (spriteinfo_t);
@@ -463,6 +466,7 @@ TYPEDEF (cliprect_t);
 TYPEDEF (filelump_t);
 TYPEDEF (wadinfo_t);
 TYPEDEF (lumpinfo_t);
+TYPEDEF (lumpindex_t);
 TYPEDEF (virtlump_t);
 TYPEDEF (virtres_t);
 TYPEDEF (wadfile_t);
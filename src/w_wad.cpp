@@ -33,6 +33,13 @@
 #ifdef __GNUC__
 #include <unistd.h>
 #endif
+#include <sys/stat.h>
+#include <time.h>
+
+#if defined (UNIXCOMMON) || defined (__APPLE__)
+#include <sys/mman.h>
+#define HAVE_MMAP
+#endif
 
 #define ZWAD
 
@@ -42,7 +49,12 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "doomdef.h"
 #include "doomstat.h"
@@ -67,11 +79,17 @@
 #include "r_picformats.h"
 #include "i_time.h"
 #include "i_system.h"
+#include "m_argv.h"
 #include "md5.h"
 #include "lua_script.h"
 #include "g_game.h" // G_SetGameModified
 
 #include "k_terrain.h"
+#include "byteptr.h"
+#include "p_saveg.h" // savebuffer_t
+#include "m_misc.h" // FIL_WriteFile
+#include "d_main.h" // srb2home, pandf
+#include "core/thread_pool.h"
 
 #ifdef HWRENDER
 #include "hardware/hw_main.h"
@@ -113,6 +131,12 @@ static UINT16 lumpnumcacheindex = 0;
 UINT16 numwadfiles = 0; // number of active wadfiles
 wadfile_t *wadfiles[MAX_WADFILES]; // 0 to numwadfiles-1 are valid
 
+static void W_FreeLumpIndex(wadfile_t *wad);
+static void W_UnmapFile(wadfile_t *wad);
+#ifndef NOMD5
+static void W_SaveMD5Cache(void);
+#endif
+
 // W_Shutdown
 // Closes all of the WAD files before quitting
 // If not done on a Mac then open wad files
@@ -120,11 +144,17 @@ wadfile_t *wadfiles[MAX_WADFILES]; // 0 to numwadfiles-1 are valid
 // being ejected
 void W_Shutdown(void)
 {
+#ifndef NOMD5
+	W_SaveMD5Cache(); // for files that were only checked, e.g. when joining
+#endif
+
 	while (numwadfiles--)
 	{
 		wadfile_t *wad = wadfiles[numwadfiles];
 
+		W_UnmapFile(wad);
 		fclose(wad->handle);
+		W_FreeLumpIndex(wad);
 		Z_Free(wad->filename);
 		while (wad->numlumps--)
 		{
@@ -281,16 +311,220 @@ static inline void W_LoadDehackedLumps(UINT16 wadnum, boolean mainfile)
 	}
 }
 
+#ifndef NOMD5
+// ==========================================================================
+// MD5 CACHE
+// ==========================================================================
+
+// Hashing every file on every launch is most of the startup time with a
+// lot of addons, so the sums are kept in srb2home between launches. An
+// entry is only trusted while the file's size and modification time still
+// match. Files modified within the last few seconds aren't cached at all,
+// since another write in the same second wouldn't change the mtime.
+
+#define MD5CACHEFILE "md5cache.dat"
+#define MD5CACHEHEADER "RRMD5CACHE"
+#define MD5CACHEVER 1
+#define MD5CACHERACY 2 // seconds
+
+struct md5cacheentry_t
+{
+	UINT64 size;
+	INT64 mtime;
+	UINT8 md5sum[16];
+};
+
+static std::unordered_map<std::string, md5cacheentry_t> md5cache;
+static boolean md5cacheloaded = false;
+static boolean md5cachedirty = false;
+
+static boolean W_StatFile(const char *filename, UINT64 *size, INT64 *mtime)
+{
+	struct stat st;
+
+	if (stat(filename, &st) != 0)
+		return false;
+
+	*size = (UINT64)st.st_size;
+	*mtime = (INT64)st.st_mtime;
+	return true;
+}
+
+// Anything that doesn't look right just leaves the cache empty;
+// the worst that happens is the files get hashed again.
+static void W_LoadMD5Cache(void)
+{
+	const size_t headerlen = strlen(MD5CACHEHEADER);
+	savebuffer_t save = {0};
+	UINT32 count;
+
+	md5cacheloaded = true;
+
+	if (M_CheckParm("-nomd5cache"))
+		return;
+
+	if (P_SaveBufferFromFile(&save, va(pandf, srb2home, MD5CACHEFILE)) == false)
+		return;
+
+	if (save.size < headerlen + sizeof (UINT8) + sizeof (UINT32)
+		|| strncmp(MD5CACHEHEADER, (const char *)save.buffer, headerlen))
+	{
+		P_SaveBufferFree(&save);
+		return;
+	}
+
+	save.p += headerlen;
+	if (READUINT8(save.p) != MD5CACHEVER)
+	{
+		P_SaveBufferFree(&save);
+		return;
+	}
+
+	count = READUINT32(save.p);
+
+	while (count--)
+	{
+		md5cacheentry_t entry;
+		UINT16 pathlen;
+
+		if (P_SaveBufferRemaining(&save) < sizeof (UINT16))
+			break;
+		pathlen = READUINT16(save.p);
+
+		if (P_SaveBufferRemaining(&save) < pathlen + sizeof (UINT64) + sizeof (INT64) + sizeof entry.md5sum)
+			break;
+
+		std::string path(reinterpret_cast<const char *>(save.p), pathlen);
+		save.p += pathlen;
+		entry.size = READUINT32(save.p);
+		entry.size |= (UINT64)READUINT32(save.p) << 32;
+		entry.mtime = READUINT32(save.p);
+		entry.mtime |= (INT64)((UINT64)READUINT32(save.p) << 32);
+		READMEM(save.p, entry.md5sum, sizeof entry.md5sum);
+
+		md5cache[std::move(path)] = entry;
+	}
+
+	P_SaveBufferFree(&save);
+}
+
+// Writes the cache back out if anything was added, dropping files that
+// have since changed or gone away.
+static void W_SaveMD5Cache(void)
+{
+	const size_t headerlen = strlen(MD5CACHEHEADER);
+	savebuffer_t save = {0};
+	size_t length = headerlen + sizeof (UINT8) + sizeof (UINT32);
+	UINT32 count = 0;
+
+	if (!md5cachedirty || M_CheckParm("-nomd5cache"))
+		return;
+
+	md5cachedirty = false;
+
+	for (auto it = md5cache.begin(); it != md5cache.end();)
+	{
+		UINT64 size;
+		INT64 mtime;
+
+		if (!W_StatFile(it->first.c_str(), &size, &mtime) || size != it->second.size || mtime != it->second.mtime)
+		{
+			it = md5cache.erase(it);
+			continue;
+		}
+
+		length += sizeof (UINT16) + it->first.size() + sizeof (UINT64) + sizeof (INT64) + sizeof it->second.md5sum;
+		++it;
+	}
+
+	if (P_SaveBufferAlloc(&save, length) == false)
+		return;
+
+	WRITESTRINGN(save.p, MD5CACHEHEADER, headerlen);
+	WRITEUINT8(save.p, MD5CACHEVER);
+	UINT8 *countp = save.p;
+	WRITEUINT32(save.p, 0);
+
+	for (const auto &it : md5cache)
+	{
+		if (it.first.size() > UINT16_MAX)
+			continue;
+
+		WRITEUINT16(save.p, (UINT16)it.first.size());
+		WRITEMEM(save.p, it.first.data(), it.first.size());
+		// no 64-bit byteptr macros, so low word first
+		WRITEUINT32(save.p, (UINT32)it.second.size);
+		WRITEUINT32(save.p, (UINT32)(it.second.size >> 32));
+		WRITEUINT32(save.p, (UINT32)it.second.mtime);
+		WRITEUINT32(save.p, (UINT32)((UINT64)it.second.mtime >> 32));
+		WRITEMEM(save.p, it.second.md5sum, sizeof it.second.md5sum);
+		count++;
+	}
+
+	WRITEUINT32(countp, count);
+
+	if (!FIL_WriteFile(va(pandf, srb2home, MD5CACHEFILE), save.buffer, save.p - save.buffer))
+		CONS_Alert(CONS_WARNING, "Couldn't save %s\n", MD5CACHEFILE);
+
+	P_SaveBufferFree(&save);
+}
+
+// Main thread only.
+static boolean W_LookupMD5Cache(const char *filename, void *resblock)
+{
+	UINT64 size;
+	INT64 mtime;
+
+	if (!md5cacheloaded)
+		W_LoadMD5Cache();
+
+	auto it = md5cache.find(filename);
+	if (it == md5cache.end())
+		return false;
+
+	if (!W_StatFile(filename, &size, &mtime) || size != it->second.size || mtime != it->second.mtime)
+	{
+		md5cache.erase(it);
+		md5cachedirty = true;
+		return false;
+	}
+
+	M_Memcpy(resblock, it->second.md5sum, 16);
+	return true;
+}
+
+// Main thread only. Call right after hashing the file.
+static void W_StoreMD5Cache(const char *filename, const void *md5sum)
+{
+	md5cacheentry_t entry;
+
+	if (!md5cacheloaded)
+		W_LoadMD5Cache();
+
+	if (!W_StatFile(filename, &entry.size, &entry.mtime))
+		return;
+
+	// Too fresh to tell apart from a write still going on
+	if (entry.mtime + MD5CACHERACY >= (INT64)time(NULL))
+		return;
+
+	M_Memcpy(entry.md5sum, md5sum, 16);
+	md5cache[filename] = entry;
+	md5cachedirty = true;
+}
+#endif // NOMD5
+
 /** Compute MD5 message digest for bytes read from STREAM of this filname.
   *
   * The resulting message digest number will be written into the 16 bytes
-  * beginning at RESBLOCK.
+  * beginning at RESBLOCK. Unchanged files come out of the MD5 cache
+  * instead of being read again.
   *
   * \param filename path of file
   * \param resblock resulting MD5 checksum
   * \return 0 if MD5 checksum was made, and is at resblock, 1 if error was found
   */
-static inline INT32 W_MakeFileMD5(const char *filename, void *resblock)
+INT32 W_MakeFileMD5(const char *filename, void *resblock)
 {
 #ifdef NOMD5
 	(void)filename;
@@ -298,6 +532,9 @@ static inline INT32 W_MakeFileMD5(const char *filename, void *resblock)
 #else
 	FILE *fhandle;
 
+	if (W_LookupMD5Cache(filename, resblock))
+		return 0;
+
 	if ((fhandle = fopen(filename, "rb")) != NULL)
 	{
 		tic_t t = I_GetTime();
@@ -310,6 +547,7 @@ static inline INT32 W_MakeFileMD5(const char *filename, void *resblock)
 		CONS_Debug(DBG_SETUP, "MD5 calc for %s took %f seconds\n",
 			filename, (float)(I_GetTime() - t)/NEWTICRATE);
 		fclose(fhandle);
+		W_StoreMD5Cache(filename, resblock);
 		return 0;
 	}
 #endif
@@ -322,6 +560,386 @@ static void W_InvalidateLumpnumCache(void)
 	memset(lumpnumcache, 0, sizeof (lumpnumcache));
 }
 
+// Maps the whole file read-only, so lumps can be read with a plain memcpy
+// (or none at all) instead of seeking and reading through stdio.
+// Files that can't be mapped just keep using the handle.
+static void W_MapFile(wadfile_t *wad)
+{
+	wad->view = NULL;
+
+#ifdef HAVE_MMAP
+	if (wad->filesize == 0 || M_CheckParm("-nommap"))
+		return;
+
+	void *view = mmap(NULL, wad->filesize, PROT_READ, MAP_PRIVATE, fileno(wad->handle), 0);
+	if (view == MAP_FAILED)
+	{
+		CONS_Debug(DBG_SETUP, "Could not map %s, reading it normally\n", wad->filename);
+		return;
+	}
+
+	wad->view = static_cast<const UINT8*>(view);
+#endif
+}
+
+static void W_UnmapFile(wadfile_t *wad)
+{
+#ifdef HAVE_MMAP
+	if (wad->view)
+		munmap(const_cast<UINT8*>(wad->view), wad->filesize);
+#endif
+	wad->view = NULL;
+}
+
+// Where 'length' bytes at 'position' are in the mapping, or NULL if they aren't mapped.
+static const UINT8 *W_FileView(const wadfile_t *wad, size_t position, size_t length)
+{
+	if (wad->view == NULL || position > wad->filesize || length > wad->filesize - position)
+		return NULL;
+	return wad->view + position;
+}
+
+// ==========================================================================
+// LUMP DIRECTORY INDEX
+// ==========================================================================
+
+// Every wad gets a hash index of its directory when it's added, so name
+// lookups don't have to walk tens of thousands of lumps per file. Each
+// name maps to a chain of every lump carrying it, in ascending lump order,
+// which keeps the 'startlump' semantics of the old forward scans intact.
+
+// Folder "keys" aren't NUL terminated anywhere, so they're stored as runs
+// of consecutive lumps that share the prefix.
+struct lumpfolder_t
+{
+	const char *path; // points into the fullname of the first lump in the folder
+	size_t length;    // including the trailing '/'
+	UINT32 hash;
+	std::vector<std::pair<UINT16, UINT16>> runs; // [start, end) lump ranges
+};
+
+// Lookup statistics, see W_PrintLumpIndexStats
+static struct
+{
+	UINT32 lookups;
+	UINT32 fallbacks;
+	precise_t buildtime;
+	precise_t looktime;
+} lumpindexstats;
+
+namespace
+{
+
+constexpr UINT32 kEmptySlot = UINT32_MAX;
+constexpr UINT16 kEndOfChain = UINT16_MAX; // INT16_MAX is a valid lump here
+
+// Open addressing, linear probing. The table is kept at most half full.
+class LumpNameTable
+{
+public:
+	// key(lump) returns the string for that lump, or NULL to leave it out
+	template <typename Key, typename Hash>
+	void build(UINT16 numlumps, Key key, Hash hashof)
+	{
+		size_t size = 16;
+		while (size < (size_t)numlumps * 2)
+			size <<= 1;
+
+		std::vector<UINT16> tail(size, kEndOfChain);
+
+		mask_ = (UINT32)(size - 1);
+		slots_.assign(size, Slot {0, kEmptySlot});
+		next_.assign(numlumps, kEndOfChain);
+
+		for (UINT16 i = 0; i < numlumps; i++)
+		{
+			const char *name = key(i);
+			if (name == NULL)
+				continue;
+
+			UINT32 hash = hashof(name);
+			UINT32 pos = find(hash, name, key);
+
+			if (slots_[pos].head == kEmptySlot)
+				slots_[pos] = Slot {hash, i};
+			else
+				next_[tail[pos]] = i;
+			tail[pos] = i;
+		}
+	}
+
+	// First lump at or after startlump with this name, INT16_MAX if none
+	template <typename Key>
+	UINT16 lookup(const char *name, UINT32 hash, UINT16 startlump, Key key) const
+	{
+		if (slots_.empty())
+			return INT16_MAX;
+
+		UINT32 head = slots_[find(hash, name, key)].head;
+		if (head == kEmptySlot)
+			return INT16_MAX;
+
+		UINT16 i = (UINT16)head;
+		while (i != kEndOfChain && i < startlump)
+			i = next_[i];
+		return i == kEndOfChain ? INT16_MAX : i;
+	}
+
+	// The lump after this one with the same name, INT16_MAX if none
+	UINT16 next(UINT16 lump) const { return next_[lump] == kEndOfChain ? INT16_MAX : next_[lump]; }
+
+	size_t bytes() const { return slots_.capacity() * sizeof (Slot) + next_.capacity() * sizeof (UINT16); }
+
+private:
+	struct Slot
+	{
+		UINT32 hash;
+		UINT32 head;
+	};
+
+	// The slot holding this name, or the empty one it would go in
+	template <typename Key>
+	UINT32 find(UINT32 hash, const char *name, Key key) const
+	{
+		UINT32 pos = hash & mask_;
+
+		while (slots_[pos].head != kEmptySlot)
+		{
+			if (slots_[pos].hash == hash && key.equals((UINT16)slots_[pos].head, name))
+				break;
+			pos = (pos + 1) & mask_;
+		}
+
+		return pos;
+	}
+
+	std::vector<Slot> slots_;
+	std::vector<UINT16> next_;
+	UINT32 mask_ = 0;
+};
+
+} // namespace
+
+struct lumpindex_t
+{
+	LumpNameTable names;     // lumpinfo_t::name, compared up to 8 characters
+	LumpNameTable longnames; // lumpinfo_t::longname
+	LumpNameTable fullnames; // lumpinfo_t::fullname, PK3 only
+	std::vector<lumpfolder_t> folders; // PK3 only
+	std::vector<UINT32> folderslots;   // open addressing into folders
+};
+
+namespace
+{
+
+UINT32 W_HashShortName(const char *name)
+{
+	return quickncasehash(name, 8);
+}
+
+UINT32 W_HashLongName(const char *name)
+{
+	return quickncasehash(name, SIZE_MAX);
+}
+
+struct ShortNameKey
+{
+	const lumpinfo_t *lumpinfo;
+	const char *operator()(UINT16 i) const { return lumpinfo[i].name; }
+	bool equals(UINT16 i, const char *name) const { return !strncasecmp(lumpinfo[i].name, name, 8); }
+};
+
+struct LongNameKey
+{
+	const lumpinfo_t *lumpinfo;
+	const char *operator()(UINT16 i) const { return lumpinfo[i].longname; }
+	bool equals(UINT16 i, const char *name) const { return !strcasecmp(lumpinfo[i].longname, name); }
+};
+
+struct FullNameKey
+{
+	const lumpinfo_t *lumpinfo;
+	const char *operator()(UINT16 i) const { return lumpinfo[i].fullname; }
+	bool equals(UINT16 i, const char *name) const { return !strcasecmp(lumpinfo[i].fullname, name); }
+};
+
+UINT32 *W_FindFolderSlot(lumpindex_t *index, const char *path, size_t length, UINT32 hash)
+{
+	UINT32 mask = (UINT32)(index->folderslots.size() - 1);
+	UINT32 pos = hash & mask;
+
+	for (;;)
+	{
+		UINT32 *slot = &index->folderslots[pos];
+		if (*slot == kEmptySlot)
+			return slot;
+
+		const lumpfolder_t &folder = index->folders[*slot];
+		if (folder.hash == hash && folder.length == length && !strncasecmp(folder.path, path, length))
+			return slot;
+
+		pos = (pos + 1) & mask;
+	}
+}
+
+void W_GrowFolderSlots(lumpindex_t *index)
+{
+	index->folderslots.assign(std::max<size_t>(16, index->folderslots.size() * 2), kEmptySlot);
+
+	for (UINT32 i = 0; i < index->folders.size(); i++)
+	{
+		const lumpfolder_t &folder = index->folders[i];
+		*W_FindFolderSlot(index, folder.path, folder.length, folder.hash) = i;
+	}
+}
+
+void W_IndexFolders(lumpindex_t *index, const lumpinfo_t *lumpinfo, UINT16 numlumps)
+{
+	W_GrowFolderSlots(index);
+
+	for (UINT16 i = 0; i < numlumps; i++)
+	{
+		const char *fullname = lumpinfo[i].fullname;
+		UINT32 hash = 5381;
+
+		// Every '/' ends a folder this lump is in, including its parents.
+		// (quickncasehash, done incrementally.)
+		for (size_t j = 0; fullname[j]; j++)
+		{
+			hash = (hash * 33) ^ tolower(fullname[j]);
+
+			if (fullname[j] != '/')
+				continue;
+
+			UINT32 *slot = W_FindFolderSlot(index, fullname, j + 1, hash);
+			if (*slot == kEmptySlot)
+			{
+				*slot = (UINT32)index->folders.size();
+				index->folders.push_back({fullname, j + 1, hash, {}});
+
+				if (index->folders.size() * 2 > index->folderslots.size())
+					W_GrowFolderSlots(index);
+			}
+
+			lumpfolder_t &folder = index->folders[*W_FindFolderSlot(index, fullname, j + 1, hash)];
+			if (!folder.runs.empty() && folder.runs.back().second == i)
+				folder.runs.back().second = i + 1;
+			else
+				folder.runs.emplace_back(i, i + 1);
+		}
+	}
+}
+
+// The folder 'name' names, if it is one, or NULL for anything else
+const lumpfolder_t *W_LookupFolder(const wadfile_t *wad, const char *name)
+{
+	lumpindex_t *index = wad->index;
+	size_t length = strlen(name);
+
+	if (index == NULL || index->folderslots.empty() || length == 0 || name[length - 1] != '/')
+		return NULL;
+
+	UINT32 slot = *W_FindFolderSlot(index, name, length, quickncasehash(name, length));
+	if (slot == kEmptySlot)
+		return NULL;
+	return &index->folders[slot];
+}
+
+// Whether a lump in [startlump, end) has a full name that starts with 'name'.
+// Those can only be in the folder 'name' is in, so only its runs are scanned.
+bool W_PrefixMatchBefore(const wadfile_t *wad, const char *name, UINT16 startlump, UINT16 end)
+{
+	size_t length = strlen(name);
+	const char *slash = strrchr(name, '/');
+	std::pair<UINT16, UINT16> whole(startlump, end);
+	const std::pair<UINT16, UINT16> *runs = &whole;
+	size_t numruns = 1;
+
+	if (slash != NULL)
+	{
+		size_t folderlength = slash - name + 1;
+		UINT32 slot = *W_FindFolderSlot(wad->index, name, folderlength, quickncasehash(name, folderlength));
+
+		if (slot == kEmptySlot)
+			return false;
+
+		runs = wad->index->folders[slot].runs.data();
+		numruns = wad->index->folders[slot].runs.size();
+	}
+
+	for (size_t r = 0; r < numruns; r++)
+	{
+		UINT16 last = std::min(runs[r].second, end);
+
+		for (UINT16 i = std::max(runs[r].first, startlump); i < last; i++)
+		{
+			if (!strnicmp(name, wad->lumpinfo[i].fullname, length))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+} // namespace
+
+static void W_BuildLumpIndex(wadfile_t *wad)
+{
+	precise_t t = I_GetPreciseTime();
+	lumpindex_t *index = new lumpindex_t;
+
+	index->names.build(wad->numlumps, ShortNameKey {wad->lumpinfo}, W_HashShortName);
+	index->longnames.build(wad->numlumps, LongNameKey {wad->lumpinfo}, W_HashLongName);
+
+	if (wad->type == RET_PK3)
+	{
+		index->fullnames.build(wad->numlumps, FullNameKey {wad->lumpinfo}, W_HashLongName);
+		W_IndexFolders(index, wad->lumpinfo, wad->numlumps);
+	}
+
+	wad->index = index;
+	lumpindexstats.buildtime += I_GetPreciseTime() - t;
+}
+
+static void W_FreeLumpIndex(wadfile_t *wad)
+{
+	delete wad->index;
+	wad->index = NULL;
+}
+
+// Reports what the index has been up to. Load a big addon set and then
+// run "lumpstats" to compare against the plain scans.
+void W_PrintLumpIndexStats(void)
+{
+	const double us = 1000000.0 / I_GetPrecisePrecision();
+	size_t bytes = 0;
+	size_t folders = 0;
+	UINT32 numlumps = 0;
+	UINT16 i;
+
+	for (i = 0; i < numwadfiles; i++)
+	{
+		const lumpindex_t *index = wadfiles[i]->index;
+
+		numlumps += wadfiles[i]->numlumps;
+		if (index == NULL)
+			continue;
+
+		bytes += index->names.bytes() + index->longnames.bytes() + index->fullnames.bytes();
+		bytes += index->folderslots.size() * sizeof (UINT32);
+		for (const lumpfolder_t &folder : index->folders)
+			bytes += sizeof folder + folder.runs.size() * sizeof folder.runs[0];
+		folders += index->folders.size();
+	}
+
+	CONS_Printf("%u lumps in %u files, %s folders, ~%s KiB of index\n",
+		numlumps, numwadfiles, sizeu1(folders), sizeu2(bytes / 1024));
+	CONS_Printf("Index built in %.0f us\n", (double)lumpindexstats.buildtime * us);
+	CONS_Printf("%u lookups, %u linear fallbacks, %.0f us spent searching\n",
+		lumpindexstats.lookups, lumpindexstats.fallbacks,
+		(double)lumpindexstats.looktime * us);
+}
+
 /** Detect a file type.
  * \todo Actually detect the wad/pkzip headers and whatnot, instead of just checking the extensions.
  */
@@ -780,7 +1398,9 @@ static UINT16 W_InitFileError (const char *filename, boolean exitworthy)
 //
 // Can now load dehacked files (.soc)
 //
-UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
+// premd5, if not NULL, is the file's MD5 already worked out by W_InitMultipleFiles.
+//
+static UINT16 W_InitFileEx(const char *filename, boolean mainfile, boolean startup, const UINT8 *premd5)
 {
 	FILE *handle;
 	lumpinfo_t *lumpinfo = NULL;
@@ -837,7 +1457,10 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
 	// Let's not add a wad file if the MD5 matches
 	// an MD5 of an already added WAD file!
 	//
-	W_MakeFileMD5(filename, md5sum);
+	if (premd5)
+		M_Memcpy(md5sum, premd5, 16);
+	else
+		W_MakeFileMD5(filename, md5sum);
 
 	for (i = 0; i < numwadfiles; i++)
 	{
@@ -902,10 +1525,13 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
 	fseek(handle, 0, SEEK_END);
 	wadfile->filesize = (unsigned)ftell(handle);
 	wadfile->type = type;
+	W_MapFile(wadfile);
 
 	// already generated, just copy it over
 	M_Memcpy(&wadfile->md5sum, &md5sum, 16);
 
+	W_BuildLumpIndex(wadfile);
+
 	//
 	// set up caching
 	//
@@ -958,6 +1584,65 @@ UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
 	return wadfile->numlumps;
 }
 
+UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup)
+{
+	UINT16 numlumps = W_InitFileEx(filename, mainfile, startup, NULL);
+#ifndef NOMD5
+	if (!startup)
+		W_SaveMD5Cache(); // addfile
+#endif
+	return numlumps;
+}
+
+// A file W_InitMultipleFiles is hashing ahead of time
+struct prefetchfile_t
+{
+	std::string path; // after searching, so the workers don't have to
+	UINT8 md5sum[16];
+	std::atomic<boolean> hashed;
+	boolean cached; // md5sum came out of the MD5 cache
+	srb2::ThreadPool::Sema sema;
+};
+
+// Finds the file and starts hashing it on the thread pool.
+// Hashing reads the whole file, which also leaves it in the OS file
+// cache for the directory parsing and lump loading that come after.
+static void W_PrefetchFile(prefetchfile_t *file, const char *filename)
+{
+	FILE *handle;
+
+	file->hashed = false;
+	file->cached = false;
+
+	// Not a wad we can open? W_InitFile will say so.
+	if ((handle = W_OpenWadFile(&filename, false)) == NULL)
+		return;
+
+	fclose(handle);
+	file->path = filename;
+
+#ifndef NOMD5
+	if (W_LookupMD5Cache(file->path.c_str(), file->md5sum))
+	{
+		file->hashed = file->cached = true;
+		return;
+	}
+
+	srb2::g_main_threadpool->begin_sema();
+	srb2::g_main_threadpool->schedule([file]()
+	{
+		// No CONS_ calls in here, we're off the main thread
+		FILE *fhandle = fopen(file->path.c_str(), "rb");
+		if (fhandle == NULL)
+			return;
+		if (md5_stream(fhandle, file->md5sum) == 0)
+			file->hashed = true;
+		fclose(fhandle);
+	});
+	file->sema = srb2::g_main_threadpool->end_sema();
+#endif
+}
+
 /** Tries to load a series of files.
   * All files are wads unless they have an extension of ".soc" or ".lua".
   *
@@ -971,23 +1656,63 @@ INT32 W_InitMultipleFiles(char **filenames, boolean addons)
 {
 	INT32 rc = 1;
 	INT32 overallrc = 1;
+	size_t numfiles = 0;
+	size_t i;
+
+	while (filenames[numfiles])
+		numfiles++;
+
+	// Hash every file on the thread pool first, then add them one at a
+	// time, in order, on this thread. Adding a file runs its SOCs and Lua
+	// and has to stay deterministic; MD5ing it doesn't.
+	std::unique_ptr<prefetchfile_t[]> prefetch;
+	if (srb2::g_main_threadpool && numfiles > 1)
+	{
+		prefetch = std::make_unique<prefetchfile_t[]>(numfiles);
+		for (i = 0; i < numfiles; i++)
+			W_PrefetchFile(&prefetch[i], filenames[i]);
+		srb2::g_main_threadpool->notify();
+	}
 
 	// will be realloced as lumps are added
-	for (; *filenames; filenames++)
+	for (i = 0; i < numfiles; i++)
 	{
-		if (addons && !W_VerifyNMUSlumps(*filenames, !addons))
+		const char *filename = filenames[i];
+		const UINT8 *premd5 = NULL;
+
+		if (addons && !W_VerifyNMUSlumps(filename, !addons))
 			G_SetGameModified(true, false);
 
-		//CONS_Debug(DBG_SETUP, "Loading %s\n", *filenames);
-		rc = W_InitFile(*filenames, !addons, true);
+		if (prefetch)
+		{
+			// Helps out with the other files' hashes while it waits.
+			srb2::g_main_threadpool->wait_sema(prefetch[i].sema);
+			if (!prefetch[i].path.empty())
+				filename = prefetch[i].path.c_str();
+			if (prefetch[i].hashed)
+			{
+				premd5 = prefetch[i].md5sum;
+#ifndef NOMD5
+				if (!prefetch[i].cached)
+					W_StoreMD5Cache(filename, premd5);
+#endif
+			}
+		}
+
+		//CONS_Debug(DBG_SETUP, "Loading %s\n", filename);
+		rc = W_InitFileEx(filename, !addons, true, premd5);
 		if (rc == INT16_MAX)
-			CONS_Printf(M_GetText("Errors occurred while loading %s; not added.\n"), *filenames);
+			CONS_Printf(M_GetText("Errors occurred while loading %s; not added.\n"), filenames[i]);
 		overallrc &= (rc != INT16_MAX) ? 1 : 0;
 	}
 
 	if (!numwadfiles)
 		I_Error("W_InitMultipleFiles: no files found");
 
+#ifndef NOMD5
+	W_SaveMD5Cache();
+#endif
+
 	return overallrc;
 }
 
@@ -1067,20 +1792,20 @@ UINT16 W_FindNextEmptyInPwad(UINT16 wad, UINT16 startlump)
 // Get a map marker for WADs, and a standalone WAD file lump inside PK3s. Takes uppercase names only
 UINT16 W_CheckNumForMapPwad(const char *name, UINT32 hash, UINT16 wad, UINT16 startlump)
 {
+	const lumpindex_t *index = wadfiles[wad]->index;
+	LongNameKey key {wadfiles[wad]->lumpinfo};
 	UINT16 i, end;
 
+	(void)hash; // the index hashes the whole name
+
+	lumpindexstats.lookups++;
+
 	if (wadfiles[wad]->type == RET_WAD)
 	{
-		for (i = startlump; i < wadfiles[wad]->numlumps; i++)
+		// (always use longname, even in wads, to accomodate WADNAME)
+		for (i = index->longnames.lookup(name, W_HashLongName(name), startlump, key);
+			i != INT16_MAX; i = index->longnames.next(i))
 		{
-			// Not the hash?
-			if ((wadfiles[wad]->lumpinfo + i)->hash != hash)
-				continue;
-
-			// Not the name? (always use longname, even in wads, to accomodate WADNAME)
-			if (strcasecmp(name, (wadfiles[wad]->lumpinfo + i)->longname))
-				continue;
-
 			// Not a header?
 			if (W_LumpLength(i | (wad << 16)) > 0)
 				continue;
@@ -1097,16 +1822,9 @@ UINT16 W_CheckNumForMapPwad(const char *name, UINT32 hash, UINT16 wad, UINT16 st
 			end = W_CheckNumForFolderEndPK3("maps/", wad, i);
 
 			// Now look for the specified map.
-			for (; i < end; i++)
+			for (i = index->longnames.lookup(name, W_HashLongName(name), i, key);
+				i < end; i = index->longnames.next(i))
 			{
-				// Not the hash?
-				if ((wadfiles[wad]->lumpinfo + i)->hash != hash)
-					continue;
-
-				// Not the name?
-				if (strcasecmp(name, (wadfiles[wad]->lumpinfo + i)->longname))
-					continue;
-
 				// Not a .wad?
 				if (!W_IsLumpWad(i | (wad << 16)))
 					continue;
@@ -1128,28 +1846,19 @@ UINT16 W_CheckNumForMapPwad(const char *name, UINT32 hash, UINT16 wad, UINT16 st
 //
 UINT16 W_CheckNumForNamePwad(const char *name, UINT16 wad, UINT16 startlump)
 {
-	UINT16 i;
-	UINT32 hash = quickncasehash(name, 8);
-
 	if (!TestValidLump(wad,0))
 		return INT16_MAX;
 
+	lumpindexstats.lookups++;
+
 	//
-	// scan forward
 	// start at 'startlump', useful parameter when there are multiple
 	//                       resources with the same name
 	//
 	if (startlump < wadfiles[wad]->numlumps)
 	{
-		lumpinfo_t *lump_p = wadfiles[wad]->lumpinfo + startlump;
-		for (i = startlump; i < wadfiles[wad]->numlumps; i++, lump_p++)
-		{
-			if (lump_p->hash != hash)
-				continue;
-			if (strncasecmp(lump_p->name, name, 8))
-				continue;
-			return i;
-		}
+		return wadfiles[wad]->index->names.lookup(name, W_HashShortName(name), startlump,
+			ShortNameKey {wadfiles[wad]->lumpinfo});
 	}
 
 	// not found.
@@ -1164,28 +1873,19 @@ UINT16 W_CheckNumForNamePwad(const char *name, UINT16 wad, UINT16 startlump)
 //
 UINT16 W_CheckNumForLongNamePwad(const char *name, UINT16 wad, UINT16 startlump)
 {
-	UINT16 i;
-	UINT32 hash = quickncasehash(name, 8); // Not a mistake, legacy system for short lumpnames
-
 	if (!TestValidLump(wad,0))
 		return INT16_MAX;
 
+	lumpindexstats.lookups++;
+
 	//
-	// scan forward
 	// start at 'startlump', useful parameter when there are multiple
 	//                       resources with the same name
 	//
 	if (startlump < wadfiles[wad]->numlumps)
 	{
-		lumpinfo_t *lump_p = wadfiles[wad]->lumpinfo + startlump;
-		for (i = startlump; i < wadfiles[wad]->numlumps; i++, lump_p++)
-		{
-			if (lump_p->hash != hash)
-				continue;
-			if (strcasecmp(lump_p->longname, name))
-				continue;
-			return i;
-		}
+		return wadfiles[wad]->index->longnames.lookup(name, W_HashLongName(name), startlump,
+			LongNameKey {wadfiles[wad]->lumpinfo});
 	}
 
 	// not found.
@@ -1207,18 +1907,45 @@ UINT16 W_CheckNumForFolderStartPK3(const char *name, UINT16 wad, UINT16 startlum
 {
 	size_t name_length;
 	INT32 i;
-	lumpinfo_t *lump_p = wadfiles[wad]->lumpinfo + startlump;
+	lumpinfo_t *lump_p;
+	const lumpfolder_t *folder = W_LookupFolder(wadfiles[wad], name);
+
+	lumpindexstats.lookups++;
+
 	name_length = strlen(name);
-	for (i = startlump; i < wadfiles[wad]->numlumps; i++, lump_p++)
+
+	if (folder != NULL)
 	{
-		if (strnicmp(name, lump_p->fullname, name_length) == 0)
+		i = wadfiles[wad]->numlumps;
+		for (const auto &run : folder->runs)
 		{
-			/* SLADE is special and puts a single directory entry. Skip that. */
-			if (strlen(lump_p->fullname) == name_length)
-				i++;
-			break;
+			if (run.second > startlump)
+			{
+				i = std::max<INT32>(run.first, startlump);
+				break;
+			}
 		}
 	}
+	else if (name_length && name[name_length - 1] == '/' && wadfiles[wad]->index != NULL)
+	{
+		// Not a folder in this file at all.
+		i = std::max<INT32>(startlump, wadfiles[wad]->numlumps);
+	}
+	else
+	{
+		lumpindexstats.fallbacks++;
+		lump_p = wadfiles[wad]->lumpinfo + startlump;
+		for (i = startlump; i < wadfiles[wad]->numlumps; i++, lump_p++)
+		{
+			if (strnicmp(name, lump_p->fullname, name_length) == 0)
+				break;
+		}
+	}
+
+	/* SLADE is special and puts a single directory entry. Skip that. */
+	if (i < wadfiles[wad]->numlumps && strlen(wadfiles[wad]->lumpinfo[i].fullname) == name_length)
+		i++;
+
 	return i;
 }
 
@@ -1228,7 +1955,23 @@ UINT16 W_CheckNumForFolderStartPK3(const char *name, UINT16 wad, UINT16 startlum
 UINT16 W_CheckNumForFolderEndPK3(const char *name, UINT16 wad, UINT16 startlump)
 {
 	INT32 i;
-	lumpinfo_t *lump_p = wadfiles[wad]->lumpinfo + startlump;
+	lumpinfo_t *lump_p;
+	const lumpfolder_t *folder = W_LookupFolder(wadfiles[wad], name);
+
+	lumpindexstats.lookups++;
+
+	if (folder != NULL)
+	{
+		for (const auto &run : folder->runs)
+		{
+			if (run.first <= startlump && startlump < run.second)
+				return run.second;
+		}
+		return startlump;
+	}
+
+	lumpindexstats.fallbacks++;
+	lump_p = wadfiles[wad]->lumpinfo + startlump;
 	for (i = startlump; i < wadfiles[wad]->numlumps; i++, lump_p++)
 	{
 		if (strnicmp(name, lump_p->fullname, strlen(name)))
@@ -1239,10 +1982,28 @@ UINT16 W_CheckNumForFolderEndPK3(const char *name, UINT16 wad, UINT16 startlump)
 
 // In a PK3 type of resource file, it looks for an entry with the specified full name.
 // Returns lump position in PK3's lumpinfo, or INT16_MAX if not found.
+// This is the first lump whose full name starts with the name, exact or not.
 UINT16 W_CheckNumForFullNamePK3(const char *name, UINT16 wad, UINT16 startlump)
 {
 	INT32 i;
-	lumpinfo_t *lump_p = wadfiles[wad]->lumpinfo + startlump;
+	lumpinfo_t *lump_p;
+	const lumpindex_t *index = wadfiles[wad]->index;
+
+	lumpindexstats.lookups++;
+
+	if (index != NULL)
+	{
+		i = index->fullnames.lookup(name, W_HashLongName(name), startlump,
+			FullNameKey {wadfiles[wad]->lumpinfo});
+
+		// A lump before the exact match that only starts with the name
+		// still comes first; the scan below finds it.
+		if (i != INT16_MAX && !W_PrefixMatchBefore(wadfiles[wad], name, startlump, i))
+			return i;
+	}
+
+	lumpindexstats.fallbacks++;
+	lump_p = wadfiles[wad]->lumpinfo + startlump;
 	for (i = startlump; i < wadfiles[wad]->numlumps; i++, lump_p++)
 	{
 		if (!strnicmp(name, lump_p->fullname, strlen(name)))
@@ -1284,12 +2045,14 @@ lumpnum_t W_CheckNumForName(const char *name)
 	}
 
 	// scan wad files backwards so patch lump files take precedence
+	precise_t t = I_GetPreciseTime();
 	for (i = numwadfiles - 1; i >= 0; i--)
 	{
 		check = W_CheckNumForNamePwad(name,(UINT16)i,0);
 		if (check != INT16_MAX)
 			break; //found it
 	}
+	lumpindexstats.looktime += I_GetPreciseTime() - t;
 
 	if (check == INT16_MAX)
 	{
@@ -1339,12 +2102,14 @@ lumpnum_t W_CheckNumForLongName(const char *name)
 	}
 
 	// scan wad files backwards so patch lump files take precedence
+	precise_t t = I_GetPreciseTime();
 	for (i = numwadfiles - 1; i >= 0; i--)
 	{
 		check = W_CheckNumForLongNamePwad(name,(UINT16)i,0);
 		if (check != INT16_MAX)
 			break; //found it
 	}
+	lumpindexstats.looktime += I_GetPreciseTime() - t;
 
 	if (check == INT16_MAX)
 	{
@@ -1389,6 +2154,7 @@ lumpnum_t W_CheckNumForMap(const char *name, boolean checktofirst)
 
 	uhash = quickncasehash(name, 8); // Not a mistake, legacy system for short lumpnames
 
+	precise_t t = I_GetPreciseTime();
 	for (i = numwadfiles - 1; i >= firstfile; i--)
 	{
 		check = W_CheckNumForMapPwad(name, uhash, (UINT16)i, 0);
@@ -1396,6 +2162,7 @@ lumpnum_t W_CheckNumForMap(const char *name, boolean checktofirst)
 		if (check != INT16_MAX)
 			break; // found it
 	}
+	lumpindexstats.looktime += I_GetPreciseTime() - t;
 
 	if (check == INT16_MAX)
 	{
@@ -1616,6 +2383,32 @@ void zerr(int ret)
 }
 #endif
 
+/** Gets an uncompressed lump straight out of the mapped file.
+  * The data is read-only, isn't zone memory (never Z_Free it) and stays
+  * valid as long as the file is loaded.
+  *
+  * \return The lump's data, or NULL if the lump is compressed or the
+  *         file isn't mapped; use W_CacheLumpNum for those instead.
+  */
+const void *W_GetLumpViewPwad(UINT16 wad, UINT16 lump)
+{
+	const lumpinfo_t *l;
+
+	if (!TestValidLump(wad, lump))
+		return NULL;
+
+	l = wadfiles[wad]->lumpinfo + lump;
+	if (l->compression != CM_NOCOMPRESSION || !l->size)
+		return NULL;
+
+	return W_FileView(wadfiles[wad], l->position, l->size);
+}
+
+const void *W_GetLumpView(lumpnum_t lumpnum)
+{
+	return W_GetLumpViewPwad(WADFILENUM(lumpnum), LUMPNUM(lumpnum));
+}
+
 /** Reads bytes from the head of a lump.
   * Note: If the lump is compressed, the whole thing has to be read anyway.
   *
@@ -1632,6 +2425,7 @@ size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, si
 	size_t lumpsize;
 	lumpinfo_t *l;
 	FILE *handle;
+	const UINT8 *view;
 
 	if (!TestValidLump(wad,lump))
 		return 0;
@@ -1646,38 +2440,48 @@ size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, si
 		size = lumpsize - offset;
 
 	// Let's get the raw lump data.
-	// We setup the desired file handle to read the lump data.
+	// If the file is mapped, we read straight out of it, otherwise
+	// we setup the desired file handle to read the lump data.
 	l = wadfiles[wad]->lumpinfo + lump;
+	view = W_FileView(wadfiles[wad], l->position + offset,
+		(l->compression == CM_NOCOMPRESSION) ? size : l->disksize);
 	handle = wadfiles[wad]->handle;
-	fseek(handle, (long)(l->position + offset), SEEK_SET);
+	if (view == NULL)
+		fseek(handle, (long)(l->position + offset), SEEK_SET);
 
 	// But let's not copy it yet. We support different compression formats on lumps, so we need to take that into account.
 	switch(wadfiles[wad]->lumpinfo[lump].compression)
 	{
 	case CM_NOCOMPRESSION:		// If it's uncompressed, we directly write the data into our destination, and return the bytes read.
-#ifdef NO_PNG_LUMPS
 		{
-			size_t bytesread = fread(dest, 1, size, handle);
+			size_t bytesread = size;
+			if (view)
+				M_Memcpy(dest, view, size);
+			else
+				bytesread = fread(dest, 1, size, handle);
+#ifdef NO_PNG_LUMPS
 			if (Picture_IsLumpPNG((UINT8 *)dest, bytesread))
 				Picture_ThrowPNGError(l->fullname, wadfiles[wad]->filename);
+#endif
 			return bytesread;
 		}
-#else
-		return fread(dest, 1, size, handle);
-#endif
 	case CM_LZF:		// Is it LZF compressed? Used by ZWADs.
 		{
 #ifdef ZWAD
-			char *rawData; // The lump's raw data.
+			char *rawData = NULL; // The lump's raw data, if it isn't mapped.
 			char *decData; // Lump's decompressed real data.
 			size_t retval; // Helper var, lzf_decompress returns 0 when an error occurs.
 
-			rawData = static_cast<char*>(Z_Malloc(l->disksize, PU_STATIC, NULL));
 			decData = static_cast<char*>(Z_Malloc(l->size, PU_STATIC, NULL));
 
-			if (fread(rawData, 1, l->disksize, handle) < l->disksize)
-				I_Error("wad %d, lump %d: cannot read compressed data", wad, lump);
-			retval = lzf_decompress(rawData, l->disksize, decData, l->size);
+			if (view == NULL)
+			{
+				rawData = static_cast<char*>(Z_Malloc(l->disksize, PU_STATIC, NULL));
+				if (fread(rawData, 1, l->disksize, handle) < l->disksize)
+					I_Error("wad %d, lump %d: cannot read compressed data", wad, lump);
+				view = reinterpret_cast<const UINT8*>(rawData);
+			}
+			retval = lzf_decompress(view, l->disksize, decData, l->size);
 #ifndef AVOID_ERRNO
 			if (retval == 0) // If this was returned, check if errno was set
 			{
@@ -1713,7 +2517,7 @@ size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, si
 #ifdef HAVE_ZLIB
 	case CM_DEFLATE: // Is it compressed via DEFLATE? Very common in ZIPs/PK3s, also what most doom-related editors support.
 		{
-			UINT8 *rawData; // The lump's raw data.
+			UINT8 *rawData = NULL; // The lump's raw data, if it isn't mapped.
 			UINT8 *decData; // Lump's decompressed real data.
 
 			int zErr; // Helper var.
@@ -1721,11 +2525,15 @@ size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, si
 			unsigned long rawSize = l->disksize;
 			unsigned long decSize = size;
 
-			rawData = static_cast<UINT8*>(Z_Malloc(rawSize, PU_STATIC, NULL));
 			decData = static_cast<UINT8*>(dest);
 
-			if (fread(rawData, 1, rawSize, handle) < rawSize)
-				I_Error("wad %d, lump %d: cannot read compressed data", wad, lump);
+			if (view == NULL)
+			{
+				rawData = static_cast<UINT8*>(Z_Malloc(rawSize, PU_STATIC, NULL));
+				if (fread(rawData, 1, rawSize, handle) < rawSize)
+					I_Error("wad %d, lump %d: cannot read compressed data", wad, lump);
+				view = rawData;
+			}
 
 			strm.zalloc = Z_NULL;
 			strm.zfree = Z_NULL;
@@ -1734,7 +2542,7 @@ size_t W_ReadLumpHeaderPwad(UINT16 wad, UINT16 lump, void *dest, size_t size, si
 			strm.total_in = strm.avail_in = rawSize;
 			strm.total_out = strm.avail_out = decSize;
 
-			strm.next_in = rawData;
+			strm.next_in = const_cast<UINT8*>(view); // zlib never writes to it
 			strm.next_out = decData;
 
 			zErr = inflateInit2(&strm, -15);
@@ -2446,7 +3254,9 @@ virtres_t* vres_GetMap(lumpnum_t lumpnum)
 		size_t *vsizecache;
 
 		// Remember that we're assuming that the WAD will have a specific set of lumps in a specific order.
-		UINT8 *wadData = static_cast<UINT8*>(W_CacheLumpNum(lumpnum, PU_LEVEL));
+		// Stored (uncompressed) WADs are read in place instead of copying the whole thing first.
+		const UINT8 *mapped = static_cast<const UINT8*>(W_GetLumpView(lumpnum));
+		const UINT8 *wadData = mapped ? mapped : static_cast<UINT8*>(W_CacheLumpNum(lumpnum, PU_LEVEL));
 		filelump_t *fileinfo = (filelump_t *)(wadData + LONG(((wadinfo_t *)wadData)->infotableofs));
 
 		i = LONG(((wadinfo_t *)wadData)->numlumps);
@@ -2481,7 +3291,8 @@ virtres_t* vres_GetMap(lumpnum_t lumpnum)
 		}
 
 		Z_Free(vsizecache);
-		Z_Free(wadData);
+		if (!mapped)
+			Z_Free(const_cast<UINT8*>(wadData));
 	}
 	else
 	{
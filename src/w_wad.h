@@ -128,6 +128,8 @@ struct wadfile_t
 	FILE *handle;
 	UINT32 filesize; // for network
 	UINT8 md5sum[16];
+	lumpindex_t *index; // hashed directory for the name lookups, built by W_InitFile
+	const UINT8 *view; // the whole file mapped read-only, NULL if it couldn't be
 
 	boolean important; // also network - !W_VerifyNMUSlumps
 };
@@ -144,6 +146,8 @@ void W_Shutdown(void);
 
 // Opens a WAD file. Returns the FILE * handle for the file, or NULL if not found or could not be opened
 FILE *W_OpenWadFile(const char **filename, boolean useerrors);
+// MD5 of a whole file, from the cache if it hasn't changed. 0 on success, 1 if it can't be read
+INT32 W_MakeFileMD5(const char *filename, void *resblock);
 // Load and add a wadfile to the active wad files, returns numbers of lumps, INT16_MAX on error
 UINT16 W_InitFile(const char *filename, boolean mainfile, boolean startup);
 
@@ -179,6 +183,8 @@ lumpnum_t W_CheckNumForNameInBlock(const char *name, const char *blockstart, con
 lumpnum_t W_CheckNumForNameInFolder(const char *lump, const char *folder);
 UINT8 W_LumpExists(const char *name); // Lua uses this.
 
+void W_PrintLumpIndexStats(void);
+
 size_t W_LumpLengthPwad(UINT16 wad, UINT16 lump);
 size_t W_LumpLength(lumpnum_t lumpnum);
 
@@ -194,6 +200,10 @@ size_t W_ReadLumpHeader(lumpnum_t lump, void *dest, size_t size, size_t offest);
 void W_ReadLumpPwad(UINT16 wad, UINT16 lump, void *dest);
 void W_ReadLump(lumpnum_t lump, void *dest);
 
+// Zero-copy access to uncompressed lumps in mapped files, NULL otherwise
+const void *W_GetLumpViewPwad(UINT16 wad, UINT16 lump);
+const void *W_GetLumpView(lumpnum_t lumpnum);
+
 void *W_CacheLumpNumPwad(UINT16 wad, UINT16 lump, INT32 tag);
 void *W_CacheLumpNum(lumpnum_t lump, INT32 tag);
 void *W_CacheLumpNumForce(lumpnum_t lumpnum, INT32 tag);
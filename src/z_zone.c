@@ -25,6 +25,11 @@
 ///        caught with this direct-malloc version. We also suspected that SRB2's
 ///        allocator was fragmenting badly. Finally, this version is a bit
 ///        simpler (about half the lines of code).
+///
+///        The exception is small PU_LEVEL and PU_LEVSPEC blocks. A map spawns
+///        and frees huge numbers of these (mobjs, thinkers, sector nodes...),
+///        so they are carved out of per-tag arenas with a free list for each
+///        size class, and the whole arena is dropped at once on level change.
 
 #include <stddef.h>
 #include <stdalign.h>
@@ -66,6 +71,9 @@ typedef struct memblock_s
 	const char *ownerfile;
 	INT32 ownerline;
 
+	struct zonearena_s *arena; // arena the memory came from, NULL if malloc'd
+	INT32 sizeclass; // slab size class within that arena
+
 	struct memblock_s *next, *prev;
 } memblock_t;
 
@@ -76,11 +84,66 @@ typedef struct memblock_s
 // both the head and tail of the zone memory block list
 static memblock_t head;
 
+// the same, for blocks purged at level start that no arena holds,
+// so that freeing level memory never walks static and cached blocks
+static memblock_t levelhead;
+
+// ------------
+// Level arenas
+// ------------
+
+#define SLABGRANULARITY 32 // multiple of alignof (max_align_t)
+#define NUMSLABCLASSES 64 // so blocks up to 2 KB come from an arena
+#define SLABCHUNKSIZE (256 << 10)
+
+#define SLABMAXSIZE (SLABGRANULARITY * NUMSLABCLASSES)
+
+typedef struct zonechunk_s
+{
+	struct zonechunk_s *next;
+	size_t used; // bytes handed out from the start of the chunk
+} zonechunk_t;
+
+#define CHUNKPAD (((sizeof (zonechunk_t) + (alignof (max_align_t) - 1)) & ~(alignof (max_align_t) - 1)) - sizeof (zonechunk_t))
+#define CHUNKDATA(x) (UINT8 *)((uintptr_t)(x) + sizeof(zonechunk_t) + CHUNKPAD)
+#define CHUNKBYTES (SLABCHUNKSIZE - sizeof(zonechunk_t) - CHUNKPAD)
+
+typedef struct zonearena_s
+{
+	INT32 tag;
+	const char *name;
+
+	// Every block with this tag, wherever its memory came
+	// from. Z_ChangeTag moves blocks between these lists.
+	memblock_t head;
+
+	zonechunk_t *chunks; // newest first, only this one has room
+	memblock_t *freelist[NUMSLABCLASSES]; // linked through ->next
+
+	size_t numchunks;
+	size_t live; // slab blocks handed out and not yet freed
+	size_t livebytes;
+	size_t freebytes; // bytes sitting in the free lists
+} zonearena_t;
+
+static zonearena_t arenas[] =
+{
+	{.tag = PU_LEVEL,   .name = "Level"},
+	{.tag = PU_LEVSPEC, .name = "Special thinker"},
+};
+
+#define NUMZONEARENAS (sizeof arenas / sizeof *arenas)
+#define NUMZONELISTS (2 + NUMZONEARENAS)
+
+// the general and level lists followed by each arena's list
+static memblock_t *zonelists[NUMZONELISTS];
+
 //
 // Function prototypes
 //
 static void Command_Memfree_f(void);
 static void Command_Memdump_f(void);
+static void *xm(size_t size);
 
 // --------------------------
 // Zone memory initialisation
@@ -95,9 +158,22 @@ void Z_Init(void)
 {
 	UINT32 total, memfree;
 
+	size_t i;
+
 	memset(&head, 0x00, sizeof(head));
 
 	head.next = head.prev = &head;
+	zonelists[0] = &head;
+
+	levelhead.next = levelhead.prev = &levelhead;
+	zonelists[1] = &levelhead;
+
+	for (i = 0; i < NUMZONEARENAS; i++)
+	{
+		memblock_t *list = &arenas[i].head;
+		list->next = list->prev = list;
+		zonelists[2 + i] = list;
+	}
 
 	memfree = I_GetFreeMem(&total)>>20;
 	CONS_Printf("System memory: %uMB - Free: %uMB\n", total>>20, memfree);
@@ -112,6 +188,136 @@ void Z_Init(void)
 // Zone memory allocation
 // ----------------------
 
+/** Finds the arena for a tag.
+  *
+  * \param tag Purge tag.
+  * \return The arena, or NULL if the tag isn't arena allocated.
+  */
+static zonearena_t *Z_ArenaForTag(INT32 tag)
+{
+	size_t i;
+
+	for (i = 0; i < NUMZONEARENAS; i++)
+	{
+		if (arenas[i].tag == tag)
+			return &arenas[i];
+	}
+
+	return NULL;
+}
+
+/** Finds the block list that blocks with a tag are linked into.
+  */
+static memblock_t *Z_ListForTag(INT32 tag)
+{
+	zonearena_t *arena = Z_ArenaForTag(tag);
+
+	if (arena)
+		return &arena->head;
+
+	if (tag >= PU_LEVEL && tag < PU_PURGELEVEL)
+		return &levelhead;
+
+	return &head;
+}
+
+static void Z_LinkBlock(memblock_t *block, memblock_t *list)
+{
+	block->next = list->next;
+	block->prev = list;
+	list->next = block;
+	block->next->prev = block;
+}
+
+static void Z_UnlinkBlock(memblock_t *block)
+{
+	block->prev->next = block->next;
+	block->next->prev = block->prev;
+}
+
+/** Takes a block out of an arena, reusing a freed one of the same
+  * size class if there is one.
+  *
+  * \param arena The arena.
+  * \param blocksize Size of the block, including the header.
+  * \return The block, with arena and sizeclass filled in.
+  */
+static memblock_t *Z_SlabAlloc(zonearena_t *arena, size_t blocksize)
+{
+	const INT32 sizeclass = (INT32)((blocksize - 1) / SLABGRANULARITY);
+	const size_t classbytes = (size_t)(sizeclass + 1) * SLABGRANULARITY;
+	memblock_t *block = arena->freelist[sizeclass];
+
+	if (block != NULL)
+	{
+		arena->freelist[sizeclass] = block->next;
+		arena->freebytes -= classbytes;
+	}
+	else
+	{
+		zonechunk_t *chunk = arena->chunks;
+
+		if (chunk == NULL || chunk->used + classbytes > CHUNKBYTES)
+		{
+			chunk = xm(SLABCHUNKSIZE);
+			chunk->next = arena->chunks;
+			chunk->used = 0;
+			arena->chunks = chunk;
+			arena->numchunks++;
+		}
+
+		block = (memblock_t *)(CHUNKDATA(chunk) + chunk->used);
+		chunk->used += classbytes;
+	}
+
+	block->arena = arena;
+	block->sizeclass = sizeclass;
+
+	arena->live++;
+	arena->livebytes += classbytes;
+
+	return block;
+}
+
+/** Puts a block back on its arena's free list.
+  */
+static void Z_SlabFree(memblock_t *block)
+{
+	zonearena_t *arena = block->arena;
+	const size_t classbytes = (size_t)(block->sizeclass + 1) * SLABGRANULARITY;
+
+	block->id = 0;
+	block->next = arena->freelist[block->sizeclass];
+	arena->freelist[block->sizeclass] = block;
+
+	arena->live--;
+	arena->livebytes -= classbytes;
+	arena->freebytes += classbytes;
+}
+
+/** Gives an arena's chunks back to the system in one go, once nothing
+  * allocated from it is still alive.
+  */
+static void Z_ReleaseArena(zonearena_t *arena)
+{
+	zonechunk_t *chunk, *next;
+
+	if (arena->live != 0)
+		return;
+
+	for (chunk = arena->chunks; chunk != NULL; chunk = next)
+	{
+		next = chunk->next;
+		free(chunk);
+	}
+
+	arena->chunks = NULL;
+	memset(arena->freelist, 0, sizeof arena->freelist);
+
+	arena->numchunks = 0;
+	arena->freebytes = 0;
+}
+
 /** Frees allocated memory.
   *
   * \param ptr A pointer to allocated memory,
@@ -155,10 +361,13 @@ void Z_Free2(void *ptr, const char *file, INT32 line)
 #ifdef VALGRIND_DESTROY_MEMPOOL
 	VALGRIND_DESTROY_MEMPOOL(block);
 #endif
-	block->prev->next = block->next;
-	block->next->prev = block->prev;
+	Z_UnlinkBlock(block);
 	TracyCFree(block);
-	free(block);
+
+	if (block->arena != NULL)
+		Z_SlabFree(block);
+	else
+		free(block);
 }
 
 /** malloc() that doesn't accept failure.
@@ -205,6 +414,8 @@ static void *xm(size_t size)
 void *Z_Malloc2(size_t size, INT32 tag, void *user, INT32 alignbits,
 	const char *file, INT32 line)
 {
+	const size_t blocksize = sizeof (memblock_t) + ALIGNPAD + size;
+	zonearena_t *arena = Z_ArenaForTag(tag);
 	memblock_t *block;
 	void *ptr;
 
@@ -214,8 +425,18 @@ void *Z_Malloc2(size_t size, INT32 tag, void *user, INT32 alignbits,
 	CONS_Debug(DBG_MEMORY, "Z_Malloc %s:%d\n", file, line);
 #endif
 
-	block = xm(sizeof (memblock_t) + ALIGNPAD + size);
-	TracyCAlloc(block, sizeof (memblock_t) + ALIGNPAD + size);
+	if (arena != NULL && size < SLABMAXSIZE && blocksize <= SLABMAXSIZE)
+	{
+		block = Z_SlabAlloc(arena, blocksize);
+	}
+	else
+	{
+		block = xm(blocksize);
+		block->arena = NULL;
+		block->sizeclass = 0;
+	}
+
+	TracyCAlloc(block, blocksize);
 	ptr = MEMORY(block);
 	I_Assert((intptr_t)ptr % alignof (max_align_t) == 0);
 
@@ -223,10 +444,7 @@ void *Z_Malloc2(size_t size, INT32 tag, void *user, INT32 alignbits,
 	Z_calloc = false;
 #endif
 
-	block->next = head.next;
-	block->prev = &head;
-	head.next = block;
-	block->next->prev = block;
+	Z_LinkBlock(block, Z_ListForTag(tag));
 
 	block->tag = tag;
 	block->user = NULL;
@@ -352,14 +570,48 @@ void *Z_Realloc2(void *ptr, size_t size, INT32 tag, void *user, INT32 alignbits,
 void Z_FreeTags(INT32 lowtag, INT32 hightag)
 {
 	memblock_t *block, *next;
+	size_t i;
 	TracyCZone(__zone, true);
 
 	Z_CheckHeap(420);
-	for (block = head.next; block != &head; block = next)
+
+	// The general list only has tags from outside the level range
+	if (lowtag < PU_LEVEL || hightag >= PU_PURGELEVEL)
+	{
+		for (block = head.next; block != &head; block = next)
+		{
+			next = block->next; // get link before freeing
+			if (block->tag >= lowtag && block->tag <= hightag)
+				Z_Free(MEMORY(block));
+		}
+	}
+
+	if (lowtag < PU_PURGELEVEL && hightag >= PU_LEVEL)
 	{
-		next = block->next; // get link before freeing
-		if (block->tag >= lowtag && block->tag <= hightag)
+		for (block = levelhead.next; block != &levelhead; block = next)
+		{
+			next = block->next;
+			if (block->tag >= lowtag && block->tag <= hightag)
+				Z_Free(MEMORY(block));
+		}
+	}
+
+	// Every block in an arena's list has the arena's tag,
+	// so the whole list goes at once.
+	for (i = 0; i < NUMZONEARENAS; i++)
+	{
+		zonearena_t *arena = &arenas[i];
+
+		if (arena->tag < lowtag || arena->tag > hightag)
+			continue;
+
+		for (block = arena->head.next; block != &arena->head; block = next)
+		{
+			next = block->next;
 			Z_Free(MEMORY(block));
+		}
+
+		Z_ReleaseArena(arena);
 	}
 
 	TracyCZoneEnd(__zone);
@@ -374,21 +626,27 @@ void Z_FreeTags(INT32 lowtag, INT32 hightag)
 void Z_IterateTags(INT32 lowtag, INT32 hightag, boolean (*iterfunc)(void *))
 {
 	memblock_t *block, *next;
+	size_t l;
 	TracyCZone(__zone, true);
 
 	if (!iterfunc)
 		I_Error("Z_IterateTags: no iterator function was given");
 
-	for (block = head.next; block != &head; block = next)
+	for (l = 0; l < NUMZONELISTS; l++)
 	{
-		next = block->next; // get link before possibly freeing
+		memblock_t *list = zonelists[l];
 
-		if (block->tag >= lowtag && block->tag <= hightag)
+		for (block = list->next; block != list; block = next)
 		{
-			void *mem = MEMORY(block);
-			boolean free = iterfunc(mem);
-			if (free)
-				Z_Free(mem);
+			next = block->next; // get link before possibly freeing
+
+			if (block->tag >= lowtag && block->tag <= hightag)
+			{
+				void *mem = MEMORY(block);
+				boolean free = iterfunc(mem);
+				if (free)
+					Z_Free(mem);
+			}
 		}
 	}
 
@@ -434,60 +692,74 @@ void Z_CheckHeap(INT32 i)
 	memblock_t *block;
 	UINT32 blocknumon = 0;
 	void *given;
+	size_t l;
 
-	for (block = head.next; block != &head; block = block->next)
+	for (l = 0; l < NUMZONELISTS; l++)
 	{
-		blocknumon++;
-		given = MEMORY(block);
+		memblock_t *list = zonelists[l];
+
+		for (block = list->next; block != list; block = block->next)
+		{
+			blocknumon++;
+			given = MEMORY(block);
 #ifdef ZDEBUG
-		CONS_Debug(DBG_MEMORY, "block %u owned by %s:%d\n",
-			blocknumon, block->ownerfile, block->ownerline);
+			CONS_Debug(DBG_MEMORY, "block %u owned by %s:%d\n",
+				blocknumon, block->ownerfile, block->ownerline);
 #endif
 #ifdef VALGRIND_MEMPOOL_EXISTS
-		if (!VALGRIND_MEMPOOL_EXISTS(block))
-		{
-			I_Error("Z_CheckHeap %d: block %u"
-				"(owned by %s:%d)"
-				" should not exist", i, blocknumon,
-				" should not exist", i, blocknumon,
-				block->ownerfile, block->ownerline
-			);
-		}
+			if (!VALGRIND_MEMPOOL_EXISTS(block))
+			{
+				I_Error("Z_CheckHeap %d: block %u"
+					"(owned by %s:%d)"
+					" should not exist", i, blocknumon,
+					" should not exist", i, blocknumon,
+					block->ownerfile, block->ownerline
+				);
+			}
 #endif
-		if (block->user != NULL && *(block->user) != given)
-		{
-			I_Error("Z_CheckHeap %d: block %u"
-				"(owned by %s:%d)"
-				" doesn't have a proper user", i, blocknumon,
-				block->ownerfile, block->ownerline
-			);
-		}
-		if (block->next->prev != block)
-		{
-			I_Error("Z_CheckHeap %d: block %u"
-				"(owned by %s:%d)"
-				" lacks proper backlink", i, blocknumon,
-				block->ownerfile, block->ownerline
-			);
-		}
-		if (block->prev->next != block)
-		{
-			I_Error("Z_CheckHeap %d: block %u"
-				"(owned by %s:%d)"
-				" lacks proper forward link", i, blocknumon,
-				block->ownerfile, block->ownerline
-			);
-		}
+			if (block->user != NULL && *(block->user) != given)
+			{
+				I_Error("Z_CheckHeap %d: block %u"
+					"(owned by %s:%d)"
+					" doesn't have a proper user", i, blocknumon,
+					block->ownerfile, block->ownerline
+				);
+			}
+			if (block->next->prev != block)
+			{
+				I_Error("Z_CheckHeap %d: block %u"
+					"(owned by %s:%d)"
+					" lacks proper backlink", i, blocknumon,
+					block->ownerfile, block->ownerline
+				);
+			}
+			if (block->prev->next != block)
+			{
+				I_Error("Z_CheckHeap %d: block %u"
+					"(owned by %s:%d)"
+					" lacks proper forward link", i, blocknumon,
+					block->ownerfile, block->ownerline
+				);
+			}
 #ifdef VALGRIND_MAKE_MEM_DEFINED
-		VALGRIND_MAKE_MEM_DEFINED(hdr, sizeof *hdr);
+			VALGRIND_MAKE_MEM_DEFINED(hdr, sizeof *hdr);
 #endif
-		if (block->id != ZONEID)
-		{
-			I_Error("Z_CheckHeap %d: block %u"
-				"(owned by %s:%d)"
-				" have the wrong ID", i, blocknumon,
-				block->ownerfile, block->ownerline
-			);
+			if (block->id != ZONEID)
+			{
+				I_Error("Z_CheckHeap %d: block %u"
+					"(owned by %s:%d)"
+					" have the wrong ID", i, blocknumon,
+					block->ownerfile, block->ownerline
+				);
+			}
+			if (Z_ListForTag(block->tag) != list)
+			{
+				I_Error("Z_CheckHeap %d: block %u"
+					"(owned by %s:%d)"
+					" is in the wrong list for tag %d", i, blocknumon,
+					block->ownerfile, block->ownerline, block->tag
+				);
+			}
 		}
 	}
 }
@@ -524,6 +796,14 @@ void Z_ChangeTag(void *ptr, INT32 tag)
 		I_Error("Internal memory management error: "
 			"tried to make block purgable but it has no owner");
 
+	// Memory from an arena stays where it is; only the list
+	// the block is freed through changes.
+	if (Z_ListForTag(tag) != Z_ListForTag(block->tag))
+	{
+		Z_UnlinkBlock(block);
+		Z_LinkBlock(block, Z_ListForTag(tag));
+	}
+
 	block->tag = tag;
 }
 
@@ -574,12 +854,18 @@ size_t Z_TagsUsage(INT32 lowtag, INT32 hightag)
 {
 	size_t cnt = 0;
 	memblock_t *rover;
+	size_t l;
 
-	for (rover = head.next; rover != &head; rover = rover->next)
+	for (l = 0; l < NUMZONELISTS; l++)
 	{
-		if (rover->tag < lowtag || rover->tag > hightag)
-			continue;
-		cnt += rover->size + sizeof *rover;
+		memblock_t *list = zonelists[l];
+
+		for (rover = list->next; rover != list; rover = rover->next)
+		{
+			if (rover->tag < lowtag || rover->tag > hightag)
+				continue;
+			cnt += rover->size + sizeof *rover;
+		}
 	}
 
 	return cnt;
@@ -589,6 +875,29 @@ size_t Z_TagsUsage(INT32 lowtag, INT32 hightag)
 // Miscellaneous functions
 // -----------------------
 
+/** Prints how much of each arena between a set of tags is in use.
+  */
+static void Z_PrintArenas(INT32 lowtag, INT32 hightag)
+{
+	size_t i;
+
+	for (i = 0; i < NUMZONEARENAS; i++)
+	{
+		const zonearena_t *arena = &arenas[i];
+
+		if (arena->tag < lowtag || arena->tag > hightag)
+			continue;
+
+		CONS_Printf(M_GetText("%-22s : %7s KB in %s chunks, %s KB live in %s blocks, %s KB free\n"),
+			arena->name,
+			sizeu1((arena->numchunks * SLABCHUNKSIZE)>>10),
+			sizeu2(arena->numchunks),
+			sizeu3(arena->livebytes>>10),
+			sizeu4(arena->live),
+			sizeu5(arena->freebytes>>10));
+	}
+}
+
 /** The function called by the "memfree" console command.
   * Prints the memory being used by each part of the game to the console.
   */
@@ -613,6 +922,9 @@ static void Command_Memfree_f(void)
 	CONS_Printf(M_GetText("All purgable           : %7s KB\n"),
 		sizeu1(Z_TagsUsage(PU_PURGELEVEL, INT32_MAX)>>10));
 
+	CONS_Printf("\x82%s", M_GetText("Arena Info\n"));
+	Z_PrintArenas(0, INT32_MAX);
+
 #ifdef HWRENDER
 	if (rendermode == render_opengl)
 	{
@@ -640,6 +952,7 @@ static void Command_Memdump_f(void)
 	memblock_t *block;
 	INT32 mintag = 0, maxtag = INT32_MAX;
 	INT32 i;
+	size_t l;
 
 	if ((i = COM_CheckParm("-min")))
 		mintag = atoi(COM_Argv(i + 1));
@@ -647,12 +960,19 @@ static void Command_Memdump_f(void)
 	if ((i = COM_CheckParm("-max")))
 		maxtag = atoi(COM_Argv(i + 1));
 
-	for (block = head.next; block != &head; block = block->next)
-		if (block->tag >= mintag && block->tag <= maxtag)
-		{
-			char *filename = strrchr(block->ownerfile, PATHSEP[0]);
-			CONS_Printf("[%3d] %s (%s) bytes @ %s:%d\n", block->tag, sizeu1(block->size), sizeu2(block->realsize), filename ? filename + 1 : block->ownerfile, block->ownerline);
-		}
+	for (l = 0; l < NUMZONELISTS; l++)
+	{
+		memblock_t *list = zonelists[l];
+
+		for (block = list->next; block != list; block = block->next)
+			if (block->tag >= mintag && block->tag <= maxtag)
+			{
+				char *filename = strrchr(block->ownerfile, PATHSEP[0]);
+				CONS_Printf("[%3d] %s (%s) bytes @ %s:%d%s\n", block->tag, sizeu1(block->size), sizeu2(block->realsize), filename ? filename + 1 : block->ownerfile, block->ownerline, block->arena ? " [arena]" : "");
+			}
+	}
+
+	Z_PrintArenas(mintag, maxtag);
 }
 
 /** Creates a copy of a string.